@@ -0,0 +1,86 @@
+#ifndef GP_BENCH_COMMON_HPP
+#define GP_BENCH_COMMON_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#define GP_BENCH_DUP _dup
+#define GP_BENCH_DUP2 _dup2
+#define GP_BENCH_CLOSE _close
+#define GP_BENCH_NULL "NUL"
+#else
+#include <unistd.h>
+#define GP_BENCH_DUP dup
+#define GP_BENCH_DUP2 dup2
+#define GP_BENCH_CLOSE close
+#define GP_BENCH_NULL "/dev/null"
+#endif
+
+// Helpers shared by the gp_bench sources
+
+namespace gp_bench
+{
+    // Distinct pseudo random keys, the same on every run
+    inline std::vector<uint64_t> make_keys(const size_t& count, const uint64_t& seed = 42)
+    {
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> keys(count);
+        for (size_t i = 0; i < count; ++i)
+            keys[i] = (rng() << 20) | i; // the low bits keep them distinct
+        return keys;
+    }
+
+    inline std::vector<std::string> make_strings(const size_t& count, const size_t& length, const uint64_t& seed = 42)
+    {
+        std::mt19937_64 rng(seed);
+        std::vector<std::string> strings(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            strings[i].resize(length);
+            for (char& c : strings[i])
+                c = static_cast<char>('a' + rng() % 26);
+        }
+        return strings;
+    }
+
+    /// @brief Sends stdout to the null device for its lifetime
+    /// @note  taskflowgraph::execute() reports every run on stdout, the benchmark tables would drown in it
+    class quiet_stdout
+    {
+    public:
+        quiet_stdout()
+        {
+            std::fflush(stdout);
+            m_saved = GP_BENCH_DUP(1);
+            std::FILE* null_device = std::fopen(GP_BENCH_NULL, "w");
+            if (null_device != nullptr)
+            {
+                GP_BENCH_DUP2(fileno(null_device), 1);
+                std::fclose(null_device);
+            }
+        }
+
+       ~quiet_stdout()
+        {
+            std::fflush(stdout);
+            if (m_saved >= 0)
+            {
+                GP_BENCH_DUP2(m_saved, 1);
+                GP_BENCH_CLOSE(m_saved);
+            }
+        }
+
+        quiet_stdout(const quiet_stdout&) = delete;
+        quiet_stdout& operator=(const quiet_stdout&) = delete;
+
+    private:
+        int m_saved;
+    };
+}
+
+#endif
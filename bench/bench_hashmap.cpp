@@ -0,0 +1,222 @@
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <unordered_map>
+
+#include "containers/gp_hashmap.hpp"
+#include "bench_common.hpp"
+
+// hash_map_128_t against std::unordered_map, std::unordered_map behind one std::mutex when threads share it
+// Sizes are key counts, every iteration goes through all the keys once
+
+namespace
+{
+    using gp_map = gp_std::hash_map_128_t<uint64_t, uint64_t>;
+    using std_map = std::unordered_map<uint64_t, uint64_t>;
+
+    void sizes(benchmark::internal::Benchmark* bench)
+    {
+        bench->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
+    }
+
+    void shared_sizes(benchmark::internal::Benchmark* bench)
+    {
+        bench->Arg(1 << 14)->Arg(1 << 18)->ThreadRange(1, 8)->UseRealTime();
+    }
+
+    // Fresh map per iteration, growth included
+    void hash_map_insert(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            gp_map map;
+            for (const uint64_t& key : keys)
+                map.insert(key, key);
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(hash_map_insert)->Apply(sizes);
+
+    void std_unordered_map_insert(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            std_map map;
+            for (const uint64_t& key : keys)
+                map.insert_or_assign(key, key);
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(std_unordered_map_insert)->Apply(sizes);
+
+    void hash_map_find(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        gp_map map;
+        for (const uint64_t& key : keys)
+            map.insert(key, key);
+
+        for (auto _ : state)
+        {
+            uint64_t sum = 0;
+            for (const uint64_t& key : keys)
+                sum += map.get(key).value();
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(hash_map_find)->Apply(sizes);
+
+    void hash_map_find_batch(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        gp_map map;
+        for (const uint64_t& key : keys)
+            map.insert(key, key);
+        std::vector<gp_std::optional<uint64_t>> results(keys.size());
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(map.find_batch(keys.data(), keys.size(), results.data()));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(hash_map_find_batch)->Apply(sizes);
+
+    void std_unordered_map_find(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        std_map map;
+        for (const uint64_t& key : keys)
+            map.emplace(key, key);
+
+        for (auto _ : state)
+        {
+            uint64_t sum = 0;
+            for (const uint64_t& key : keys)
+                sum += map.find(key)->second;
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(std_unordered_map_find)->Apply(sizes);
+
+    // Threads split the keys and insert into one map, after the first iteration the inserts assign
+    gp_map* shared_gp_map = nullptr;
+
+    void hash_map_atomic_insert(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        if (state.thread_index() == 0)
+            shared_gp_map = new gp_map();
+
+        const size_t slice = keys.size() / static_cast<size_t>(state.threads());
+        const size_t first = slice * static_cast<size_t>(state.thread_index());
+        for (auto _ : state)
+        {
+            for (size_t i = first; i < first + slice; ++i)
+                shared_gp_map->atomic_insert(keys[i], keys[i]);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(slice));
+
+        if (state.thread_index() == 0)
+        {
+            delete shared_gp_map;
+            shared_gp_map = nullptr;
+        }
+    }
+    BENCHMARK(hash_map_atomic_insert)->Apply(shared_sizes);
+
+    std_map* shared_std_map = nullptr;
+    std::mutex shared_std_mutex;
+
+    void std_unordered_map_locked_insert(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        if (state.thread_index() == 0)
+            shared_std_map = new std_map();
+
+        const size_t slice = keys.size() / static_cast<size_t>(state.threads());
+        const size_t first = slice * static_cast<size_t>(state.thread_index());
+        for (auto _ : state)
+        {
+            for (size_t i = first; i < first + slice; ++i)
+            {
+                std::lock_guard<std::mutex> lock(shared_std_mutex);
+                shared_std_map->insert_or_assign(keys[i], keys[i]);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(slice));
+
+        if (state.thread_index() == 0)
+        {
+            delete shared_std_map;
+            shared_std_map = nullptr;
+        }
+    }
+    BENCHMARK(std_unordered_map_locked_insert)->Apply(shared_sizes);
+
+    // Every thread looks up all the keys of a map built once
+    gp_map* read_gp_map = nullptr;
+
+    void hash_map_shared_find(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        if (state.thread_index() == 0)
+        {
+            read_gp_map = new gp_map();
+            for (const uint64_t& key : keys)
+                read_gp_map->insert(key, key);
+        }
+
+        for (auto _ : state)
+        {
+            uint64_t sum = 0;
+            for (const uint64_t& key : keys)
+                sum += read_gp_map->load(key).value();
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+
+        if (state.thread_index() == 0)
+        {
+            delete read_gp_map;
+            read_gp_map = nullptr;
+        }
+    }
+    BENCHMARK(hash_map_shared_find)->Apply(shared_sizes);
+
+    std_map* read_std_map = nullptr;
+
+    // Read only, no lock needed for std::unordered_map either
+    void std_unordered_map_shared_find(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        if (state.thread_index() == 0)
+        {
+            read_std_map = new std_map();
+            for (const uint64_t& key : keys)
+                read_std_map->emplace(key, key);
+        }
+
+        for (auto _ : state)
+        {
+            uint64_t sum = 0;
+            for (const uint64_t& key : keys)
+                sum += read_std_map->find(key)->second;
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+
+        if (state.thread_index() == 0)
+        {
+            delete read_std_map;
+            read_std_map = nullptr;
+        }
+    }
+    BENCHMARK(std_unordered_map_shared_find)->Apply(shared_sizes);
+}
@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "containers/gp_lookup_table.hpp"
+#include "bench_common.hpp"
+
+// lookup_table (hash and tree layouts) against std::map, every iteration looks up all the keys once in shuffled order
+
+namespace
+{
+    void sizes(benchmark::internal::Benchmark* bench)
+    {
+        bench->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+    }
+
+    std::map<uint64_t, uint64_t> make_map(const std::vector<uint64_t>& keys)
+    {
+        std::map<uint64_t, uint64_t> map;
+        for (const uint64_t& key : keys)
+            map.emplace(key, key);
+        return map;
+    }
+
+    // Queried in another order than inserted, so the lookups do not walk the table in sequence
+    std::vector<uint64_t> shuffled(std::vector<uint64_t> keys)
+    {
+        std::mt19937_64 rng(7);
+        std::shuffle(keys.begin(), keys.end(), rng);
+        return keys;
+    }
+
+    void lookup_table_hash(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        const std::map<uint64_t, uint64_t> source = make_map(keys);
+        const gp_std::lookup_table<uint64_t, uint64_t> table(std::unordered_map<uint64_t, uint64_t>(source.begin(), source.end()));
+        const std::vector<uint64_t> queries = shuffled(keys);
+
+        for (auto _ : state)
+        {
+            uint64_t sum = 0;
+            for (const uint64_t& key : queries)
+                sum += *table.lookup(key);
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(lookup_table_hash)->Apply(sizes);
+
+    void lookup_table_hash_many(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        const std::map<uint64_t, uint64_t> source = make_map(keys);
+        const gp_std::lookup_table<uint64_t, uint64_t> table(std::unordered_map<uint64_t, uint64_t>(source.begin(), source.end()));
+        const std::vector<uint64_t> queries = shuffled(keys);
+        std::vector<uint64_t*> results(queries.size());
+
+        for (auto _ : state)
+        {
+            table.lookup_many(queries.data(), queries.size(), results.data());
+            benchmark::DoNotOptimize(results.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(lookup_table_hash_many)->Apply(sizes);
+
+    void lookup_table_tree(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        const gp_std::lookup_table<uint64_t, uint64_t> table(make_map(keys));
+        const std::vector<uint64_t> queries = shuffled(keys);
+
+        for (auto _ : state)
+        {
+            uint64_t sum = 0;
+            for (const uint64_t& key : queries)
+                sum += *table.lookup(key);
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(lookup_table_tree)->Apply(sizes);
+
+    void lookup_table_tree_many(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        const gp_std::lookup_table<uint64_t, uint64_t> table(make_map(keys));
+        const std::vector<uint64_t> queries = shuffled(keys);
+        std::vector<uint64_t*> results(queries.size());
+
+        for (auto _ : state)
+        {
+            table.lookup_many(queries.data(), queries.size(), results.data());
+            benchmark::DoNotOptimize(results.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(lookup_table_tree_many)->Apply(sizes);
+
+    void std_map_find(benchmark::State& state)
+    {
+        const std::vector<uint64_t> keys = gp_bench::make_keys(static_cast<size_t>(state.range(0)));
+        const std::map<uint64_t, uint64_t> map = make_map(keys);
+        const std::vector<uint64_t> queries = shuffled(keys);
+
+        for (auto _ : state)
+        {
+            uint64_t sum = 0;
+            for (const uint64_t& key : queries)
+                sum += map.find(key)->second;
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(std_map_find)->Apply(sizes);
+}
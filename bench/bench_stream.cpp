@@ -0,0 +1,139 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "parallel/gp_stream.hpp"
+
+// Stream parallel stages on the persistent work_stealing_executor against the serial std algorithms
+// Below default_grain_size elements the parallel stages run on the calling thread
+
+namespace
+{
+    void sizes(benchmark::internal::Benchmark* bench)
+    {
+        bench->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->UseRealTime();
+    }
+
+    std::vector<int64_t> make_data(const int64_t& count)
+    {
+        std::vector<int64_t> data(static_cast<size_t>(count));
+        std::iota(data.begin(), data.end(), int64_t(0));
+        return data;
+    }
+
+    gp_std::Stream<int64_t> make_stream(const int64_t& count)
+    {
+        gp_std::Stream<int64_t> stream(make_data(count));
+        stream.set_executor(gp_std::work_stealing_executor::make());
+        return stream;
+    }
+
+    // Some work per element, a bare add is memory bound on either side
+    int64_t mix(const int64_t& x)
+    {
+        return (x * 2654435761) ^ (x >> 7);
+    }
+
+    void stream_parallel_map(benchmark::State& state)
+    {
+        const gp_std::Stream<int64_t> stream = make_stream(state.range(0));
+        for (auto _ : state)
+        {
+            gp_std::Stream<int64_t> mapped = stream.parallel_map([](const int64_t& x) { return mix(x); });
+            benchmark::DoNotOptimize(mapped[0]);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(stream_parallel_map)->Apply(sizes);
+
+    void std_transform(benchmark::State& state)
+    {
+        const std::vector<int64_t> data = make_data(state.range(0));
+        for (auto _ : state)
+        {
+            std::vector<int64_t> mapped(data.size());
+            std::transform(data.begin(), data.end(), mapped.begin(), [](const int64_t& x) { return mix(x); });
+            benchmark::DoNotOptimize(mapped[0]);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(std_transform)->Apply(sizes);
+
+    void stream_parallel_filter(benchmark::State& state)
+    {
+        const gp_std::Stream<int64_t> stream = make_stream(state.range(0));
+        for (auto _ : state)
+        {
+            gp_std::Stream<int64_t> kept = stream.parallel_filter([](const int64_t& x) { return (mix(x) & 3) == 0; });
+            benchmark::DoNotOptimize(kept.size());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(stream_parallel_filter)->Apply(sizes);
+
+    void std_copy_if(benchmark::State& state)
+    {
+        const std::vector<int64_t> data = make_data(state.range(0));
+        for (auto _ : state)
+        {
+            std::vector<int64_t> kept;
+            std::copy_if(data.begin(), data.end(), std::back_inserter(kept), [](const int64_t& x) { return (mix(x) & 3) == 0; });
+            benchmark::DoNotOptimize(kept.size());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(std_copy_if)->Apply(sizes);
+
+    void stream_parallel_reduce(benchmark::State& state)
+    {
+        const gp_std::Stream<int64_t> stream = make_stream(state.range(0));
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(stream.parallel_reduce([](const int64_t& a, const int64_t& b) { return a + mix(b); }, int64_t(0)));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(stream_parallel_reduce)->Apply(sizes);
+
+    void std_accumulate(benchmark::State& state)
+    {
+        const std::vector<int64_t> data = make_data(state.range(0));
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(std::accumulate(data.begin(), data.end(), int64_t(0), [](const int64_t& a, const int64_t& b) { return a + mix(b); }));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(std_accumulate)->Apply(sizes);
+
+    // filter, map and reduce fused into one parallel pass
+    void stream_lazy_pipeline(benchmark::State& state)
+    {
+        const gp_std::Stream<int64_t> stream = make_stream(state.range(0));
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(stream.lazy()
+                .filter([](const int64_t& x) { return (x & 1) == 0; })
+                .map([](const int64_t& x) { return mix(x); })
+                .parallel_reduce([](const int64_t& a, const int64_t& b) { return a + b; }, int64_t(0)));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(stream_lazy_pipeline)->Apply(sizes);
+
+    void std_pipeline(benchmark::State& state)
+    {
+        const std::vector<int64_t> data = make_data(state.range(0));
+        for (auto _ : state)
+        {
+            int64_t sum = 0;
+            for (const int64_t& x : data)
+                if ((x & 1) == 0) sum += mix(x);
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(std_pipeline)->Apply(sizes);
+}
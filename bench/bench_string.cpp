@@ -0,0 +1,135 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "string/gp_string.hpp"
+#include "bench_common.hpp"
+
+// gp_std::string against std::string, short strings fit the small string buffer of std::string, long ones do not
+
+namespace
+{
+    void lengths(benchmark::internal::Benchmark* bench)
+    {
+        bench->Arg(8)->Arg(64)->Arg(512);
+    }
+
+    constexpr size_t string_count = 1024;
+
+    void gp_string_construct(benchmark::State& state)
+    {
+        const std::vector<std::string> sources = gp_bench::make_strings(string_count, static_cast<size_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            for (const std::string& source : sources)
+            {
+                gp_std::string str(source.c_str());
+                benchmark::DoNotOptimize(str.c_str());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(string_count));
+    }
+    BENCHMARK(gp_string_construct)->Apply(lengths);
+
+    void std_string_construct(benchmark::State& state)
+    {
+        const std::vector<std::string> sources = gp_bench::make_strings(string_count, static_cast<size_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            for (const std::string& source : sources)
+            {
+                std::string str(source.c_str());
+                benchmark::DoNotOptimize(str.c_str());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(string_count));
+    }
+    BENCHMARK(std_string_construct)->Apply(lengths);
+
+    void gp_string_copy(benchmark::State& state)
+    {
+        const std::vector<std::string> sources = gp_bench::make_strings(string_count, static_cast<size_t>(state.range(0)));
+        std::vector<gp_std::string> strings(sources.begin(), sources.end());
+        for (auto _ : state)
+        {
+            for (const gp_std::string& str : strings)
+            {
+                gp_std::string copy(str);
+                benchmark::DoNotOptimize(copy.c_str());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(string_count));
+    }
+    BENCHMARK(gp_string_copy)->Apply(lengths);
+
+    void std_string_copy(benchmark::State& state)
+    {
+        const std::vector<std::string> strings = gp_bench::make_strings(string_count, static_cast<size_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            for (const std::string& str : strings)
+            {
+                std::string copy(str);
+                benchmark::DoNotOptimize(copy.c_str());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(string_count));
+    }
+    BENCHMARK(std_string_copy)->Apply(lengths);
+
+    // Grows one string piece by piece up to 64 pieces
+    void gp_string_append(benchmark::State& state)
+    {
+        const std::vector<std::string> pieces = gp_bench::make_strings(64, static_cast<size_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            gp_std::string str;
+            for (const std::string& piece : pieces)
+                str += piece.c_str();
+            benchmark::DoNotOptimize(str.c_str());
+        }
+        state.SetItemsProcessed(state.iterations() * 64);
+    }
+    BENCHMARK(gp_string_append)->Apply(lengths);
+
+    void std_string_append(benchmark::State& state)
+    {
+        const std::vector<std::string> pieces = gp_bench::make_strings(64, static_cast<size_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            std::string str;
+            for (const std::string& piece : pieces)
+                str += piece.c_str();
+            benchmark::DoNotOptimize(str.c_str());
+        }
+        state.SetItemsProcessed(state.iterations() * 64);
+    }
+    BENCHMARK(std_string_append)->Apply(lengths);
+
+    // The needle is the tail of the haystack, the search reads all of it
+    void gp_string_find(benchmark::State& state)
+    {
+        const std::string source = gp_bench::make_strings(1, static_cast<size_t>(state.range(0)) * 16).front();
+        const std::string needle = source.substr(source.size() - 8);
+        gp_std::string haystack(source.c_str());
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(haystack.find(needle.c_str()));
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(source.size()));
+    }
+    BENCHMARK(gp_string_find)->Apply(lengths);
+
+    void std_string_find(benchmark::State& state)
+    {
+        const std::string haystack = gp_bench::make_strings(1, static_cast<size_t>(state.range(0)) * 16).front();
+        const std::string needle = haystack.substr(haystack.size() - 8);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(haystack.find(needle));
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(haystack.size()));
+    }
+    BENCHMARK(std_string_find)->Apply(lengths);
+}
@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parallel/gp_taskflow.hpp"
+#include "bench_common.hpp"
+
+// taskflowgraph on a wide DAG (a root, width independent tasks, a sink) and a deep one (a chain of depth tasks)
+// Tasks only bump a counter, what is measured is the scheduling of the edges.
+// Executors : 0 sequential, 1 async, 2 work stealing ; the graph is rerun by execute() or by a compiled plan.
+
+namespace
+{
+    std::atomic<uint64_t> work_done{0};
+
+    gp_std::executor make_executor(const int64_t& kind)
+    {
+        switch (kind)
+        {
+            case 0:  return gp_std::sequential_executor::make();
+            case 1:  return gp_std::async_executor::make();
+            default: return gp_std::work_stealing_executor::make();
+        }
+    }
+
+    const char* executor_name(const int64_t& kind)
+    {
+        return kind == 0 ? "sequential" : kind == 1 ? "async" : "work_stealing";
+    }
+
+    // Names outlive the graph, it keeps them as const char*
+    std::vector<std::string> make_names(const size_t& count)
+    {
+        std::vector<std::string> names(count);
+        for (size_t i = 0; i < count; ++i)
+            names[i] = "task_" + std::to_string(i);
+        return names;
+    }
+
+    void build_wide(gp_std::taskflowgraph& graph, const std::vector<std::string>& names)
+    {
+        for (const std::string& name : names)
+            graph.add_task(name.c_str(), [] { work_done.fetch_add(1, std::memory_order_relaxed); });
+
+        const size_t sink = names.size() - 1;
+        for (size_t i = 1; i < sink; ++i)
+        {
+            graph.add_dependency(names[i].c_str(), names[0].c_str());
+            graph.add_dependency(names[sink].c_str(), names[i].c_str());
+        }
+    }
+
+    void build_deep(gp_std::taskflowgraph& graph, const std::vector<std::string>& names)
+    {
+        for (const std::string& name : names)
+            graph.add_task(name.c_str(), [] { work_done.fetch_add(1, std::memory_order_relaxed); });
+
+        for (size_t i = 1; i < names.size(); ++i)
+            graph.add_dependency(names[i].c_str(), names[i - 1].c_str());
+    }
+
+    // range(0) task count, range(1) executor, range(2) 0 for execute() with dependency counters, 1 for a compiled plan
+    template <void (*Build)(gp_std::taskflowgraph&, const std::vector<std::string>&)>
+    void taskflow(benchmark::State& state)
+    {
+        const std::vector<std::string> names = make_names(static_cast<size_t>(state.range(0)));
+        gp_std::executor executor = make_executor(state.range(1));
+
+        state.SetLabel(std::string(executor_name(state.range(1))) + (state.range(2) == 0 ? " execute" : " compiled"));
+
+        if (state.range(2) == 0)
+        {
+            // A graph runs its tasks once, every iteration gets a fresh one, built and destroyed outside the timing
+            gp_bench::quiet_stdout quiet; // execute() prints a line per run
+            std::unique_ptr<gp_std::taskflowgraph> graph;
+            for (auto _ : state)
+            {
+                state.PauseTiming();
+                graph.reset(new gp_std::taskflowgraph());
+                graph->set_executor(executor);
+                graph->set_scheduling(gp_std::scheduling_mode::dependency_counter);
+                Build(*graph, names);
+                state.ResumeTiming();
+
+                graph->execute();
+            }
+        }
+        else
+        {
+            gp_std::taskflowgraph graph;
+            graph.set_executor(executor);
+            graph.set_scheduling(gp_std::scheduling_mode::dependency_counter);
+            Build(graph, names);
+            gp_std::compiled_taskflow plan = graph.compile();
+            for (auto _ : state)
+                plan.run();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void shapes(benchmark::internal::Benchmark* bench)
+    {
+        bench->ArgNames({"tasks", "executor", "compiled"});
+        for (int64_t tasks : {64, 1024})
+            for (int64_t kind : {0, 1, 2})
+                for (int64_t compiled : {0, 1})
+                    bench->Args({tasks, kind, compiled});
+        bench->UseRealTime();
+    }
+
+    void taskflow_wide(benchmark::State& state) { taskflow<build_wide>(state); }
+    BENCHMARK(taskflow_wide)->Apply(shapes);
+
+    void taskflow_deep(benchmark::State& state) { taskflow<build_deep>(state); }
+    BENCHMARK(taskflow_deep)->Apply(shapes);
+}
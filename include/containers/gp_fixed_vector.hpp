@@ -1,6 +1,11 @@
 #ifndef GP_FIXED_VECTOR_H
 #define GP_FIXED_VECTOR_H
 
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <new>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
@@ -29,8 +34,8 @@ public:
     fixed_vector(const fixed_vector& other);
     fixed_vector& operator=(const fixed_vector& other);
 
-    fixed_vector(fixed_vector&& other);
-    fixed_vector& operator=(fixed_vector&& other);
+    fixed_vector(fixed_vector&& other) noexcept;
+    fixed_vector& operator=(fixed_vector&& other) noexcept;
 
     bool push_back(const T& value);
     bool push_back(T&& value);
@@ -39,7 +44,7 @@ public:
     bool emplace_back(Args&&... args);
 
     template <typename... Args>
-    void resize(size_t new_size, Args&&... args) 
+    void resize(size_type new_size, Args&&... args);
 
     void clear();
 
@@ -10,14 +10,14 @@ fixed_vector<T, N>::fixed_vector() = default;
 // Insert an element at the end
 template <typename T, std::size_t N>
 bool fixed_vector<T, N>::push_back(const T& value) {
-    if (m_size >= N) printf("Fixed vector capacity exceeded") return false;
+    if (m_size >= N) { printf("Fixed vector capacity exceeded\n"); return false; }
     new (&m_data[m_size]) T(value);
     ++m_size; return true;
 }
 
 template <typename T, std::size_t N>
-void fixed_vector<T, N>::push_back(T&& value) {
-    if (m_size >= N) printf("Fixed vector capacity exceeded") return false;
+bool fixed_vector<T, N>::push_back(T&& value) {
+    if (m_size >= N) { printf("Fixed vector capacity exceeded\n"); return false; }
     new (&m_data[m_size]) T(std::move(value));
     ++m_size; return true;
 }
@@ -26,7 +26,7 @@ void fixed_vector<T, N>::push_back(T&& value) {
 template <typename T, std::size_t N>
 template <typename... Args>
 bool fixed_vector<T, N>::emplace_back(Args&&... args) {
-    if (m_size >= N) printf("Fixed vector capacity exceeded") return false;
+    if (m_size >= N) { printf("Fixed vector capacity exceeded\n"); return false; }
     new (&m_data[m_size]) T(std::forward<Args>(args)...);
     ++m_size ; return true;
 }
@@ -37,11 +37,15 @@ fixed_vector<T, N>::~fixed_vector() {
     clear();
 }
 
-// Copy Constructor
+// Copy Constructor, one memcpy for trivially copyable T
 template <typename T, std::size_t N>
 fixed_vector<T, N>::fixed_vector(const fixed_vector& other) {
-    for (size_type i = 0; i < other.m_size; ++i) {
-        new (&m_data[i]) T(other[i]);  // Copy construct each element
+    if (std::is_trivially_copyable<T>::value) {
+        std::memcpy(static_cast<void*>(m_data), other.m_data, other.m_size * sizeof(T));
+    } else {
+        for (size_type i = 0; i < other.m_size; ++i) {
+            new (&m_data[i]) T(other[i]);  // Copy construct each element
+        }
     }
     m_size = other.m_size;
 }
@@ -51,23 +55,30 @@ template <typename T, std::size_t N>
 fixed_vector<T, N>& fixed_vector<T, N>::operator=(const fixed_vector& other) {
     if (this != &other) {
         clear();
-        for (size_type i = 0; i < other.m_size; ++i) {
-            new (&m_data[i]) T(other[i]);  // Copy construct each element
+        if (std::is_trivially_copyable<T>::value) {
+            std::memcpy(static_cast<void*>(m_data), other.m_data, other.m_size * sizeof(T));
+        } else {
+            for (size_type i = 0; i < other.m_size; ++i) {
+                new (&m_data[i]) T(other[i]);  // Copy construct each element
+            }
         }
         m_size = other.m_size;
     }
     return *this;
 }
 
-// Move Constructor
+// Move Constructor, the moved from elements are destroyed and other left empty
 template <typename T, std::size_t N>
 fixed_vector<T, N>::fixed_vector(fixed_vector&& other) noexcept {
-    for (size_type i = 0; i < other.m_size; ++i) {
-        new (&m_data[i]) T(std::move(other[i]));  // Move construct elements
+    if (std::is_trivially_copyable<T>::value) {
+        std::memcpy(static_cast<void*>(m_data), other.m_data, other.m_size * sizeof(T));
+    } else {
+        for (size_type i = 0; i < other.m_size; ++i) {
+            new (&m_data[i]) T(std::move(other[i]));  // Move construct elements
+        }
     }
     m_size = other.m_size;
-    other.m_size = 0;  // Reset source
-    other.clear();
+    other.clear();  // Reset source
 }
 
 // Move Assignment Operator
@@ -75,12 +86,15 @@ template <typename T, std::size_t N>
 fixed_vector<T, N>& fixed_vector<T, N>::operator=(fixed_vector&& other) noexcept {
     if (this != &other) {
         clear();
-        for (size_type i = 0; i < other.m_size; ++i) {
-            new (&m_data[i]) T(std::move(other[i]));  // Move construct elements
+        if (std::is_trivially_copyable<T>::value) {
+            std::memcpy(static_cast<void*>(m_data), other.m_data, other.m_size * sizeof(T));
+        } else {
+            for (size_type i = 0; i < other.m_size; ++i) {
+                new (&m_data[i]) T(std::move(other[i]));  // Move construct elements
+            }
         }
         m_size = other.m_size;
-        other.m_size = 0;  // Reset source
-        other.clear();
+        other.clear();  // Reset source
     }
     return *this;
 }
@@ -187,10 +201,20 @@ void fixed_vector<T, N>::pop_back() {
 template <typename T, std::size_t N>
 typename fixed_vector<T, N>::iterator fixed_vector<T, N>::erase(iterator pos) {
     if (pos < begin() || pos >= end()) throw std::out_of_range("Erase out of range");
-    pos->~T();
-    std::move(pos + 1, end(), pos);
-    --m_size;
-    return pos;
+    return erase(pos, pos + 1);
+}
+
+// Remove the elements in [first, last), the ones after shift down
+template <typename T, std::size_t N>
+typename fixed_vector<T, N>::iterator fixed_vector<T, N>::erase(iterator first, iterator last) {
+    if (first < begin() || last > end() || first > last) throw std::out_of_range("Erase out of range");
+    if (first == last) return first;
+    iterator new_end = std::move(last, end(), first);
+    for (iterator it = new_end; it != end(); ++it) {
+        it->~T();
+    }
+    m_size = static_cast<size_type>(new_end - begin());
+    return first;
 }
 
 // Clear all elements
@@ -202,25 +226,23 @@ void fixed_vector<T, N>::clear() {
     m_size = 0;
 }
 
+// Grow with elements built from args (copied, not forwarded, as several may be built) or shrink to new_size
 template <typename T, std::size_t N>
 template <typename... Args>
-void fixed_vector<T, N>::resize(size_t new_size, Args&&... args) {
-    if(new_size > N) printf("Invalid resize !! Greater than Capacity %lu", size());
-        return;
-    
-    if(new_size = m_size) return;
-    
-    else if(new_size < m_size)  
-    {   
-       for(size_type i = new_size; i < m_size; ++i) 
-           reinterpret_cast<T*>(&(m_data[i]))->~T(); 
+void fixed_vector<T, N>::resize(size_type new_size, Args&&... args) {
+    if (new_size > N) { printf("Invalid resize !! %zu is greater than capacity %zu\n", new_size, N); return; }
+
+    if (new_size < m_size)
+    {
+       for (size_type i = new_size; i < m_size; ++i)
+           reinterpret_cast<T*>(&(m_data[i]))->~T();
     }
-    else (new_size > m_size)
+    else
     {
-        for(size_type i = m_size ; i < new_size; ++i)
-            new (&m_data[i]) T(std::forward<Args>(args)...);
+        for (size_type i = m_size; i < new_size; ++i)
+            new (&m_data[i]) T(args...);
     }
-    
+
     m_size = new_size;
 }
 
@@ -0,0 +1,489 @@
+#ifndef _GP_STD_FLAT_DOMAIN_HPP_
+#define _GP_STD_FLAT_DOMAIN_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <new>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GP_FLAT_DOMAIN_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Open addressing storage for one domain of hash_map_128_t (see base_container)
+// Slots live in one flat array, next to it one control byte per slot holds a 7 bit fingerprint of the hash,
+// or marks the slot empty / deleted. A lookup loads a whole group of control bytes (16 with SSE2 / NEON,
+// 32 with AVX2, 8 with the portable fallback), matches the fingerprint against all of them at once and only
+// compares the full 128-bit hash and the key of the slots whose fingerprint matched.
+//
+// Usage :
+// gp_std::hash_map_128_t<uint64_t, Session, gp_std::hash<uint64_t>, gp_std::flat_domain> sessions(64);
+
+namespace gp_std
+{
+    namespace flat_detail
+    {
+        // Control byte values, fingerprints use 0 ... 127 so empty and deleted are the only negative values
+        static constexpr int8_t ctrl_empty   = -128;  // 0b10000000
+        static constexpr int8_t ctrl_deleted = -2;    // 0b11111110
+
+        inline void prefetch(const void* address)
+        {
+        #if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(address);
+        #elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+        #else
+            (void)address;
+        #endif
+        }
+
+        inline size_t count_trailing_zeros(uint64_t bits)
+        {
+        #if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward64(&index, bits);
+            return index;
+        #else
+            return static_cast<size_t>(__builtin_ctzll(bits));
+        #endif
+        }
+
+        /// @brief Set of matching positions inside a group
+        /// @note  Every position owns 2^Shift bits of the mask (1 bit for SSE2 / AVX2, 4 for NEON, 8 for SWAR)
+        template <unsigned Shift>
+        class match_mask
+        {
+        public:
+            explicit match_mask(uint64_t bits) : m_bits(bits) {}
+
+            bool any() const { return m_bits != 0; }
+
+            size_t lowest() const { return count_trailing_zeros(m_bits) >> Shift; }
+
+            void clear_lowest()
+            {
+                const uint64_t lane = (Shift == 0) ? uint64_t(1) : ((uint64_t(1) << (1u << Shift)) - 1);
+                m_bits &= ~(lane << (lowest() << Shift));
+            }
+
+        private:
+            uint64_t m_bits;
+        };
+
+    #if defined(__AVX2__)
+        struct group
+        {
+            static constexpr size_t width = 32;
+            using mask = match_mask<0>;
+
+            explicit group(const int8_t* ctrl) : m_ctrl(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ctrl))) {}
+
+            mask match(int8_t fingerprint) const
+            {
+                return mask(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8(fingerprint), m_ctrl))));
+            }
+
+            mask match_empty() const
+            {
+                return mask(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8(ctrl_empty), m_ctrl))));
+            }
+
+            // Empty or deleted : the only control bytes with the sign bit set
+            mask match_free() const
+            {
+                return mask(static_cast<uint32_t>(_mm256_movemask_epi8(m_ctrl)));
+            }
+
+            __m256i m_ctrl;
+        };
+    #elif defined(GP_FLAT_DOMAIN_SSE2)
+        struct group
+        {
+            static constexpr size_t width = 16;
+            using mask = match_mask<0>;
+
+            explicit group(const int8_t* ctrl) : m_ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+            mask match(int8_t fingerprint) const
+            {
+                return mask(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(fingerprint), m_ctrl))));
+            }
+
+            mask match_empty() const
+            {
+                return mask(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(ctrl_empty), m_ctrl))));
+            }
+
+            mask match_free() const
+            {
+                return mask(static_cast<uint32_t>(_mm_movemask_epi8(m_ctrl)));
+            }
+
+            __m128i m_ctrl;
+        };
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        struct group
+        {
+            static constexpr size_t width = 16;
+            using mask = match_mask<2>;
+
+            explicit group(const int8_t* ctrl) : m_ctrl(vld1q_s8(ctrl)) {}
+
+            // Narrowing shift turns the 16 byte compare result into 4 bits per byte
+            static mask to_mask(uint8x16_t eq)
+            {
+                uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+                return mask(vget_lane_u64(vreinterpret_u64_u8(narrowed), 0));
+            }
+
+            mask match(int8_t fingerprint) const { return to_mask(vceqq_s8(m_ctrl, vdupq_n_s8(fingerprint))); }
+
+            mask match_empty() const { return to_mask(vceqq_s8(m_ctrl, vdupq_n_s8(ctrl_empty))); }
+
+            mask match_free() const { return to_mask(vcltq_s8(m_ctrl, vdupq_n_s8(0))); }
+
+            int8x16_t m_ctrl;
+        };
+    #else
+        // Portable SWAR group of 8 control bytes, match() may report false positives, the full compare filters them
+        struct group
+        {
+            static constexpr size_t width = 8;
+            using mask = match_mask<3>;
+
+            static constexpr uint64_t lsbs = 0x0101010101010101ull;
+            static constexpr uint64_t msbs = 0x8080808080808080ull;
+
+            explicit group(const int8_t* ctrl) { std::memcpy(&m_ctrl, ctrl, sizeof(m_ctrl)); }
+
+            mask match(int8_t fingerprint) const
+            {
+                uint64_t x = m_ctrl ^ (lsbs * static_cast<uint8_t>(fingerprint));
+                return mask((x - lsbs) & ~x & msbs);
+            }
+
+            mask match_empty() const { return mask(m_ctrl & (~m_ctrl << 6) & msbs); }
+
+            mask match_free() const { return mask(m_ctrl & msbs); }
+
+            uint64_t m_ctrl;
+        };
+    #endif
+
+        // The domain index already consumed the low bits of the 128-bit hash, remix before picking a group and a fingerprint
+        template <typename Hash>
+        inline uint64_t mix(const Hash& hash)
+        {
+            uint64_t h = hash[0] ^ (hash[1] * 0x9E3779B97F4A7C15ull);
+            h ^= h >> 32;
+            h *= 0xD6E8FEB86659FD93ull;
+            h ^= h >> 32;
+            return h;
+        }
+    } // namespace flat_detail
+
+    /// @class flat_domain
+    /// @brief Open addressing container of pairs carrying a hash_value, probed by SIMD control byte groups
+    /// @tparam T Element type, must expose hash_value (indexable [0], [1] as uint64_t)
+    /// @note   Slot indices are stable until the next insert that grows the table
+    /// @warning Growth relocates every element, references returned by insert() are invalidated by a later insert
+    template <typename T>
+    class flat_domain
+    {
+    public:
+        using value_type = T;
+        using group = flat_detail::group;
+
+        static constexpr size_t npos = size_t(-1);
+
+        flat_domain() : m_ctrl(nullptr), m_slots(nullptr), m_capacity(0), m_size(0), m_deleted(0), m_last(npos) {}
+
+        flat_domain(const flat_domain& other) : flat_domain()
+        {
+            // The reserve keeps the table from growing, so the slot of the last push_back stays where insert put it
+            reserve(other.m_size);
+            for (size_t slot = 0; slot < other.m_capacity; ++slot)
+            {
+                if (other.occupied(slot))
+                {
+                    size_t placed = insert(other.m_slots[slot]);
+                    if (slot == other.m_last)
+                        m_last = placed;
+                }
+            }
+        }
+
+        flat_domain(flat_domain&& other) noexcept
+            : m_ctrl(std::move(other.m_ctrl)), m_slots(other.m_slots), m_capacity(other.m_capacity), m_size(other.m_size), m_deleted(other.m_deleted), m_last(other.m_last)
+        {
+            other.m_slots = nullptr;
+            other.m_capacity = other.m_size = other.m_deleted = 0;
+            other.m_last = npos;
+        }
+
+        flat_domain& operator=(const flat_domain& other)
+        {
+            if (this != &other)
+            {
+                flat_domain copy(other);
+                swap(copy);
+            }
+            return *this;
+        }
+
+        flat_domain& operator=(flat_domain&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                m_ctrl = std::move(other.m_ctrl);
+                m_slots = other.m_slots;
+                m_capacity = other.m_capacity;
+                m_size = other.m_size;
+                m_deleted = other.m_deleted;
+                m_last = other.m_last;
+                other.m_slots = nullptr;
+                other.m_capacity = other.m_size = other.m_deleted = 0;
+                other.m_last = npos;
+            }
+            return *this;
+        }
+
+        ~flat_domain() { release(); }
+
+        void swap(flat_domain& other) noexcept
+        {
+            std::swap(m_ctrl, other.m_ctrl);
+            std::swap(m_slots, other.m_slots);
+            std::swap(m_capacity, other.m_capacity);
+            std::swap(m_size, other.m_size);
+            std::swap(m_deleted, other.m_deleted);
+            std::swap(m_last, other.m_last);
+        }
+
+        // Live elements
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+        // Number of slots, valid slot indices are [0, slot_count())
+        size_t slot_count() const { return m_capacity; }
+
+        // Erased slots waiting to be reused or dropped by the next rehash
+        size_t deleted_count() const { return m_deleted; }
+
+        bool occupied(size_t slot) const { return slot < m_capacity && m_ctrl[slot] >= 0; }
+
+        T& operator[](size_t slot) { return m_slots[slot]; }
+        const T& operator[](size_t slot) const { return m_slots[slot]; }
+
+        /// @brief Slot of the element whose hash_value equals hash and for which equal(element) holds, npos if none
+        template <typename Hash, typename KeyEqual>
+        size_t find(const Hash& hash, KeyEqual&& equal) const
+        {
+            if (m_capacity == 0)
+                return npos;
+
+            const uint64_t h = flat_detail::mix(hash);
+            const int8_t fingerprint = fingerprint_of(h);
+            const size_t group_mask = m_capacity / group::width - 1;
+
+            size_t g = group_of(h) & group_mask;
+            for (size_t probe = 0; probe <= group_mask; ++probe)
+            {
+                const size_t base = g * group::width;
+                group grp(m_ctrl.get() + base);
+
+                for (typename group::mask match = grp.match(fingerprint); match.any(); match.clear_lowest())
+                {
+                    size_t slot = base + match.lowest();
+                    if (m_ctrl[slot] == fingerprint && m_slots[slot].hash_value == hash && equal(m_slots[slot]))
+                        return slot;
+                }
+
+                // An empty slot ends every probe sequence that went through this group
+                if (grp.match_empty().any())
+                    return npos;
+
+                // Triangular probing over groups visits every group once when the group count is a power of two
+                g = (g + probe + 1) & group_mask;
+            }
+            return npos;
+        }
+
+        /// @brief Hint the cache with the control bytes find(hash) starts probing at
+        template <typename Hash>
+        void prefetch(const Hash& hash) const
+        {
+            if (m_capacity == 0)
+                return;
+
+            const size_t group_mask = m_capacity / group::width - 1;
+            flat_detail::prefetch(m_ctrl.get() + (group_of(flat_detail::mix(hash)) & group_mask) * group::width);
+        }
+
+        /// @brief Inserts an element known to be absent and returns its slot
+        template <typename... Args>
+        size_t emplace(Args&&... args)
+        {
+            reserve(m_size + 1);
+
+            // Build the element first, its hash_value decides the slot
+            alignas(T) unsigned char staging[sizeof(T)];
+            T* element = ::new (static_cast<void*>(staging)) T(std::forward<Args>(args)...);
+
+            size_t slot = free_slot(flat_detail::mix(element->hash_value));
+            try
+            {
+                ::new (static_cast<void*>(m_slots + slot)) T(std::move(*element));
+            }
+            catch (...)
+            {
+                element->~T();
+                throw;
+            }
+            element->~T();
+
+            mark(slot, fingerprint_of(flat_detail::mix(m_slots[slot].hash_value)));
+            return slot;
+        }
+
+        size_t insert(const T& value) { return emplace(value); }
+        size_t insert(T&& value) { return emplace(std::move(value)); }
+
+        // Drop-in for sequence containers : push_back() inserts, the element is then reachable by slot
+        void push_back(const T& value) { m_last = insert(value); }
+        void push_back(T&& value) { m_last = insert(std::move(value)); }
+        T& back() { return m_slots[m_last]; }
+
+        void erase(size_t slot)
+        {
+            if (!occupied(slot))
+                return;
+
+            m_slots[slot].~T();
+            m_ctrl[slot] = flat_detail::ctrl_deleted;
+            --m_size;
+            ++m_deleted;
+        }
+
+        void clear()
+        {
+            for (size_t slot = 0; slot < m_capacity; ++slot)
+            {
+                if (m_ctrl[slot] >= 0)
+                    m_slots[slot].~T();
+                m_ctrl[slot] = flat_detail::ctrl_empty;
+            }
+            m_size = 0;
+            m_deleted = 0;
+        }
+
+        /// @brief Makes room for count live elements at the 7/8 maximum load factor
+        void reserve(size_t count)
+        {
+            if ((count + m_deleted) * 8 <= m_capacity * 7)
+                return;
+
+            // Mostly tombstones : rebuild at the same size, otherwise double
+            size_t capacity = m_capacity == 0 ? group::width : m_capacity;
+            while (count * 8 > capacity * 7 || (capacity == m_capacity && count * 16 > capacity * 7))
+                capacity *= 2;
+
+            rehash(capacity);
+        }
+
+        /// @brief Rebuilds the table with capacity slots (a power of two multiple of the group width), drops tombstones
+        void rehash(size_t capacity)
+        {
+            flat_domain rebuilt;
+            rebuilt.allocate(capacity);
+
+            for (size_t slot = 0; slot < m_capacity; ++slot)
+            {
+                if (m_ctrl[slot] < 0)
+                    continue;
+
+                const uint64_t h = flat_detail::mix(m_slots[slot].hash_value);
+                size_t target = rebuilt.free_slot(h);
+                ::new (static_cast<void*>(rebuilt.m_slots + target)) T(std::move(m_slots[slot]));
+                rebuilt.mark(target, fingerprint_of(h));
+            }
+
+            swap(rebuilt);
+        }
+
+    private:
+        static int8_t fingerprint_of(uint64_t h) { return static_cast<int8_t>(h & 0x7F); }
+        static size_t group_of(uint64_t h) { return static_cast<size_t>(h >> 7); }
+
+        // First empty or deleted slot on the probe sequence of h, the table must have room
+        size_t free_slot(uint64_t h) const
+        {
+            const size_t group_mask = m_capacity / group::width - 1;
+            size_t g = group_of(h) & group_mask;
+            for (size_t probe = 0;; ++probe)
+            {
+                const size_t base = g * group::width;
+                typename group::mask free = group(m_ctrl.get() + base).match_free();
+                if (free.any())
+                    return base + free.lowest();
+                g = (g + probe + 1) & group_mask;
+            }
+        }
+
+        void mark(size_t slot, int8_t fingerprint)
+        {
+            if (m_ctrl[slot] == flat_detail::ctrl_deleted)
+                --m_deleted;
+            m_ctrl[slot] = fingerprint;
+            ++m_size;
+        }
+
+        void allocate(size_t capacity)
+        {
+            m_ctrl.reset(new int8_t[capacity]);
+            std::memset(m_ctrl.get(), static_cast<unsigned char>(flat_detail::ctrl_empty), capacity);
+            m_slots = std::allocator<T>().allocate(capacity);
+            m_capacity = capacity;
+            m_size = 0;
+            m_deleted = 0;
+        }
+
+        void release()
+        {
+            if (m_slots == nullptr)
+                return;
+
+            for (size_t slot = 0; slot < m_capacity; ++slot)
+            {
+                if (m_ctrl[slot] >= 0)
+                    m_slots[slot].~T();
+            }
+            std::allocator<T>().deallocate(m_slots, m_capacity);
+            m_slots = nullptr;
+            m_ctrl.reset();
+            m_capacity = m_size = m_deleted = 0;
+        }
+
+        std::unique_ptr<int8_t[]> m_ctrl;
+        T* m_slots;
+        size_t m_capacity;
+        size_t m_size;
+        size_t m_deleted;
+        size_t m_last;
+    };
+} // namespace gp_std
+
+#endif
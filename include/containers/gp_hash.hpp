@@ -1,86 +1,209 @@
 #ifndef _GP_STD_HASH_TYPE_HPP_
 #define _GP_STD_HASH_TYPE_HPP_
 
+#include <cassert>
+#include <cstddef>
 #include <cstdint>
-#include <sstream>
-#include "gp_array.hpp"
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GP_HASH_T_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GP_HASH_T_NEON 1
+#endif
+
+// hash_t<Size> : a Size bit key held as Size / 32 words, compared four words at a time with SSE2 or NEON
+// Built two ways :
+//   hash_t<128>(a, b, c)              the fields themselves, one word each (truncated to 32 bits)
+//   hash_t<128>::mix(id, "orders", 7) every field mixed into all the words, any number of fields of any width
+// mix and hash_encoder never allocate and are constexpr for integers, enums and strings (literals, std::string_view),
+// floating point and pointer fields are runtime only.
+//
+// Usage :
+// constexpr auto route = gp_std::hash_t<128>::mix("orders", 42);
+// gp_std::hash_encoder<256> encoder;
+// encoder.add(client_id).add(symbol).add(price);
+// gp_std::hash_t<256> key = encoder.finish();
+//
+// hash_map_128_t<hash_t<128>, Value, gp_std::passthrough_hash> takes mixed keys as their own hash (gp_hashmap.hpp)
 
 namespace gp_std
 {
+    template <size_t Size>
+    class hash_encoder;
+
+    namespace hash_t_detail
+    {
+        // wyhash v4 secrets, as used by the hashes of gp_hashmap.hpp
+        static constexpr uint64_t secret[4] = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+
+        ///@brief Folded 64 x 64 -> 128 bit multiply, usable in constant expressions
+        constexpr uint64_t mum(uint64_t a, uint64_t b)
+        {
+        #if defined(__SIZEOF_INT128__)
+            const __uint128_t r = static_cast<__uint128_t>(a) * b;
+            return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+        #else
+            const uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+            const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+            const uint64_t t = rl + (rm0 << 32);
+            const uint64_t lo = t + (rm1 << 32);
+            const uint64_t carry = static_cast<uint64_t>(t < rl) + static_cast<uint64_t>(lo < t);
+            return lo ^ (rh + (rm0 >> 32) + (rm1 >> 32) + carry);
+        #endif
+        }
+
+        inline unsigned lowest_bit(uint64_t mask)
+        {
+        #if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_ctzll(mask));
+        #else
+            unsigned index = 0;
+            while ((mask & 1) == 0) { mask >>= 1; ++index; }
+            return index;
+        #endif
+        }
+
+        ///@brief Index of the first word where a and b differ, count if they are equal
+        inline size_t first_difference(const uint32_t* a, const uint32_t* b, const size_t& count)
+        {
+            size_t i = 0;
+        #if defined(GP_HASH_T_SSE2)
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+                const uint32_t differ = ~static_cast<uint32_t>(_mm_movemask_epi8(equal)) & 0xFFFF; // four bits per word
+                if (differ != 0)
+                    return i + lowest_bit(differ) / 4;
+            }
+        #elif defined(GP_HASH_T_NEON)
+            for (; i + 4 <= count; i += 4)
+            {
+                const uint32x4_t equal = vceqq_u32(vld1q_u32(a + i), vld1q_u32(b + i));
+                const uint64_t differ = ~vget_lane_u64(vreinterpret_u64_u16(vmovn_u32(equal)), 0); // sixteen bits per word
+                if (differ != 0)
+                    return i + lowest_bit(differ) / 16;
+            }
+        #endif
+            for (; i < count; ++i)
+                if (a[i] != b[i]) return i;
+            return count;
+        }
+
+        ///@brief All count words of a and b equal, one branch per 128 bits
+        inline bool equal_words(const uint32_t* a, const uint32_t* b, const size_t& count)
+        {
+            size_t i = 0;
+        #if defined(GP_HASH_T_SSE2)
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+                if (_mm_movemask_epi8(equal) != 0xFFFF) return false;
+            }
+        #elif defined(GP_HASH_T_NEON)
+            for (; i + 4 <= count; i += 4)
+            {
+                const uint32x4_t equal = vceqq_u32(vld1q_u32(a + i), vld1q_u32(b + i));
+                if (~vget_lane_u64(vreinterpret_u64_u16(vmovn_u32(equal)), 0) != 0) return false;
+            }
+        #endif
+            for (; i < count; ++i)
+                if (a[i] != b[i]) return false;
+            return true;
+        }
+    }
+
     template <size_t Size>
     class hash_t
     {
         static_assert(Size >= 32 && Size % 32 == 0, "Size must be a multiple of 32 and above 32 * 2^n {n = {0,1 ... }}");
 
+    public:
+        static constexpr size_t word_count = Size / 32;
+
     private:
-        gp_std::array<uint32_t, Size / 32> data;
+        uint32_t data[word_count];
 
     public:
-        hash_t()
+        constexpr hash_t() : data{} {}
+
+        template <typename... Fields>
+        constexpr hash_t(Fields... fields) : data{ static_cast<uint32_t>(fields)... }
         {
-            data.fill(0);
+            static_assert(sizeof...(Fields) <= Size / 32, "Exceeded maximum number of fields, must be less than Size / 32");
         }
 
+        ///@brief All fields mixed into every word, see hash_encoder
         template <typename... Fields>
-        hash_t(Fields... fields)
+        static constexpr hash_t mix(const Fields&... fields)
         {
-            data.fill(0);
-            encode_hash(fields...);
+            hash_encoder<Size> encoder;
+            (encoder.add(fields), ...);
+            return encoder.finish();
         }
 
-        bool operator==(const hash_t<Size> &other) const  { return data == other.data; }
+        // Word 0 is the most significant for the ordering
+        bool operator==(const hash_t<Size> &other) const  { return hash_t_detail::equal_words(data, other.data, word_count); }
         bool operator!=(const hash_t<Size> &other) const  { return !(*this == other);  }
-        bool operator<(const hash_t<Size> &other)  const  { return data < other.data;  }
-        bool operator>(const hash_t<Size> &other)  const  { return data > other.data;  }
-        bool operator<=(const hash_t<Size> &other) const  { return data <= other.data; }
-        bool operator>=(const hash_t<Size> &other) const  { return data >= other.data; }
+        bool operator<(const hash_t<Size> &other)  const
+        {
+            const size_t i = hash_t_detail::first_difference(data, other.data, word_count);
+            return i != word_count && data[i] < other.data[i];
+        }
+        bool operator>(const hash_t<Size> &other)  const  { return other < *this;      }
+        bool operator<=(const hash_t<Size> &other) const  { return !(other < *this);   }
+        bool operator>=(const hash_t<Size> &other) const  { return !(*this < other);   }
 
-        operator bool() const 
+        // True when any word is set
+        constexpr explicit operator bool() const
         {
-            for(size_t& i : data)
-            { if(i > 0) return false; }
-            return true;
+            for(const uint32_t& i : data)
+            { if(i != 0) return true; }
+            return false;
         }
-        
-        void set_32_bit_field(const size_t& index, const uint32_t& value)
+
+        constexpr void set_32_bit_field(const size_t& index, const uint32_t& value)
         {
-             assert(index < Size && "set 32 bit field called with out of range error");
+             assert(index < word_count && "set 32 bit field called with out of range error");
              data[index] = value;
-        } 
+        }
 
-        uint32_t operator[](const size_t& index) const
+        constexpr uint32_t operator[](const size_t& index) const
         {
-             assert(index < Size && "gp_std::hash_t::operator[] called with out of range error");
+             assert(index < word_count && "gp_std::hash_t::operator[] called with out of range error");
              return data[index];
         }
-  
-        // Encode hash_t with variadic template parameters
+
+        ///@brief The word_count words, for hashing or copying the key as bytes
+        constexpr const uint32_t* words() const { return data; }
+
+        // Encode hash_t with variadic template parameters, one field per word
         template <typename... Fields>
-        void encode_hash(Fields... fields)
+        constexpr void encode_hash(Fields... fields)
         {
             static_assert(sizeof...(Fields) <= Size / 32, "Exceeded maximum number of fields, must be less than Size / 32");
-
-            gp_std::array<uint32_t, Size / 32> temp = {0}; // Ensure all elements are initialized to 0
-            gp_std::array<uint32_t, sizeof...(Fields)> field_values = {static_cast<uint32_t>(fields)...};
-
-            for (size_t i = 0; i < field_values.size(); ++i)
-            { temp[i] = field_values[i]; }
-
-            data = temp;
+            *this = hash_t(fields...);
         }
 
-        void invalidate()
+        constexpr void invalidate()
         {
              for(uint32_t& i : data) i = 0xffffffff;
         }
 
-        bool is_numeric_limit() const
+        constexpr bool is_numeric_limit() const
         {
             for(const uint32_t& i : data) if(i != 0xffffffff) return false;
-            return true
+            return true;
         }
 
-        bool is_valid() const
+        constexpr bool is_valid() const
         {
             return !is_numeric_limit();
         }
@@ -89,7 +212,7 @@ namespace gp_std
         friend std::ostream& operator<<(std::ostream &os, const hash_t<Size> &hash_t)
         {
             os << std::hex;
-            for (size_t i = 0; i < hash_t.data.size(); ++i)
+            for (size_t i = 0; i < word_count; ++i)
             {
                 if (i > 0)
                     os << ":";
@@ -99,11 +222,13 @@ namespace gp_std
             return os;
         }
 
-        // Stream input operator (reads hex values)
+        // Stream input operator (reads hex values, separated as operator<< writes them)
         friend std::istream &operator>>(std::istream &is, hash_t<Size> &hash_t)
         {
             for (auto &val : hash_t.data)
             {
+                if (&val != hash_t.data && is.peek() == ':')
+                    is.get();
                 is >> std::hex >> val;
             }
             is >> std::dec; // Restore decimal format
@@ -111,5 +236,156 @@ namespace gp_std
         }
     };
 
+    /// @class hash_encoder
+    /// @brief Streaming mix of fields into a hash_t<Size>, no allocation and constexpr for integers, enums and strings
+    /// @note  One 64-bit lane per two words, each field folds into every lane with secrets of its own,
+    /// @note  so the lanes are independent hashes and a 256 bit key collides like a 256 bit key.
+    /// @note  Strings are mixed with their length : ("ab", "c") and ("a", "bc") give different keys.
+    template <size_t Size>
+    class hash_encoder
+    {
+        static constexpr size_t lane_count = (hash_t<Size>::word_count + 1) / 2;
+
+    public:
+        constexpr explicit hash_encoder(const uint64_t& seed = 0) : m_lanes{}, m_fields(0)
+        {
+            for (size_t i = 0; i < lane_count; ++i)
+                m_lanes[i] = hash_t_detail::mum(seed ^ key(i), hash_t_detail::secret[1]);
+        }
+
+        // Integers, enums, bool and char : the value widened to 64 bits
+        template <typename Field>
+        constexpr typename std::enable_if<std::is_integral<Field>::value || std::is_enum<Field>::value, hash_encoder&>::type
+        add(const Field& field)
+        {
+            absorb(static_cast<uint64_t>(field));
+            ++m_fields;
+            return *this;
+        }
+
+        // Strings, literals and anything converting to std::string_view
+        constexpr hash_encoder& add(std::string_view text)
+        {
+            absorb(static_cast<uint64_t>(text.size()));
+            size_t i = 0;
+            for (; i + 8 <= text.size(); i += 8)
+                absorb(read_64(text, i, 8));
+            if (i < text.size())
+                absorb(read_64(text, i, text.size() - i));
+            ++m_fields;
+            return *this;
+        }
+
+        // +0.0 and -0.0 compare equal so they have to mix equal
+        template <typename Field>
+        typename std::enable_if<std::is_floating_point<Field>::value, hash_encoder&>::type
+        add(const Field& field)
+        {
+            static_assert(sizeof(Field) <= sizeof(uint64_t), "hash_encoder : floating point fields up to 64 bits");
+            const Field value = (field == Field(0)) ? Field(0) : field;
+            uint64_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(Field));
+            absorb(bits);
+            ++m_fields;
+            return *this;
+        }
+
+        template <typename Field>
+        typename std::enable_if<std::is_pointer<Field>::value && !std::is_convertible<Field, std::string_view>::value, hash_encoder&>::type
+        add(const Field& field)
+        {
+            absorb(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(field)));
+            ++m_fields;
+            return *this;
+        }
+
+        // Another key as a field, all of its words
+        template <size_t OtherSize>
+        constexpr hash_encoder& add(const hash_t<OtherSize>& other)
+        {
+            for (size_t i = 0; i < hash_t<OtherSize>::word_count; i += 2)
+            {
+                const uint64_t high = i + 1 < hash_t<OtherSize>::word_count ? static_cast<uint64_t>(other[i + 1]) << 32 : 0;
+                absorb(high | other[i]);
+            }
+            ++m_fields;
+            return *this;
+        }
+
+        ///@brief The key of the fields added so far, the encoder can keep going after
+        constexpr hash_t<Size> finish() const
+        {
+            hash_t<Size> result;
+            for (size_t i = 0; i < lane_count; ++i)
+            {
+                const uint64_t lane = hash_t_detail::mum(m_lanes[i] ^ hash_t_detail::secret[0] ^ m_fields, key(i + 1));
+                result.set_32_bit_field(2 * i, static_cast<uint32_t>(lane));
+                if (2 * i + 1 < hash_t<Size>::word_count)
+                    result.set_32_bit_field(2 * i + 1, static_cast<uint32_t>(lane >> 32));
+            }
+            return result;
+        }
+
+    private:
+        // A different odd multiplier per lane, so no two lanes compute the same function
+        static constexpr uint64_t key(const size_t& lane)
+        {
+            return (hash_t_detail::secret[lane & 3] + 0x9e3779b97f4a7c15ull * (lane >> 2)) | 1;
+        }
+
+        struct key_table
+        {
+            uint64_t in[lane_count];
+            uint64_t out[lane_count];
+        };
+
+        static constexpr key_table make_keys()
+        {
+            key_table keys{};
+            for (size_t i = 0; i < lane_count; ++i)
+            {
+                keys.in[i] = key(i);
+                keys.out[i] = key(i + 1) ^ hash_t_detail::secret[2];
+            }
+            return keys;
+        }
+
+        static constexpr key_table keys = make_keys();
+
+        // The multiply can zero its product, adding the lane back keeps what it had seen
+        constexpr void absorb(const uint64_t& word)
+        {
+            absorb(word, std::make_index_sequence<lane_count>());
+        }
+
+        // Spelled out per lane, the independent multiplies of one word overlap at any optimisation level
+        template <size_t... Lanes>
+        constexpr void absorb(const uint64_t word, std::index_sequence<Lanes...>)
+        {
+            ((m_lanes[Lanes] += hash_t_detail::mum(m_lanes[Lanes] ^ word ^ keys.in[Lanes], keys.out[Lanes])), ...);
+        }
+
+        // Little endian, so the same string mixes the same on every target
+        static constexpr uint64_t read_64(std::string_view text, const size_t& offset, const size_t& count)
+        {
+        #if (defined(__GNUC__) || defined(__clang__)) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            // The byte loop is what a constant expression can do, at run time a load does the same
+            if (!__builtin_is_constant_evaluated())
+            {
+                uint64_t loaded = 0;
+                std::memcpy(&loaded, text.data() + offset, count);
+                return loaded;
+            }
+        #endif
+            uint64_t word = 0;
+            for (size_t k = 0; k < count; ++k)
+                word |= static_cast<uint64_t>(static_cast<unsigned char>(text[offset + k])) << (8 * k);
+            return word;
+        }
+
+        uint64_t m_lanes[lane_count];
+        uint64_t m_fields;
+    };
+
 } // namespace gp_std
 #endif
@@ -1,17 +1,36 @@
 #ifndef _GP_STD_128_BIT_HASH_MAP_H_
 #define _GP_STD_128_BIT_HASH_MAP_H_
 
+#include <atomic>
 #include <deque>
 #include <memory>
+#include <new>
 #include <vector>
 #include <array>
 #include <stack>
 #include <stdexcept>
 #include <algorithm>
-#include "gp_atomic.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include "../parallel/gp_atomic.hpp"
 #include "gp_optional.hpp"
-#include "gp_compute_device.hpp"
-#include "gp_scopeguard.hpp"
+#include "gp_hash.hpp"
+#include "../parallel/gp_compute_device.hpp"
+#include "../scope/gp_scopeguard.hpp"
+#include "gp_flat_domain.hpp"
+#include "gp_snapshot_domain.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GP_HASHMAP_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GP_HASHMAP_NEON 1
+#endif
 
 namespace gp_std
 {
@@ -245,12 +264,12 @@ namespace gp_std
             _128_bit_id._64_bit_id[1] = 0xffffffffffffffff;
         }
 
-        bool is_numeric_limit()
+        bool is_numeric_limit() const
         {
             return _128_bit_id._64_bit_id[0] == 0xffffffffffffffff && _128_bit_id._64_bit_id[1] == 0xffffffffffffffff;
         }
 
-        bool is_valid()
+        bool is_valid() const
         {
             return !is_numeric_limit();
         }
@@ -259,31 +278,493 @@ namespace gp_std
      /// @brief Custom hash128_t type
      using hash128_t = _128_BIT_HASH_;
  
-    /// @brief Custom hash function specialization for _128_BIT_HASH_
-    /// Example : Custom hash function specialization for _128_BIT_HASH_
+    namespace hash_detail
+    {
+        // wyhash v4 secrets
+        static constexpr uint64_t secret[4] = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+
+        ///@brief 64 x 64 -> 128 bit multiply, a and b receive the low and high halves
+        inline void mul_128(uint64_t& a, uint64_t& b)
+        {
+        #if defined(__SIZEOF_INT128__)
+            __uint128_t r = static_cast<__uint128_t>(a) * b;
+            a = static_cast<uint64_t>(r);
+            b = static_cast<uint64_t>(r >> 64);
+        #elif defined(_MSC_VER) && defined(_M_X64)
+            a = _umul128(a, b, &b);
+        #else
+            uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+            uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+            uint64_t t = rl + (rm0 << 32);
+            uint64_t c = t < rl;
+            uint64_t lo = t + (rm1 << 32);
+            c += lo < t;
+            a = lo;
+            b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+        #endif
+        }
+
+        ///@brief Folded multiply, the mixing primitive of the hashes below
+        inline uint64_t mum(uint64_t a, uint64_t b)
+        {
+            mul_128(a, b);
+            return a ^ b;
+        }
+
+        inline uint64_t read_64(const unsigned char* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+        inline uint64_t read_32(const unsigned char* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+        inline uint64_t read_3(const unsigned char* p, const size_t& len)
+        {
+            return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+        }
+
+        ///@brief 128-bit hash of a byte range (wyhash core, two independent final mixes)
+        inline hash128_t hash_bytes(const void* data, const size_t& len, uint64_t seed = 0)
+        {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            seed ^= mum(seed ^ secret[0], secret[1]);
+
+            uint64_t a = 0, b = 0;
+            if (len <= 16)
+            {
+                if (len >= 4)
+                {
+                    const size_t skip = (len >> 3) << 2;
+                    a = (read_32(p) << 32) | read_32(p + skip);
+                    b = (read_32(p + len - 4) << 32) | read_32(p + len - 4 - skip);
+                }
+                else if (len > 0)
+                {
+                    a = read_3(p, len);
+                }
+            }
+            else
+            {
+                size_t i = len;
+                if (i > 48)
+                {
+                    uint64_t see1 = seed, see2 = seed;
+                    do
+                    {
+                        seed = mum(read_64(p) ^ secret[1], read_64(p + 8) ^ seed);
+                        see1 = mum(read_64(p + 16) ^ secret[2], read_64(p + 24) ^ see1);
+                        see2 = mum(read_64(p + 32) ^ secret[3], read_64(p + 40) ^ see2);
+                        p += 48; i -= 48;
+                    } while (i > 48);
+                    seed ^= see1 ^ see2;
+                }
+                while (i > 16)
+                {
+                    seed = mum(read_64(p) ^ secret[1], read_64(p + 8) ^ seed);
+                    p += 16; i -= 16;
+                }
+                a = read_64(p + i - 16);
+                b = read_64(p + i - 8);
+            }
+
+            a ^= secret[1];
+            b ^= seed;
+            mul_128(a, b);
+
+            hash128_t hash_val;
+            hash_val[0] = mum(a ^ secret[0] ^ len, b ^ secret[1]);
+            hash_val[1] = mum(a ^ secret[2], b ^ secret[3] ^ len);
+            return hash_val;
+        }
+
+        ///@brief 128-bit hash of a single 64-bit word, two multiply-folds with different secrets
+        inline hash128_t hash_integer(const uint64_t& value)
+        {
+            hash128_t hash_val;
+            hash_val[0] = mum(value ^ secret[0], secret[1]);
+            hash_val[1] = mum(value ^ secret[2], secret[3]);
+            return hash_val;
+        }
+
+        template <size_t N> struct rank : rank<N - 1> {};
+        template <> struct rank<0> {};
+
+        // Integers, enums and pointers : the value itself is the key
+        template <typename K>
+        typename std::enable_if<std::is_integral<K>::value || std::is_enum<K>::value, hash128_t>::type
+        hash_value(const K& key, rank<3>) { return hash_integer(static_cast<uint64_t>(key)); }
+
+        template <typename K>
+        typename std::enable_if<std::is_pointer<K>::value, hash128_t>::type
+        hash_value(const K& key, rank<3>) { return hash_integer(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key))); }
+
+        // Bytes of a floating point value that hold its bits, the x87 80-bit long double is padded to 12 or 16 bytes
+        template <typename K>
+        constexpr size_t significant_bytes()
+        {
+            return (std::numeric_limits<K>::digits == 64 && sizeof(K) > 10) ? 10 : sizeof(K);
+        }
+
+        // +0.0 and -0.0 compare equal so they have to hash equal, the padding is left out as it holds garbage
+        template <typename K>
+        typename std::enable_if<std::is_floating_point<K>::value, hash128_t>::type
+        hash_value(const K& key, rank<3>)
+        {
+            K value = (key == K(0)) ? K(0) : key;
+            return hash_bytes(&value, significant_bytes<K>());
+        }
+
+        // std::string, gp_std::string, gp_std::array_string ... anything exposing c_str() and size()
+        template <typename K>
+        auto hash_value(const K& key, rank<2>) -> decltype(static_cast<const char*>(key.c_str()), static_cast<size_t>(key.size()), hash128_t())
+        {
+            return hash_bytes(key.c_str(), key.size() * sizeof(*key.c_str()));
+        }
+
+        // std::string_view and other character ranges exposing data() and size()
+        template <typename K>
+        auto hash_value(const K& key, rank<1>) -> decltype(static_cast<const char*>(key.data()), static_cast<size_t>(key.size()), hash128_t())
+        {
+            return hash_bytes(key.data(), key.size());
+        }
+
+        // Everything else : std::hash gives 64 bits, spread them over both words
+        template <typename K>
+        hash128_t hash_value(const K& key, rank<0>) { return hash_integer(static_cast<uint64_t>(std::hash<K>{}(key))); }
+
+        inline void prefetch(const void* address)
+        {
+        #if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(address);
+        #elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+        #else
+            (void)address;
+        #endif
+        }
+
+        // Pairs a device search compares before it branches once on the whole batch
+        static constexpr size_t scan_batch = 16;
+        static constexpr size_t no_match = size_t(-1);
+
+    #if defined(GP_HASHMAP_SSE2)
+        inline __m128i load_hash(const hash128_t& hash_val)
+        {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(&hash_val[0]));
+        }
+
+        inline uint32_t equal_hash(const __m128i& hash_val, const __m128i& target)
+        {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi32(hash_val, target)) == 0xFFFF);
+        }
+    #endif
+
+        ///@brief Bit k is set when the hash_value of the k-th pair from it equals hash_val, count <= scan_batch
+        /// @note  One 128-bit compare per pair and no branch on the data, the caller branches once per batch
+        template <typename Iterator>
+        inline uint32_t match_batch(Iterator it, const size_t& count, const hash128_t& hash_val)
+        {
+            uint32_t mask = 0;
+        #if defined(GP_HASHMAP_SSE2)
+            const __m128i target = load_hash(hash_val);
+            for (size_t k = 0; k < count; ++k, ++it)
+                mask |= equal_hash(load_hash(it->hash_value), target) << k;
+        #elif defined(GP_HASHMAP_NEON)
+            const uint64x2_t target = vld1q_u64(&hash_val[0]);
+            for (size_t k = 0; k < count; ++k, ++it)
+            {
+                const uint64x2_t equal = vceqq_u64(vld1q_u64(&it->hash_value[0]), target);
+                mask |= static_cast<uint32_t>(vgetq_lane_u64(equal, 0) & vgetq_lane_u64(equal, 1) & 1) << k;
+            }
+        #else
+            for (size_t k = 0; k < count; ++k, ++it)
+                mask |= static_cast<uint32_t>(it->hash_value == hash_val) << k;
+        #endif
+            return mask;
+        }
+    }
+
+    /// @brief Default 128-bit hash function used by hash_map_128_t
+    /// @note  Integers are multiply-folded, strings and string views are hashed over their bytes,
+    /// @note  other types go through std::hash and are then mixed to fill both 64-bit words
     template <typename Key>
     struct hash
     {
         hash128_t operator()(const Key &key) const
         {
-            // Custom hash function implementation
+            return hash_detail::hash_value(key, hash_detail::rank<3>());
+        }
+    };
+
+    /// @brief hash_t keys are hashed over their words, whichever way they were built
+    template <size_t Size>
+    struct hash<hash_t<Size>>
+    {
+        hash128_t operator()(const hash_t<Size> &key) const
+        {
+            return hash_detail::hash_bytes(key.words(), Size / 8);
+        }
+    };
+
+    /// @brief HashFunc for hash_t keys built by hash_t::mix or hash_encoder, the key is its own hash
+    /// @note  Their words are already mixed, the first 128 bits are used as they are and nothing is computed,
+    /// @note  keys narrower than 128 bits and keys packed field by field are better served by gp_std::hash
+    struct passthrough_hash
+    {
+        template <size_t Size>
+        hash128_t operator()(const hash_t<Size> &key) const
+        {
+            static_assert(Size >= 128, "passthrough_hash : needs at least 128 bits of key, use gp_std::hash<hash_t<Size>>");
             hash128_t hash_val;
-            hash_val.encode_hash(std::hash<Key>{}(key) + 1, std::hash<Key>{}(key), std::hash<Key>{}(key) + 1, std::hash<Key>{}(key));
+            std::memcpy(&hash_val[0], key.words(), sizeof(uint64_t));
+            std::memcpy(&hash_val[1], key.words() + 2, sizeof(uint64_t));
             return hash_val;
         }
     };
 
+    /// @brief How hash_map_128_t reads and writes one domain
+    /// @note  Sequence containers (std::deque, std::vector ...) append and are scanned linearly on the hash,
+    /// @note  gp_std::flat_domain is probed through its fingerprint control bytes,
+    /// @note  gp_std::snapshot_domain is copy on write and read without locks (specializations below)
+    /// @note  Sequences keep removed pairs as dead slots (keeps_tombstones), reused by place() and dropped by compact()
+    template <typename Domain>
+    struct domain_traits
+    {
+        static constexpr size_t npos = size_t(-1);
+
+        // Long linear scans can be spread over a cpu_compute_device
+        static constexpr bool supports_device = true;
+
+        // Readers take the domain's push_back_lock, writers update values in place
+        static constexpr bool lock_free_reads = false;
+
+        // erase() leaves an invalidated pair behind, the map reuses and compacts those slots
+        static constexpr bool keeps_tombstones = true;
+
+        template <typename KeyEqual>
+        static size_t find(const Domain& domain, const hash128_t& hash_val, KeyEqual&& equal)
+        {
+            for (size_t i = 0; i < domain.size(); ++i)
+            {
+                if (domain[i].hash_value == hash_val && equal(domain[i]))
+                    return i;
+            }
+            return npos;
+        }
+
+        ///@brief find() that also reports the first removed pair it walked past in free_slot, npos if none
+        template <typename KeyEqual>
+        static size_t find_or_free(const Domain& domain, const hash128_t& hash_val, KeyEqual&& equal, size_t& free_slot)
+        {
+            free_slot = npos;
+            for (size_t i = 0; i < domain.size(); ++i)
+            {
+                const hash128_t& slot_hash = domain[i].hash_value;
+                if (slot_hash == hash_val && equal(domain[i]))
+                    return i;
+                if (free_slot == npos && !slot_hash.is_valid())
+                    free_slot = i;
+            }
+            return npos;
+        }
+
+        template <typename KeyEqual>
+        static const typename Domain::value_type* find_item(const Domain& domain, const hash128_t& hash_val, KeyEqual&& equal)
+        {
+            size_t slot = find(domain, hash_val, std::forward<KeyEqual>(equal));
+            return (slot != npos) ? &domain[slot] : nullptr;
+        }
+
+        template <typename V>
+        static void assign(Domain& domain, const size_t& slot, V&& value) { domain[slot].value = std::forward<V>(value); }
+
+        // Pairs are moved out one by one, the husks go with the old table
+        static void migrate(Domain& from, const size_t& slot, Domain& to) { append(to, std::move(from[slot])); }
+        static void finish_migration(Domain&) {}
+
+        template <typename Pair>
+        static size_t append(Domain& domain, Pair&& pair)
+        {
+            domain.push_back(std::forward<Pair>(pair));
+            return domain.size() - 1;
+        }
+
+        ///@brief Store pair in free_slot (from find_or_free), or append it if there is none
+        template <typename Pair>
+        static size_t place(Domain& domain, const size_t& free_slot, Pair&& pair)
+        {
+            if (free_slot == npos)
+                return append(domain, std::forward<Pair>(pair));
+
+            domain[free_slot] = std::forward<Pair>(pair);
+            return free_slot;
+        }
+
+        static void erase(Domain& domain, const size_t& slot) { domain[slot].invalidate(); }
+
+        ///@brief Slide the live pairs to the front in order and drop the removed ones behind them
+        static void compact(Domain& domain)
+        {
+            size_t kept = 0;
+            for (size_t slot = 0; slot < domain.size(); ++slot)
+            {
+                if (!domain[slot].is_valid())
+                    continue;
+                if (kept != slot)
+                    domain[kept] = std::move(domain[slot]);
+                ++kept;
+            }
+            domain.erase(domain.begin() + kept, domain.end());
+        }
+
+        static size_t slot_count(const Domain& domain) { return domain.size(); }
+
+        static bool is_live(const Domain& domain, const size_t& slot) { return domain[slot].is_valid(); }
+
+        // The scan starts at the front
+        static void prefetch(const Domain& domain, const hash128_t&)
+        {
+            if (!domain.empty())
+                hash_detail::prefetch(&domain[0]);
+        }
+    };
+
+    template <typename T>
+    struct domain_traits<flat_domain<T>>
+    {
+        static constexpr size_t npos = flat_domain<T>::npos;
+
+        // One probe touches a group or two, nothing to gain from a device
+        static constexpr bool supports_device = false;
+
+        static constexpr bool lock_free_reads = false;
+
+        // Deleted control bytes are reused by insert and dropped by the next rehash
+        static constexpr bool keeps_tombstones = false;
+
+        template <typename KeyEqual>
+        static size_t find(const flat_domain<T>& domain, const hash128_t& hash_val, KeyEqual&& equal)
+        {
+            return domain.find(hash_val, std::forward<KeyEqual>(equal));
+        }
+
+        template <typename KeyEqual>
+        static size_t find_or_free(const flat_domain<T>& domain, const hash128_t& hash_val, KeyEqual&& equal, size_t& free_slot)
+        {
+            free_slot = npos;
+            return domain.find(hash_val, std::forward<KeyEqual>(equal));
+        }
+
+        template <typename KeyEqual>
+        static const T* find_item(const flat_domain<T>& domain, const hash128_t& hash_val, KeyEqual&& equal)
+        {
+            size_t slot = domain.find(hash_val, std::forward<KeyEqual>(equal));
+            return (slot != npos) ? &domain[slot] : nullptr;
+        }
+
+        template <typename V>
+        static void assign(flat_domain<T>& domain, const size_t& slot, V&& value) { domain[slot].value = std::forward<V>(value); }
+
+        static void migrate(flat_domain<T>& from, const size_t& slot, flat_domain<T>& to) { append(to, std::move(from[slot])); }
+        static void finish_migration(flat_domain<T>&) {}
+
+        template <typename Pair>
+        static size_t append(flat_domain<T>& domain, Pair&& pair)
+        {
+            return domain.insert(std::forward<Pair>(pair));
+        }
+
+        template <typename Pair>
+        static size_t place(flat_domain<T>& domain, const size_t&, Pair&& pair) { return append(domain, std::forward<Pair>(pair)); }
+
+        static void erase(flat_domain<T>& domain, const size_t& slot) { domain.erase(slot); }
+
+        static void compact(flat_domain<T>&) {}
+
+        static size_t slot_count(const flat_domain<T>& domain) { return domain.slot_count(); }
+
+        static bool is_live(const flat_domain<T>& domain, const size_t& slot) { return domain.occupied(slot); }
+
+        static void prefetch(const flat_domain<T>& domain, const hash128_t& hash_val) { domain.prefetch(hash_val); }
+    };
+
+    template <typename T>
+    struct domain_traits<snapshot_domain<T>>
+    {
+        static constexpr size_t npos = snapshot_domain<T>::npos;
+
+        // Blocks are short, a device would cost more than the scan
+        static constexpr bool supports_device = false;
+
+        // Readers scan a published block under an epoch pin, an update publishes a new node
+        static constexpr bool lock_free_reads = true;
+
+        // erase() publishes a block without the pair
+        static constexpr bool keeps_tombstones = false;
+
+        template <typename KeyEqual>
+        static size_t find(const snapshot_domain<T>& domain, const hash128_t& hash_val, KeyEqual&& equal)
+        {
+            return domain.find(hash_val, std::forward<KeyEqual>(equal));
+        }
+
+        template <typename KeyEqual>
+        static size_t find_or_free(const snapshot_domain<T>& domain, const hash128_t& hash_val, KeyEqual&& equal, size_t& free_slot)
+        {
+            free_slot = npos;
+            return domain.find(hash_val, std::forward<KeyEqual>(equal));
+        }
+
+        template <typename KeyEqual>
+        static const T* find_item(const snapshot_domain<T>& domain, const hash128_t& hash_val, KeyEqual&& equal)
+        {
+            return domain.find_item(hash_val, std::forward<KeyEqual>(equal));
+        }
+
+        template <typename Pair>
+        static size_t append(snapshot_domain<T>& domain, Pair&& pair)
+        {
+            return domain.insert(std::forward<Pair>(pair));
+        }
+
+        template <typename Pair>
+        static size_t place(snapshot_domain<T>& domain, const size_t&, Pair&& pair) { return append(domain, std::forward<Pair>(pair)); }
+
+        static void compact(snapshot_domain<T>&) {}
+
+        // Readers may hold the old node, the new value goes into a copy
+        template <typename V>
+        static void assign(snapshot_domain<T>& domain, const size_t& slot, V&& value)
+        {
+            T fresh(domain[slot]);
+            fresh.value = std::forward<V>(value);
+            domain.replace(slot, std::move(fresh));
+        }
+
+        static void erase(snapshot_domain<T>& domain, const size_t& slot) { domain.erase(slot); }
+
+        static size_t slot_count(const snapshot_domain<T>& domain) { return domain.slot_count(); }
+
+        static bool is_live(const snapshot_domain<T>&, const size_t&) { return true; }
+
+        static void prefetch(const snapshot_domain<T>& domain, const hash128_t&) { domain.prefetch(); }
+
+        // Nodes change hands without being copied, the old domain lets go of all of them at the end
+        static void migrate(snapshot_domain<T>& from, const size_t& slot, snapshot_domain<T>& to) { to.adopt(from.item(slot)); }
+        static void finish_migration(snapshot_domain<T>& from) { from.disown(); }
+    };
+
     /// @class  hash_map_128_t
     /// @brief  Custom hash map class with 128-bit hash tables
     /// @tparam Key The key type
     /// @tparam Value The value type
     /// @tparam max_domains The maximum number of domains
     /// @tparam HashFunc The hash function
-    /// @tparam base_container The base container type
+    /// @tparam base_container The base container type of a domain, a sequence (std::deque), gp_std::flat_domain (open addressing)
+    /// @tparam                or gp_std::snapshot_domain (copy on write, lock free readers)
     /// @note   Custom implementation of a concurrent hash map with 128-bit hash tables
     /// @note   Provides support for  
     /// @note   single threaded insert, atomic_insert, concurrent_search, get, remove, and contains operations
     /// @note   Provides custom iterator support
+    /// @note   Grows on its own past max_load_factor() pairs per domain, old domains migrate a few per insert
+    /// @note   so no single call pays for the whole table ; references to pairs are valid until their domain migrates
+    /// @note   Every operation pins gp_std::epoch_manager, retired tables (and snapshot nodes) outlive the operations using them
+    /// @note   With gp_std::snapshot_domain load(), visit() and contains() never block, see load()
 
     template <typename Key, typename Value, typename HashFunc = gp_std::hash<Key> , template <typename...> class base_container = std::deque>
     class hash_map_128_t
@@ -323,13 +804,14 @@ namespace gp_std
 
             pair(const Key_T& key, const Value_T &value, const hash128_t &hash_value) : key(key), value(value), hash_value(hash_value) {}
             pair(Key_T&& key, Value_T&& value, const hash128_t& hash_value) : key(std::move(key)), value(std::move(value)), hash_value(hash_value) {}
-           ~pair() {}
+            // The union members have to be constructed and destroyed explicitly
+            pair(const pair &p) : key(p.key), value(p.value), hash_value(p.hash_value) {}
+            pair(pair &&p) : key(std::move(p.key)), value(std::move(p.value)), hash_value(p.hash_value) {}
 
-            pair(const pair &p)
+           ~pair()
             {
-                key = p.key;
-                value = p.value;
-                hash_value = p.hash_value;
+                key.~Key_T();
+                value.~Value_T();
             }
 
             pair &operator=(const pair &p)
@@ -353,7 +835,7 @@ namespace gp_std
                 hash_value.invalidate();
             }
 
-            bool is_valid()
+            bool is_valid() const
             {
                 return hash_value.is_valid();
             }
@@ -362,161 +844,228 @@ namespace gp_std
     
     private:
         HashFunc hash_fun;
-        
-        size_t max_domains;
 
-        std::vector<base_container<pair<Key, Value>>> hash_table; 
-        
+        using domain_type = base_container<pair<Key, Value>>;
+        using domain_ops  = domain_traits<domain_type>;
+
         class domain_lock
         {
             public :
-            domain_lock() : value_modifier_lock(), push_back_lock() {}
+            domain_lock() : value_modifier_lock(gp_std::stats::lock_site::hash_map_value_modifier),
+                            push_back_lock(gp_std::stats::lock_site::hash_map_push_back), dead_slots(0) {}
             gp_std::spinlock value_modifier_lock;
             gp_std::spinlock push_back_lock;
+
+            // Removed pairs still taking a slot of the domain (sequences only), written under push_back_lock
+            std::atomic<size_t> dead_slots;
+        };
+
+        /// @brief One generation of domains
+        /// @note  The map grows by migrating domains from the previous table into the current one,
+        /// @note  domain_count is always a power of two so the domain index is a mask of the hash
+        /// @note  Domains are constructed on their first write and destroyed in steps (destroy_domains),
+        /// @note  a std::deque allocates even when empty and a million of them is a pause of its own
+        struct table
+        {
+            explicit table(const size_t& in_domain_count) : storage(new domain_storage[in_domain_count]), state(new std::atomic<uint8_t>[in_domain_count]()),
+                locks(in_domain_count), mask(in_domain_count - 1), domain_count(in_domain_count), destroy_cursor(0) {}
+
+           ~table() { destroy_domains(domain_count); }
+
+            table(const table&) = delete;
+            table& operator=(const table&) = delete;
+
+            size_t count() const { return domain_count; }
+
+            size_t index(const hash128_t& hash_val) const
+            {
+                // Both words are fully mixed so the low bits of their xor are as good as any
+                return static_cast<size_t>(hash_val[0] ^ hash_val[1]) & mask;
+            }
+
+            bool is_constructed(const size_t& i) const { return (state[i].load(std::memory_order_acquire) & constructed_bit) != 0; }
+            bool is_migrated(const size_t& i) const { return (state[i].load(std::memory_order_acquire) & migrated_bit) != 0; }
+            void mark_migrated(const size_t& i) { state[i].fetch_or(migrated_bit, std::memory_order_release); }
+
+            ///@brief The domain, or an empty one if nothing was ever written to it
+            const domain_type& view(const size_t& i) const { return is_constructed(i) ? *address(i) : empty_domain(); }
+
+            ///@brief A domain known to be constructed
+            domain_type& domain(const size_t& i) const { return *address(i); }
+
+            ///@brief The domain, constructing it if needed ; caller holds locks[i].push_back_lock
+            domain_type& writable(const size_t& i)
+            {
+                if (!is_constructed(i))
+                {
+                    new (storage[i].bytes) domain_type();
+                    state[i].fetch_or(constructed_bit, std::memory_order_release);
+                }
+                return *address(i);
+            }
+
+            ///@brief Destroy the next budget domains, true once all of them are gone
+            bool destroy_domains(const size_t& budget)
+            {
+                for (size_t n = 0; n < budget && destroy_cursor < domain_count; ++n, ++destroy_cursor)
+                {
+                    if (is_constructed(destroy_cursor))
+                    {
+                        address(destroy_cursor)->~domain_type();
+                        state[destroy_cursor].fetch_and(static_cast<uint8_t>(~constructed_bit), std::memory_order_relaxed);
+                    }
+                }
+                return destroy_cursor == domain_count;
+            }
+
+            static constexpr uint8_t constructed_bit = 1;
+            static constexpr uint8_t migrated_bit    = 2;   // set once a domain has moved to the next table
+
+            struct domain_storage
+            {
+                alignas(domain_type) unsigned char bytes[sizeof(domain_type)];
+            };
+
+            domain_type* address(const size_t& i) const { return std::launder(reinterpret_cast<domain_type*>(storage[i].bytes)); }
+
+            static const domain_type& empty_domain()
+            {
+                static const domain_type empty;
+                return empty;
+            }
+
+            std::unique_ptr<domain_storage[]> storage;
+            std::unique_ptr<std::atomic<uint8_t>[]> state;
+            std::deque<domain_lock> locks;
+            size_t mask;
+            size_t domain_count;
+            size_t destroy_cursor;
+        };
+
+        // Every table still reachable, guarded by resize_lock ; back() is current_table
+        std::deque<std::unique_ptr<table>> generations;
+        std::atomic<bool> retired_pending;
+
+        // A table nobody points to any more, and the epoch it was unlinked in
+        struct retired_table
+        {
+            std::unique_ptr<table> generation;
+            uint64_t epoch;
         };
 
-        std::deque<domain_lock> domain_locks;
+        // Unreachable tables, destroyed a few domains per insert once their epoch is safe ; guarded by resize_lock
+        std::deque<retired_table> graveyard;
+        std::atomic<bool> graveyard_pending;
+        std::atomic<bool> reclaim_busy;
+
+        std::atomic<table*> current_table;
+        std::atomic<table*> previous_table;     // nullptr unless a migration is in progress
+
+        std::atomic<size_t> migrate_cursor;
+        std::atomic<size_t> migrated_domains;
+        std::atomic<size_t> live_count;
+
+        double max_load;
+        size_t migration_step;
+        double min_live;
 
-        gp_std::spinlock resize_lock;
+        mutable gp_std::spinlock resize_lock{ gp_std::stats::lock_site::hash_map_resize };
+
+        /// @brief Pins the global epoch for the lifetime of an operation, see reclaim_locked()
+        class operation_guard
+        {
+            public:
+            explicit operation_guard(const hash_map_128_t&) : m_pin(gp_std::epoch_manager::global().pin()) {}
+
+            private:
+            gp_std::epoch_manager::guard m_pin;
+        };
 
         gp_std::cpu_compute_device* external_device;
 
+        // Average pairs per domain before the domain count is doubled
+        static constexpr double default_max_load = 16.0;
+
+        // Old domains migrated by every insert while growing
+        static constexpr size_t default_migration_step = 1;
+
+        // Live pairs per slot under which remove() compacts a sequence domain
+        static constexpr double default_min_live_ratio = 0.5;
+
+        // Dead slots a domain holds at least before it is worth compacting
+        static constexpr size_t min_compaction = 4;
+
+        // Dead domains destroyed by every insert while the graveyard is not empty
+        static constexpr size_t reclaim_step = 8;
+
+        // Keys the batch operations hash, prefetch and lock together
+        static constexpr size_t batch_width = 32;
+
     public:
         // Constructor
-        hash_map_128_t(const uint32_t& bucket_count = 64) : hash_fun(), max_domains(bucket_count), hash_table(bucket_count), domain_locks(bucket_count), external_device(nullptr) { } 
+        /// @note bucket_count is rounded up to the next power of two, see buckets_count()
+        hash_map_128_t(const uint32_t& bucket_count = 64) : hash_fun(), generations(), retired_pending(false), graveyard(), graveyard_pending(false), reclaim_busy(false), current_table(nullptr), previous_table(nullptr), migrate_cursor(0), migrated_domains(0),
+            live_count(0), max_load(default_max_load), migration_step(default_migration_step), min_live(default_min_live_ratio), external_device(nullptr)
+        {
+            reset_tables(round_domain_count(bucket_count));
+        }
 
         // Destructor
         ~hash_map_128_t() {  }
 
         hash_map_128_t& operator=(const hash_map_128_t& other)
         {
-            gp_std::scoped_lock<gp_std::spinlock> lock(other.resize_lock);
             if(this == &other) return *this;
-            hash_table = other.hash_table;
+            gp_std::scoped_lock<gp_std::spinlock> lock(other.resize_lock);
+            copy_from(other);
             return *this;
-        }  
-        
+        }
+
         hash_map_128_t& operator=(hash_map_128_t&& other)
         {
-            gp_std::scoped_lock<gp_std::spinlock> lock(other.resize_lock);    
             if(this == &other) return *this;
-            max_domains = other.max_domains;
-            hash_table = std::move(other.hash_table);
-            domain_locks = std::move(other.domain_locks);
-            other.max_domains = 0;
-            other.hash_table.clear();
-            other.domain_locks.clear();
+            gp_std::scoped_lock<gp_std::spinlock> lock(other.resize_lock);
+            move_from(other);
             return *this;
         }
 
-        hash_map_128_t(const hash_map_128_t& other)
+        hash_map_128_t(const hash_map_128_t& other) : hash_fun(other.hash_fun), generations(), retired_pending(false), graveyard(), graveyard_pending(false), reclaim_busy(false), current_table(nullptr), previous_table(nullptr), migrate_cursor(0), migrated_domains(0),
+            live_count(0), max_load(other.max_load), migration_step(other.migration_step), min_live(other.min_live), external_device(nullptr)
         {
             gp_std::scoped_lock<gp_std::spinlock> lock(other.resize_lock);
-            hash_table = other.hash_table;
+            copy_from(other);
         }
 
-        hash_map_128_t(hash_map_128_t&& other)
+        hash_map_128_t(hash_map_128_t&& other) : hash_fun(std::move(other.hash_fun)), generations(), retired_pending(false), graveyard(), graveyard_pending(false), reclaim_busy(false), current_table(nullptr), previous_table(nullptr), migrate_cursor(0), migrated_domains(0),
+            live_count(0), max_load(other.max_load), migration_step(other.migration_step), min_live(other.min_live), external_device(nullptr)
         {
             gp_std::scoped_lock<gp_std::spinlock> lock(other.resize_lock);
-            hash_table = std::move(other.hash_table);
+            move_from(other);
         }
-  
+
         ///@brief Move key-value pair to the hashmap
         const pair<Key,Value>& insert(Key&& key, Value&& value)
         {
-            /// Search if the key already exists
-            hash128_t hash_val  = hash_fun(key);
-            size_t domain_index = eval_domain_index(hash_val);
-            gp_std::optional<size_t> key_index = search_concurrent(key, hash_val, domain_index);
-
-            if(key_index)
-            {
-                hash_table[domain_index][key_index.value()].value = value;
-                return hash_table[domain_index][key_index.value()];
-            };
-
-            /// else create a new pair in the domain
-            hash_table[domain_index].push_back(std::move(pair<Key, Value>(std::move(key), std::move(value), hash_val)));
-            return hash_table[domain_index].back();
-        }     
+            return insert_or_assign(std::move(key), std::move(value));
+        }
 
         ///@brief Copy key-value pair to the hashmap
-        const pair<Key,Value>& insert(const Key &key, const Value &value) 
+        const pair<Key,Value>& insert(const Key &key, const Value &value)
         {
-            /// Search if the key already exists
-            hash128_t hash_val = hash_fun(key);
-            size_t domain_index = eval_domain_index(hash_val);
-            gp_std::optional<size_t> key_index = search_concurrent(key, hash_val, domain_index);
-        
-            if(key_index)
-            {
-                hash_table[domain_index][key_index.value()].value = value;
-                return hash_table[domain_index][key_index.value()];
-            }
-            
-            /// else create a new pair in the domain
-            hash_table[domain_index].push_back(std::move(pair<Key, Value>(key, value, hash_val)));
-            return hash_table[domain_index].back();
+            return insert_or_assign(key, value);
         }
 
         ///@brief Atomically Move key-value pair to the hashmap
+        /// @note  insert and atomic_insert share the locked path, the table may grow under any insert
         const pair<Key,Value>& atomic_insert(Key &&key, Value &&value) noexcept
         {
-            /// Search if the key already exists
-            hash128_t hash_val = hash_fun(key);
-            size_t domain_index = eval_domain_index(hash_val);
-            gp_std::optional<size_t> key_index = search_concurrent(key, hash_val, domain_index);
-
-            if(key_index)
-            {
-                gp_std::scoped_lock<gp_std::spinlock> lock(domain_locks[domain_index].value_modifier_lock);
-                
-                try
-                { hash_table[domain_index][key_index.value()].value = value; }
-                catch(...) { }
-                
-                return hash_table[domain_index][key_index.value()];
-            };
-
-            /// else create a new pair in the domain
-
-            gp_std::scoped_lock<gp_std::spinlock> lock(domain_locks[domain_index].push_back_lock);
-            
-            try
-            { hash_table[domain_index].push_back(std::move(pair<Key, Value>(std::move(key), std::move(value), hash_val))); }
-            catch(...) { }
-
-            return hash_table[domain_index].back();
-
-        }     
+            return insert_or_assign(std::move(key), std::move(value));
+        }
 
         ///@brief Atomically Copy key-value pair to the hashmap
         const pair<Key,Value>& atomic_insert(const Key &key, const Value &value) noexcept
         {
-            /// Search if the key already exists
-            hash128_t hash_val = hash_fun(key);
-            size_t domain_index = eval_domain_index(hash_val);
-            gp_std::optional<size_t> key_index = search_concurrent(key, hash_val, domain_index);
-        
-            if(key_index)
-            {
-                gp_std::scoped_lock<gp_std::spinlock> lock(domain_locks[domain_index].value_modifier_lock);
-                
-                try
-                { hash_table[domain_index][key_index.value()].value = value; }
-                catch(...) { }
-                
-                return hash_table[domain_index][key_index.value()];
-            };
-
-            /// else create a new pair in the domain
-            gp_std::scoped_lock<gp_std::spinlock> lock(domain_locks[domain_index].push_back_lock);
-
-            try
-            { hash_table[domain_index].push_back(std::move(pair<Key, Value>(key, value, hash_val))); }
-            catch(...) { }  
-
-            return hash_table[domain_index].back();          
+            return insert_or_assign(key, value);
         }
 
         const pair<Key,Value>& insert(std::pair<Key, Value>&& pair)
@@ -567,62 +1116,106 @@ namespace gp_std
         /// @brief Retrieve value associated with key
         /// @param key Key to search for
         /// @return Optional Value associated with key
+        /// @note  While growing the key is looked up in the old domain first, then in the new one
+        /// @note  With gp_std::snapshot_domain the reference is valid until the key is next inserted or removed,
+        /// @note  readers racing writers should use load() or visit()
         gp_std::optional<Value&> get(const Key &key) const noexcept
         {
-            hash128_t hash_val = hash_fun(key);
-            size_t domain_index = eval_domain_index(hash_val);
-
-            gp_std::optional<size_t> key_index = search_concurrent(key);
-            if (key_index)
+            operation_guard guard(*this);
+            location found;
+            if (locate(key, hash_fun(key), found))
             {
-                return hash_table[eval_domain_index(hash_fun(key))][key_index.value()].value;
+                // Lookups hand out the pair as const, the map itself gives write access to the value
+                return const_cast<pair<Key, Value>*>(found.item)->value;
             }
             return gp_std::nullopt_t();
         }
 
+        /// @brief Copy of the value associated with key
+        /// @note  With gp_std::snapshot_domain no lock is taken, the copy is of the value before or after
+        /// @note  a concurrent insert, never of a mix ; other domain types copy under the domain's push_back_lock
+        gp_std::optional<Value> load(const Key &key) const
+        {
+            gp_std::optional<Value> result;
+            visit(key, [&result](const Value& value) { result = value; });
+            return result;
+        }
+
+        /// @brief Call visitor(const Value&) on the value associated with key, false if there is none
+        /// @note  The value stays alive for the call, visitor must not insert into or remove from this map
+        template <typename Visitor>
+        bool visit(const Key &key, Visitor&& visitor) const
+        {
+            operation_guard guard(*this);
+            return visit_hashed(key, hash_fun(key), std::forward<Visitor>(visitor));
+        }
+
         /// @brief Atomically Retrieve value associated with key
         /// @param key Key to search for
         /// @return Optional Value associated with key
         gp_std::optional<Value&> atomic_get(const Key &key) noexcept
         {
-            hash128_t hash_val = hash_fun(key);
-            size_t domain_index = eval_domain_index(hash_val);
-
-            gp_std::optional<size_t> key_index = search_concurrent(key, hash_val, domain_index);
-            if (key_index)
+            operation_guard guard(*this);
+            location found;
+            if (locate(key, hash_fun(key), found))
             {
-                gp_std::scoped_lock<gp_std::spinlock> lock(domain_locks[domain_index].value_modifier_lock);
-                Value& value = hash_table[eval_domain_index(hash_fun(key))][key_index.value()].value;
+                gp_std::scoped_lock<gp_std::spinlock> lock(found.owner->locks[found.domain_index].value_modifier_lock);
+                Value& value = const_cast<pair<Key, Value>*>(found.item)->value;
                 return value;
             }
             return gp_std::nullopt_t();
         }
-      
+
         ///@brief Remove key-value pair from the hashmap
+        /// @note  In sequence domains the pair is marked dead, its slot is reused by a later insert into the domain
+        /// @note  and the domain is compacted once less than min_live_ratio() of its slots hold live pairs ;
+        /// @note  compaction moves pairs, references into that domain are invalidated as by a migration
         void remove(const Key &key) noexcept
         {
             hash128_t hash_val = hash_fun(key);
-            size_t domain_index = eval_domain_index(hash_val);
 
-            gp_std::optional<size_t> key_index = search_concurrent(key, hash_val, domain_index);
-
-            if (key_index)
             {
-                hash_table[domain_index][key_index.value()].invalidate();
+                operation_guard guard(*this);
+                for (;;)
+                {
+                    table& target = writable_table(hash_val);
+                    const size_t domain_index = target.index(hash_val);
+                    domain_lock& lock = target.locks[domain_index];
+
+                    gp_std::scoped_lock<gp_std::spinlock> push_back(lock.push_back_lock);
+                    if (target.is_migrated(domain_index))
+                        continue; // The table was retired under us, retry on the new one
+
+                    size_t slot = domain_ops::find(target.view(domain_index), hash_val, [&key](const pair<Key, Value>& p) { return p.key == key; });
+                    if (slot != domain_ops::npos)
+                    {
+                        gp_std::scoped_lock<gp_std::spinlock> modify(lock.value_modifier_lock);
+                        domain_ops::erase(target.domain(domain_index), slot);
+                        live_count.fetch_sub(1, std::memory_order_relaxed);
+                        if (domain_ops::keeps_tombstones)
+                            add_dead_slot(lock, target.domain(domain_index));
+                    }
+                    break;
+                }
             }
+            try_reclaim();
         }
 
+        ///@brief Start migrating to new_domain_count domains (rounded up to a power of two)
+        /// @note  Returns immediately, the domains move a few at a time on later inserts, see migrate()
         void resize(const size_t &new_domain_count)
         {
-            rehash(new_domain_count);
+            gp_std::scoped_lock<gp_std::spinlock> lock(resize_lock);
+            begin_migration(round_domain_count(new_domain_count));
         }
 
         void clear()
         {
-            hash_table.clear();
+            gp_std::scoped_lock<gp_std::spinlock> lock(resize_lock);
+            reset_tables(current_table.load(std::memory_order_relaxed)->count());
         }
 
-        uint32_t size() const 
+        uint32_t size() const
         {
             return get_total_size();
         }
@@ -632,6 +1225,7 @@ namespace gp_std
             return get_domain_size(domain_index);
         }
 
+        ///@brief Number of domains, the requested count rounded up to a power of two
         uint32_t buckets_count() const
         {
             return get_domain_count();
@@ -640,78 +1234,325 @@ namespace gp_std
         ///@brief Check if key exists in the hashmap
         bool contains(const Key &key) const noexcept
         {
-            gp_std::optional<size_t> key_index = search_concurrent(key);
-            return key_index.has_value();
+            operation_guard guard(*this);
+            location found;
+            return locate(key, hash_fun(key), found);
+        }
+
+        ///@brief Insert or assign keys[i] -> values[i] for the count pairs
+        /// @note  Keys are hashed batch_width at a time and grouped by domain, every domain of a group is locked once
+        /// @note  and the memory the keys land in is prefetched for the whole group before the first one is written
+        void insert_batch(const Key* keys, const Value* values, const size_t& count)
+        {
+            hash128_t hashes[batch_width];
+            batch_entry order[batch_width];
+            bool deferred[batch_width];
+
+            for (size_t base = 0; base < count; base += batch_width)
+            {
+                const size_t n = std::min(batch_width, count - base);
+                bool grow = false, any_deferred = false;
+                {
+                    operation_guard guard(*this);
+                    table* current = current_table.load();
+                    prepare_batch(*current, keys + base, n, hashes, order);
+
+                    // Old domains are moved first so nothing migrates while the group is locked
+                    bool direct = true;
+                    if (previous_table.load() != nullptr)
+                    {
+                        for (size_t j = 0; j < n && direct; ++j)
+                            direct = (&writable_table(hashes[j]) == current);
+                    }
+
+                    if (direct)
+                    {
+                        lock_batch(*current, order, n);
+                        for (size_t j = 0; j < n; ++j)
+                        {
+                            if (current->is_constructed(order[j].domain_index))
+                                domain_ops::prefetch(current->domain(order[j].domain_index), hashes[order[j].position]);
+                        }
+
+                        size_t appended = 0;
+                        for (size_t j = 0; j < n; ++j)
+                        {
+                            const size_t position = order[j].position;
+                            const size_t domain_index = order[j].domain_index;
+                            const Key& key = keys[base + position];
+                            deferred[position] = current->is_migrated(domain_index);
+                            if (deferred[position])
+                            {
+                                any_deferred = true;
+                                continue;
+                            }
+
+                            domain_type& domain = current->writable(domain_index);
+                            domain_lock& lock = current->locks[domain_index];
+                            size_t free_slot;
+                            size_t slot = find_for_insert(lock, domain, hashes[position], key, free_slot);
+                            if (slot != domain_ops::npos)
+                            {
+                                gp_std::scoped_lock<gp_std::spinlock> modify(lock.value_modifier_lock);
+                                domain_ops::assign(domain, slot, values[base + position]);
+                            }
+                            else
+                            {
+                                place(lock, domain, free_slot, pair<Key, Value>(key, values[base + position], hashes[position]));
+                                ++appended;
+                            }
+                        }
+                        unlock_batch(*current, order, n);
+
+                        const size_t live = live_count.fetch_add(appended, std::memory_order_relaxed) + appended;
+                        grow = max_load > 0 && static_cast<double>(live) > max_load * static_cast<double>(current->count());
+                    }
+                    else
+                    {
+                        std::fill(deferred, deferred + n, true);
+                        any_deferred = true;
+                    }
+                }
+
+                // The table moved on under us, these keys take the one at a time path
+                if (any_deferred)
+                {
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        if (deferred[j])
+                            insert_or_assign(keys[base + j], values[base + j]);
+                    }
+                }
+
+                if (grow)
+                    grow_if_needed();
+                try_reclaim();
+            }
+        }
+
+        void insert_batch(const std::vector<Key>& keys, const std::vector<Value>& values)
+        {
+            insert_batch(keys.data(), values.data(), std::min(keys.size(), values.size()));
+        }
+
+        ///@brief Copy the value of keys[i] into results[i], nullopt if absent
+        /// @return The number of keys found
+        /// @note   Hashes, domain headers and probe memory of batch_width keys are prefetched before any is resolved
+        size_t find_batch(const Key* keys, const size_t& count, gp_std::optional<Value>* results) const
+        {
+            size_t found = 0;
+            resolve_batch(keys, count, [&](const size_t& i, const Value* value)
+            {
+                if (value != nullptr)
+                {
+                    results[i] = *value;
+                    ++found;
+                }
+                else
+                    results[i] = gp_std::nullopt_t();
+            });
+            return found;
+        }
+
+        std::vector<gp_std::optional<Value>> find_batch(const std::vector<Key>& keys) const
+        {
+            std::vector<gp_std::optional<Value>> results(keys.size());
+            find_batch(keys.data(), keys.size(), results.data());
+            return results;
+        }
+
+        ///@brief results[i] tells whether keys[i] is in the map
+        /// @return The number of keys found
+        size_t contains_batch(const Key* keys, const size_t& count, bool* results) const
+        {
+            size_t found = 0;
+            resolve_batch(keys, count, [&](const size_t& i, const Value* value)
+            {
+                results[i] = (value != nullptr);
+                found += results[i] ? 1 : 0;
+            });
+            return found;
+        }
+
+        std::vector<bool> contains_batch(const std::vector<Key>& keys) const
+        {
+            std::vector<bool> results(keys.size());
+            resolve_batch(keys.data(), keys.size(), [&results](const size_t& i, const Value* value) { results[i] = (value != nullptr); });
+            return results;
         }
 
         ///@brief Get the size of the hashmap for a specific domain
         size_t get_domain_size(const size_t &domain_index) const noexcept
         {
-            if (domain_index >= max_domains)
+            operation_guard guard(*this);
+            const table* current = current_table.load(std::memory_order_acquire);
+            if (domain_index >= current->count())
             {
                 return 0;
             }
-            return hash_table[domain_index].size();
+            // Size first : a compaction in between can only make us count its dead slots, never go below zero
+            const size_t slots = current->view(domain_index).size();
+            const size_t dead  = current->locks[domain_index].dead_slots.load(std::memory_order_relaxed);
+            return (slots > dead) ? slots - dead : 0;
         }
 
         ///@brief Get the size of the hashmap for a specific domain
         size_t get_domain_count() const noexcept
         {
-            return max_domains;
+            operation_guard guard(*this);
+            return current_table.load(std::memory_order_acquire)->count();
         }
 
-        ///@brief Get the total size of the hashmap across all max_domains
+        ///@brief Number of live pairs across all domains, including domains not migrated yet
         size_t get_total_size() const noexcept
         {
-            size_t total_size = 0;
-            for(size_t i = 0; i < max_domains; ++i)
+            return live_count.load(std::memory_order_relaxed);
+        }
+
+        ///@brief Grow once the average number of pairs per domain exceeds load, 0 disables automatic growth
+        void set_max_load_factor(const double& load) noexcept
+        {
+            max_load = load;
+        }
+
+        double max_load_factor() const noexcept
+        {
+            return max_load;
+        }
+
+        ///@brief Compact a sequence domain once fewer than ratio of its slots hold live pairs, 0 never compacts
+        void set_min_live_ratio(const double& ratio) noexcept
+        {
+            min_live = ratio;
+        }
+
+        double min_live_ratio() const noexcept
+        {
+            return min_live;
+        }
+
+        ///@brief Compact every domain of the current table holding removed pairs, e.g. from a background thread
+        /// @return The number of slots given back
+        size_t compact()
+        {
+            size_t reclaimed = 0;
+            if (!domain_ops::keeps_tombstones)
+                return reclaimed;
+
+            operation_guard guard(*this);
+            table* current = current_table.load();
+            for (size_t i = 0; i < current->count(); ++i)
+            {
+                domain_lock& lock = current->locks[i];
+                if (lock.dead_slots.load(std::memory_order_relaxed) == 0)
+                    continue;
+
+                gp_std::scoped_lock<gp_std::spinlock> push_back(lock.push_back_lock);
+                gp_std::scoped_lock<gp_std::spinlock> modify(lock.value_modifier_lock);
+                if (current->is_migrated(i) || !current->is_constructed(i))
+                    continue;
+
+                const size_t dead = lock.dead_slots.load(std::memory_order_relaxed);
+                gp_std::stats::record_compaction(dead);
+                reclaimed += dead;
+                domain_ops::compact(current->domain(i));
+                lock.dead_slots.store(0, std::memory_order_relaxed);
+            }
+            return reclaimed;
+        }
+
+        ///@brief Number of old domains each insert migrates while the map is growing
+        void set_migration_step(const size_t& step) noexcept
+        {
+            migration_step = step;
+        }
+
+        ///@brief True while pairs are still being moved to the new table
+        bool is_migrating() const noexcept
+        {
+            return previous_table.load(std::memory_order_acquire) != nullptr;
+        }
+
+        ///@brief Migrate up to domain_count old domains, e.g. from a background thread
+        /// @return true if the migration still has work left
+        bool migrate(const size_t& domain_count = 1)
+        {
+            {
+                operation_guard guard(*this);
+                table* previous = previous_table.load();
+                if (previous != nullptr)
+                    advance_migration(*previous, domain_count);
+            }
+            try_reclaim();
+            return is_migrating();
+        }
+
+        ///@brief Migrate every remaining old domain
+        void complete_migration()
+        {
             {
-                total_size += hash_table[i].size();
+                operation_guard guard(*this);
+                table* previous = previous_table.load();
+                if (previous != nullptr)
+                    sweep_migration(*previous);
             }
-            return total_size;
+            try_reclaim();
         }
 
         /// @brief hash_map_128_t::iterator class
+        /// @note  Walks a single table, begin() completes a pending migration first
         class iterator
         {
         public:
-            iterator(hash_map_128_t<Key, Value, HashFunc, base_container>* hashmap) : m_hashmap(hashmap), m_domain_index(0), m_pair_index(0)
+            iterator(hash_map_128_t<Key, Value, HashFunc, base_container>* hashmap) : m_hashmap(hashmap), m_table(hashmap->current_table.load(std::memory_order_acquire)), m_domain_index(0), m_pair_index(0), m_last_valid_pair(nullptr)
             {
-                for(size_t i = 0; i < m_hashmap->get_domain_count(); i++)
+                for(size_t i = 0; i < m_table->count(); i++)
                 {
-                    if(m_hashmap->hash_table[i].size() > 0)
+                    if(domain_ops::slot_count(m_table->view(i)) > 0)
                     {
                         m_domain_index = i;
                         m_pair_index = 0;
                         break;
                     }
                 }
+                skip_dead();
             }
 
-            iterator(hash_map_128_t<Key, Value, HashFunc, base_container>* hashmap, const size_t& domain_index, const size_t& pair_index) : m_hashmap(hashmap), m_domain_index(domain_index), m_pair_index(pair_index), m_last_valid_pair(nullptr) {}
+            iterator(hash_map_128_t<Key, Value, HashFunc, base_container>* hashmap, const size_t& domain_index, const size_t& pair_index) : m_hashmap(hashmap), m_table(hashmap->current_table.load(std::memory_order_acquire)), m_domain_index(domain_index), m_pair_index(pair_index), m_last_valid_pair(nullptr) {}
 
             void operator++() noexcept
             {
                 if(m_domain_index == 0xffffffff && m_pair_index == 0xffffffff) return;
                 forward();
+                skip_dead();
+            }
+
+            // Removed pairs and free slots are never visited, so begin() / ++ always land on a live pair or end()
+            void skip_dead() noexcept
+            {
+                while (!(m_domain_index == 0xffffffff && m_pair_index == 0xffffffff) &&
+                       !domain_ops::is_live(m_table->view(m_domain_index), m_pair_index))
+                {
+                    forward();
+                }
             }
 
             pair<Key, Value>& operator*() noexcept
             {
                 if(m_domain_index == 0xffffffff && m_pair_index == 0xffffffff)
                 {
-                    if(m_last_valid_pair) return *m_last_valid_pair; 
+                    if(m_last_valid_pair) return *m_last_valid_pair;
                     else throw std::out_of_range("Attempt to dereference end() iterator");
                 }
 
-                m_last_valid_pair = &m_hashmap->hash_table[m_domain_index][m_pair_index];
-                
-                while (!(m_last_valid_pair->is_valid()))
+                m_last_valid_pair = &m_table->domain(m_domain_index)[m_pair_index];
+
+                while (!domain_ops::is_live(m_table->view(m_domain_index), m_pair_index))
                 {
                     forward();
                     if (m_domain_index == 0xffffffff && m_pair_index == 0xffffffff)
                         break;
-                    m_last_valid_pair = &m_hashmap->hash_table[m_domain_index][m_pair_index];
+                    m_last_valid_pair = &m_table->domain(m_domain_index)[m_pair_index];
                 }
 
                 return *m_last_valid_pair;
@@ -737,7 +1578,7 @@ namespace gp_std
                 if(m_domain_index == 0xffffffff && m_pair_index == 0xffffffff)
                     return;
 
-                if(m_pair_index < m_hashmap->hash_table[m_domain_index].size() - 1)
+                if(m_pair_index + 1 < domain_ops::slot_count(m_table->view(m_domain_index)))
                 {
                     ++m_pair_index;
                 }
@@ -745,18 +1586,18 @@ namespace gp_std
                 else
                 {
                     size_t old_domain_index = m_domain_index;
-                    for (size_t i = m_domain_index + 1; i <  m_hashmap->get_domain_count(); ++i)
+                    for (size_t i = m_domain_index + 1; i <  m_table->count(); ++i)
                     {
                         // Find the next domain with a valid size
-                        if (m_hashmap->hash_table[i].size() > 0)
+                        if (domain_ops::slot_count(m_table->view(i)) > 0)
                         {
                             m_domain_index = i;
                             m_pair_index = 0;
                             break;
                         }
                     }
-                    
-                    // This means could not find a valid domain within the max_domains
+
+                    // This means could not find a valid domain within the table
                     if(old_domain_index == m_domain_index)
                     {
                         m_domain_index = 0xffffffff;
@@ -767,6 +1608,7 @@ namespace gp_std
 
         private:
             hash_map_128_t<Key, Value, HashFunc, base_container> *m_hashmap;
+            table* m_table;
             size_t m_domain_index;
             size_t m_pair_index;
             pair<Key, Value>* m_last_valid_pair;
@@ -774,7 +1616,8 @@ namespace gp_std
 
         ///@brief begin iterator
         iterator begin()  noexcept
-        {   
+        {
+            complete_migration();
             if(this->get_total_size() != 0)
                return iterator(this);
             else
@@ -788,14 +1631,20 @@ namespace gp_std
         }
 
         ///@brief find the key in the hashmap and return iter
-        iterator find(const Key &key) const noexcept
+        /// @note  The key's domain is migrated first so the iterator points into the current table
+        iterator find(const Key &key) noexcept
         {
+            operation_guard guard(*this);
             hash128_t hash_val = hash_fun(key);
-            size_t domain_index = eval_domain_index(hash_val);
-            gp_std::optional<size_t> key_index = search_concurrent(key, hash_val, domain_index);
+            table& current = writable_table(hash_val);
+            const size_t domain_index = current.index(hash_val);
+            gp_std::scoped_lock<gp_std::spinlock> lock(current.locks[domain_index].push_back_lock);
+            gp_std::optional<size_t> key_index = search_concurrent(current, key, hash_val, domain_index);
             return (key_index) ? iterator(this, domain_index, key_index.value()) : end();
         }
 
+        ///@brief Scan long sequence domains on device instead of gp_std::compute_device::active_device()
+        /// @note  A scan only goes to the device when device.pays_off() for its length, see search_concurrent()
         void load_compute_device(gp_std::cpu_compute_device& device)
         {
             external_device = &device;
@@ -808,137 +1657,685 @@ namespace gp_std
 
     private:
 
+        /// @brief Scans one slice of a long domain per wave, see search_concurrent()
         class search_kernel : public base_kernel
         {
             public:
-            search_kernel(const hash_map_128_t<Key, Value, HashFunc, base_container>* hashmap, const Key &key, const hash128_t &hash_val, const size_t &domain_index, gp_std::optional<size_t>& key_index)
-                : m_hashmap(hashmap), m_key(key), m_hash_val(hash_val), m_domain_index(domain_index), m_key_index(key_index) {}   
-            
+            search_kernel(const domain_type& domain, const Key& key, const hash128_t &hash_val, std::atomic<size_t>& found)
+                : m_domain(domain), m_key(key), m_hash_val(hash_val), m_found(found) {}
+
             void operator()() override
             {
-                min_max mm = get_current_wave_min_max(m_hashmap->hash_table[m_domain_index].size());
-                
-                // Split the min max into work batches
-                std::array<min_max, 16> batch_mm;
+                const min_max mm = get_current_wave_min_max(m_domain.size());
 
-                for(size_t i = 0; i < 16; ++i)
+                size_t first = mm.min;
+                auto it = m_domain.begin() + first;
+                while (first < mm.max)
                 {
-                    batch_mm[i].min = mm.min + i * 16;
-                    batch_mm[i].max = batch_mm[i].min + 16;
-                }
+                    if (task_progress->is_finished()) return;  // Another wave already found the key
 
-                batch_mm[15].max = mm.max;
-                
-                for(auto& local_mm : batch_mm)
-                {
-                    if(task_progress->is_finished()) return;  // We Ocassionaly check if other threads have already found the key
-                    for(size_t i = local_mm.min; i < local_mm.max; ++i)
+                    const size_t count = std::min(hash_detail::scan_batch, mm.max - first);
+                    // Equal hashes are only candidates, the key decides
+                    uint32_t mask = hash_detail::match_batch(it, count, m_hash_val);
+                    while (mask != 0)
                     {
-                        if (m_hashmap->hash_table[m_domain_index][i].hash_value == m_hash_val)
+                        const size_t slot = first + flat_detail::count_trailing_zeros(mask);
+                        if (m_domain[slot].key == m_key)
                         {
-                            m_key_index = i;
+                            m_found.store(slot, std::memory_order_relaxed);
                             task_progress->finish(); // We signal that we have found the key
                             return;
                         }
+                        mask &= mask - 1;
                     }
-                }
-            }
 
-            base_kernel* clone() const override
-            {
-                return new search_kernel(*this);
+                    first += count;
+                    it += count;
+                }
             }
 
             private:
-            const hash_map_128_t<Key, Value, HashFunc, base_container> *m_hashmap;
+            const domain_type& m_domain;
             const Key& m_key;
             const hash128_t& m_hash_val;
-            const size_t& m_domain_index;
-            gp_std::optional<size_t>& m_key_index;
+            std::atomic<size_t>& m_found;
         };
 
-        size_t eval_domain_index(const hash128_t& hash_val)
+        /// @brief Nanoseconds the scan of domain_traits::find spends per pair, measured once on a domain of the same layout
+        static double scan_cost()
         {
-            size_t domain_index = ((hash_val[0] % max_domains) + (hash_val[1] % max_domains)) % max_domains;
-            return domain_index;
+            static const double cost = measure_scan_cost(std::integral_constant<bool, domain_ops::supports_device>());
+            return cost;
         }
-        
-        gp_std::optional<size_t> search_concurrent(const Key &key)
+
+        static double measure_scan_cost(std::false_type) { return 0.0; }
+
+        // Best of a few scans that miss, over probes with the stride of a pair and only the hash read
+        static double measure_scan_cost(std::true_type)
         {
-            hash128_t hash_val = hash_fun(key);
-            size_t domain_index = eval_domain_index(hash_val);
-            return search_concurrent(key, hash_val, domain_index);
-        }    
+            struct probe
+            {
+                hash128_t hash_value;
+                unsigned char payload[(sizeof(pair<Key, Value>) > sizeof(hash128_t)) ? sizeof(pair<Key, Value>) - sizeof(hash128_t) : 1];
+            };
+
+            constexpr size_t items = 4096;
+            constexpr size_t rounds = 8;
+
+            base_container<probe> domain;
+            for (size_t i = 0; i < items; ++i)
+            {
+                probe p = probe();
+                p.hash_value = hash_detail::hash_integer(i);
+                domain.push_back(p);
+            }
 
-        gp_std::optional<size_t> search_concurrent(const Key &key, const hash128_t& in_hash_val, const size_t& in_domain_index)
+            const hash128_t missing = hash_detail::hash_integer(items);
+            volatile size_t sink = 0;
+            double best = std::numeric_limits<double>::max();
+            for (size_t round = 0; round < rounds; ++round)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                sink = sink + domain_traits<base_container<probe>>::find(domain, missing, [](const probe&) { return true; });
+                const auto stop = std::chrono::steady_clock::now();
+                best = std::min(best, std::chrono::duration<double, std::nano>(stop - start).count());
+            }
+            return std::max(best / items, 0.01);
+        }
+
+        // visit() with the hash already computed, caller is inside an operation_guard
+        template <typename Visitor>
+        bool visit_hashed(const Key& key, const hash128_t& hash_val, Visitor&& visitor) const
         {
-            hash128_t hash_val = in_hash_val;
-            size_t domain_index = in_domain_index;
-            
-            gp_std::optional<size_t> key_index;
+            location found;
+            while (locate(key, hash_val, found))
+            {
+                if (domain_ops::lock_free_reads)
+                {
+                    visitor(static_cast<const Value&>(found.item->value));
+                    return true;
+                }
 
-            external_device =  gp_std::compute_device::active_device();
-            
-            if(hash_table[domain_index].size() > 100 && external_device != nullptr) 
+                // Writers append, rehash and update under push_back_lock, find the pair again once we hold it
+                gp_std::scoped_lock<gp_std::spinlock> lock(found.owner->locks[found.domain_index].push_back_lock);
+                if (found.owner->is_migrated(found.domain_index))
+                    continue;
+
+                const pair<Key, Value>* item = domain_ops::find_item(found.owner->view(found.domain_index), hash_val, [&key](const pair<Key, Value>& p) { return p.key == key; });
+                if (item == nullptr)
+                    return false;
+                visitor(static_cast<const Value&>(item->value));
+                return true;
+            }
+            return false;
+        }
+
+        /// @brief Position of a key within a batch and the domain it hashes to in the table the batch started on
+        struct batch_entry
+        {
+            size_t domain_index;
+            size_t position;
+        };
+
+        /// @brief Hash count keys, prefetch the domain header and lock of each and sort them by domain
+        /// @note  Ties keep their order in the batch, so a key given twice ends with its last value
+        void prepare_batch(const table& target, const Key* keys, const size_t& count, hash128_t* hashes, batch_entry* order) const
+        {
+            for (size_t j = 0; j < count; ++j)
             {
-                search_kernel kernel(this, key, hash_val, domain_index, key_index);
-                external_device->load_kernel(&kernel);
-                while(domain_locks[domain_index].push_back_lock.is_locked())
+                hashes[j] = hash_fun(keys[j]);
+                const size_t domain_index = target.index(hashes[j]);
+                order[j] = batch_entry{ domain_index, j };
+                hash_detail::prefetch(&target.state[domain_index]);
+                hash_detail::prefetch(target.storage[domain_index].bytes);
+                hash_detail::prefetch(&target.locks[domain_index]);
+            }
+            std::sort(order, order + count, [](const batch_entry& a, const batch_entry& b)
+            {
+                return a.domain_index < b.domain_index || (a.domain_index == b.domain_index && a.position < b.position);
+            });
+        }
+
+        // Every distinct domain of a sorted batch, in ascending order : two batches never wait on each other in a cycle
+        static void lock_batch(table& target, const batch_entry* order, const size_t& count)
+        {
+            for (size_t j = 0; j < count; ++j)
+            {
+                if (j == 0 || order[j].domain_index != order[j - 1].domain_index)
+                    target.locks[order[j].domain_index].push_back_lock.lock();
+            }
+        }
+
+        static void unlock_batch(table& target, const batch_entry* order, const size_t& count)
+        {
+            for (size_t j = 0; j < count; ++j)
+            {
+                if (j == 0 || order[j].domain_index != order[j - 1].domain_index)
+                    target.locks[order[j].domain_index].push_back_lock.unlock();
+            }
+        }
+
+        /// @brief Call resolve(i, value) for every key, value is nullptr if keys[i] is absent
+        /// @note  Lock free domains are prefetched and read as they are ; other domains are locked once per batch,
+        /// @note  prefetched under the lock and then read. While a migration runs keys go through visit_hashed()
+        template <typename Resolve>
+        void resolve_batch(const Key* keys, const size_t& count, Resolve&& resolve) const
+        {
+            hash128_t hashes[batch_width];
+            batch_entry order[batch_width];
+            bool deferred[batch_width];
+
+            for (size_t base = 0; base < count; base += batch_width)
+            {
+                const size_t n = std::min(batch_width, count - base);
+                operation_guard guard(*this);
+                table* current = current_table.load();
+                prepare_batch(*current, keys + base, n, hashes, order);
+
+                // While migrating a pair may still sit in an old domain, those keys take the slow path
+                const bool migrating = previous_table.load() != nullptr;
+                const bool lock_domains = !migrating && !domain_ops::lock_free_reads;
+
+                if (lock_domains)
+                    lock_batch(*current, order, n);
+
+                // Only domains nobody can rehash under us are safe to look into
+                if (lock_domains || domain_ops::lock_free_reads)
                 {
-                   // Wait for the push_back_lock to be released
-                   // May be another thread is adding a new key-value pair in this domain
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        if (current->is_constructed(order[j].domain_index))
+                            domain_ops::prefetch(current->domain(order[j].domain_index), hashes[order[j].position]);
+                    }
+                }
+
+                bool any_deferred = migrating;
+                for (size_t j = 0; j < n; ++j)
+                {
+                    const size_t position = order[j].position;
+                    const size_t domain_index = order[j].domain_index;
+                    const Key& key = keys[base + position];
+
+                    deferred[position] = migrating;
+                    if (migrating)
+                        continue;
+
+                    const pair<Key, Value>* item = domain_ops::find_item(current->view(domain_index), hashes[position], [&key](const pair<Key, Value>& p) { return p.key == key; });
+
+                    // The domain left for a newer table while we looked
+                    if (current->is_migrated(domain_index))
+                    {
+                        deferred[position] = any_deferred = true;
+                        continue;
+                    }
+                    resolve(base + position, (item != nullptr) ? &item->value : static_cast<const Value*>(nullptr));
+                }
+
+                if (lock_domains)
+                    unlock_batch(*current, order, n);
+
+                if (!any_deferred)
+                    continue;
+
+                for (size_t j = 0; j < n; ++j)
+                {
+                    if (deferred[j] && !visit_hashed(keys[base + j], hashes[j], [&](const Value& value) { resolve(base + j, &value); }))
+                        resolve(base + j, static_cast<const Value*>(nullptr));
                 }
-                external_device->launch_waves();
-                external_device->wait();
-                return key_index;
             }
-            else
+        }
+
+        /// @brief Where locate() found a key
+        struct location
+        {
+            table* owner;
+            size_t domain_index;
+            const pair<Key, Value>* item;
+        };
+
+        static size_t round_domain_count(const size_t& count)
+        {
+            size_t domains = 1;
+            while (domains < count)
+                domains <<= 1;
+            return domains;
+        }
+
+        // Start over with one empty table, caller holds resize_lock (or owns the map)
+        // The old tables go to the graveyard, operations still reading them are waited out like after a migration
+        void reset_tables(const size_t& domain_count)
+        {
+            generations.emplace_back(new table(domain_count));
+            previous_table.store(nullptr);
+            current_table.store(generations.back().get());
+
+            const uint64_t epoch = gp_std::epoch_manager::global().epoch();
+            while (generations.size() > 1)
             {
-                for (size_t i = 0; i < hash_table[domain_index].size(); ++i)
+                graveyard.push_back(retired_table{ std::move(generations.front()), epoch });
+                generations.pop_front();
+            }
+            graveyard_pending.store(!graveyard.empty(), std::memory_order_relaxed);
+            live_count.store(0, std::memory_order_relaxed);
+            retired_pending.store(false, std::memory_order_relaxed);
+        }
+
+        void copy_from(const hash_map_128_t& other)
+        {
+            const table* other_current  = other.current_table.load(std::memory_order_acquire);
+            const table* other_previous = other.previous_table.load(std::memory_order_acquire);
+
+            reset_tables(other_current->count());
+            table* current = current_table.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < other_current->count(); ++i)
+            {
+                if (other_current->is_constructed(i))
                 {
-                    if (hash_table[domain_index][i].hash_value == hash_val)
-                        return i;
+                    current->writable(i) = other_current->domain(i);
+                    current->locks[i].dead_slots.store(other_current->locks[i].dead_slots.load(std::memory_order_relaxed), std::memory_order_relaxed);
                 }
             }
 
-            return gp_std::nullopt;
+            // Pairs the other map has not migrated yet
+            if (other_previous != nullptr && other_previous != other_current)
+            {
+                for (size_t i = 0; i < other_previous->count(); ++i)
+                {
+                    if (other_previous->is_migrated(i))
+                        continue;
+
+                    const domain_type& domain = other_previous->view(i);
+                    for (size_t slot = 0; slot < domain_ops::slot_count(domain); ++slot)
+                    {
+                        if (domain_ops::is_live(domain, slot))
+                            domain_ops::append(current->writable(current->index(domain[slot].hash_value)), pair<Key, Value>(domain[slot]));
+                    }
+                }
+            }
+            live_count.store(other.live_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
         }
 
-        void rehash(const size_t &new_domain_count)
+        void move_from(hash_map_128_t& other)
         {
             gp_std::scoped_lock<gp_std::spinlock> lock(resize_lock);
+            generations = std::move(other.generations);
+            graveyard = std::move(other.graveyard);
+            graveyard_pending.store(!graveyard.empty(), std::memory_order_relaxed);
+            current_table.store(other.current_table.load(std::memory_order_acquire), std::memory_order_release);
+            previous_table.store(other.previous_table.load(std::memory_order_acquire), std::memory_order_release);
+            migrate_cursor.store(other.migrate_cursor.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            migrated_domains.store(other.migrated_domains.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            live_count.store(other.live_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            retired_pending.store(true, std::memory_order_relaxed);
+            max_load = other.max_load;
+            migration_step = other.migration_step;
+            min_live = other.min_live;
+
+            // Leave other usable, with a single empty domain
+            other.reset_tables(1);
+        }
 
-            hash_map_128_t<Key, Value, HashFunc, base_container> new_hash_map(new_domain_count);
-
-            for(pair<Key, Value>& iter : *this)
+        // The current table with the key's old domain (if any) migrated into it, every writer goes through here
+        table& writable_table(const hash128_t& hash_val)
+        {
+            for (;;)
             {
-                if(iter.is_valid())
-                    new_hash_map.no_check_insert(std::move(iter));
+                // current before previous : a new current_table is published after its previous_table
+                table* current  = current_table.load();
+                table* previous = previous_table.load();
+
+                if (previous == nullptr || previous == current)
+                    return *current;
+
+                migrate_domain(*previous, previous->index(hash_val));
+                advance_migration(*previous, migration_step);
+
+                // A newer migration started meanwhile, the key's domain in the table we were given has to move too
+                if (current_table.load() == current)
+                    return *current;
             }
-            *this = std::move(new_hash_map);
         }
 
-        /// @brief Insert the key-value pair without checking if the key already exists
-        /// @param key Key to insert
-        /// @param value Value to insert
-        /// Usefull for rehashing
-        void no_check_insert(const Key &key, const Value &value)
+        template <typename K, typename V>
+        const pair<Key, Value>& insert_or_assign(K&& key, V&& value)
         {
             hash128_t hash_val = hash_fun(key);
-            size_t domain_index = eval_domain_index(hash_val); 
-            hash_table[domain_index].push_back(pair<Key, Value>(key, value, hash_val));
+            const pair<Key, Value>* result = nullptr;
+            bool grow = false;
+
+            {
+                operation_guard guard(*this);
+                for (;;)
+                {
+                    table& target = writable_table(hash_val);
+                    const size_t domain_index = target.index(hash_val);
+                    domain_lock& lock = target.locks[domain_index];
+
+                    gp_std::scoped_lock<gp_std::spinlock> push_back(lock.push_back_lock);
+                    if (target.is_migrated(domain_index))
+                        continue; // The table was retired under us, retry on the new one
+
+                    domain_type& domain = target.writable(domain_index);
+                    size_t free_slot;
+                    size_t slot = find_for_insert(lock, domain, hash_val, key, free_slot);
+
+                    if (slot != domain_ops::npos)
+                    {
+                        gp_std::scoped_lock<gp_std::spinlock> modify(lock.value_modifier_lock);
+                        domain_ops::assign(domain, slot, std::forward<V>(value));
+                        return domain[slot];
+                    }
+
+                    /// else create a new pair in the domain, in the slot of a removed one if the scan met any
+                    slot = place(lock, domain, free_slot, pair<Key, Value>(std::forward<K>(key), std::forward<V>(value), hash_val));
+                    const size_t live = live_count.fetch_add(1, std::memory_order_relaxed) + 1;
+                    grow = max_load > 0 && static_cast<double>(live) > max_load * static_cast<double>(target.count());
+                    result = &domain[slot];
+                    break;
+                }
+            }
+
+            // Outside the guard and without a domain lock : starting a migration may have to finish the last one
+            if (grow)
+                grow_if_needed();
+            try_reclaim();
+            return *result;
         }
 
-        void no_check_insert(Key &&key, Value &&value)
+        // find() for an insert, caller holds lock.push_back_lock ; free_slot receives a dead slot the scan met, if any
+        size_t find_for_insert(domain_lock& lock, const domain_type& domain, const hash128_t& hash_val, const Key& key, size_t& free_slot) const
         {
-            hash128_t hash_val = hash_fun(key);
-            size_t domain_index = eval_domain_index(hash_val);
-            hash_table[domain_index].push_back(std::move(pair<Key, Value>(std::move(key), std::move(value), hash_val)));
+            free_slot = domain_ops::npos;
+            gp_std::stats::record_domain_length(domain_ops::slot_count(domain));
+            if (lock.dead_slots.load(std::memory_order_relaxed) == 0)
+                return domain_ops::find(domain, hash_val, [&key](const pair<Key, Value>& p) { return p.key == key; });
+            return domain_ops::find_or_free(domain, hash_val, [&key](const pair<Key, Value>& p) { return p.key == key; }, free_slot);
+        }
+
+        // Store a new pair in free_slot or at the end of the domain, caller holds lock.push_back_lock
+        template <typename Pair>
+        size_t place(domain_lock& lock, domain_type& domain, const size_t& free_slot, Pair&& new_pair)
+        {
+            if (free_slot != domain_ops::npos)
+                lock.dead_slots.store(lock.dead_slots.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+            return domain_ops::place(domain, free_slot, std::forward<Pair>(new_pair));
+        }
+
+        // One more removed pair in domain, caller holds both of its locks ; compacting costs a pass over the domain
+        // and happens after at least (1 - min_live) * slots removes since the last one, so it is O(1) per remove
+        void add_dead_slot(domain_lock& lock, domain_type& domain)
+        {
+            const size_t dead  = lock.dead_slots.load(std::memory_order_relaxed) + 1;
+            const size_t slots = domain_ops::slot_count(domain);
+            if (dead >= min_compaction && static_cast<double>(slots - dead) < min_live * static_cast<double>(slots))
+            {
+                gp_std::stats::record_compaction(dead);
+                domain_ops::compact(domain);
+                lock.dead_slots.store(0, std::memory_order_relaxed);
+                return;
+            }
+            lock.dead_slots.store(dead, std::memory_order_relaxed);
         }
 
-        void no_check_insert(pair<Key, Value>&& pair)
+        void grow_if_needed()
         {
-            no_check_insert(std::move(pair.first), std::move(pair.second));
+            if (previous_table.load(std::memory_order_relaxed) != nullptr)
+                return;
+
+            // Tables are only freed under resize_lock, so current stays valid while we hold it
+            gp_std::scoped_lock<gp_std::spinlock> lock(resize_lock);
+            table* current = current_table.load();
+
+            // Somebody else may have started growing while we waited
+            if (previous_table.load() == nullptr && static_cast<double>(live_count.load(std::memory_order_relaxed)) > max_load * static_cast<double>(current->count()))
+                begin_migration(current->count() * 2);
+        }
+
+        // Publish a new current table, the old one is drained by migrate_domain.
+        // Caller holds resize_lock (so no table can be freed under us) and is not inside an operation_guard
+        void begin_migration(const size_t& domain_count)
+        {
+            // One migration at a time
+            table* previous = previous_table.load();
+            if (previous != nullptr)
+                sweep_migration(*previous);
+
+            reclaim_locked();
+
+            table* current = current_table.load();
+            generations.emplace_back(new table(domain_count));
+
+            migrate_cursor.store(0, std::memory_order_relaxed);
+            migrated_domains.store(0, std::memory_order_relaxed);
+            previous_table.store(current);
+            current_table.store(generations.back().get());
+        }
+
+        /// @brief Send the tables neither current_table nor previous_table point to the graveyard
+        /// @note  Pointers are read before the epoch : an operation that loaded a dropped table pinned
+        /// @note  an epoch the graveyard waits out (epoch_manager::is_safe). Caller holds resize_lock
+        void reclaim_locked()
+        {
+            table* current  = current_table.load();
+            table* previous = previous_table.load();
+
+            if (generations.size() <= 1)
+                return;
+
+            const uint64_t epoch = gp_std::epoch_manager::global().epoch();
+            for (auto iter = generations.begin(); iter != generations.end(); )
+            {
+                if (iter->get() != current && iter->get() != previous)
+                {
+                    graveyard.push_back(retired_table{ std::move(*iter), epoch });
+                    iter = generations.erase(iter);
+                    graveyard_pending.store(true, std::memory_order_relaxed);
+                }
+                else
+                    ++iter;
+            }
+            retired_pending.store(false, std::memory_order_relaxed);
+        }
+
+        // Called after an operation, outside its guard
+        void try_reclaim()
+        {
+            if (retired_pending.load(std::memory_order_relaxed))
+            {
+                gp_std::scoped_lock<gp_std::spinlock> lock(resize_lock);
+                reclaim_locked();
+            }
+
+            // One thread at a time chips at the graveyard, the others carry on
+            if (!graveyard_pending.load(std::memory_order_relaxed) || reclaim_busy.exchange(true, std::memory_order_acquire))
+                return;
+
+            {
+                gp_std::scoped_lock<gp_std::spinlock> lock(resize_lock);
+                gp_std::epoch_manager& epochs = gp_std::epoch_manager::global();
+                if (!graveyard.empty())
+                {
+                    if (!epochs.is_safe(graveyard.front().epoch))
+                        epochs.try_advance();
+                    else if (graveyard.front().generation->destroy_domains(reclaim_step))
+                        graveyard.pop_front();
+                }
+                if (graveyard.empty())
+                    graveyard_pending.store(false, std::memory_order_relaxed);
+            }
+            reclaim_busy.store(false, std::memory_order_release);
+        }
+
+        void advance_migration(table& from, const size_t& domain_count)
+        {
+            for (size_t n = 0; n < domain_count; ++n)
+            {
+                if (previous_table.load(std::memory_order_acquire) != &from)
+                    return;
+
+                const size_t index = migrate_cursor.fetch_add(1, std::memory_order_relaxed);
+                if (index >= from.count())
+                {
+                    // The cursor ran past the end, pick up domains a stale helper claimed but skipped
+                    sweep_migration(from);
+                    return;
+                }
+                migrate_domain(from, index);
+            }
+        }
+
+        void sweep_migration(table& from)
+        {
+            for (size_t i = 0; i < from.count() && previous_table.load(std::memory_order_acquire) == &from; ++i)
+                migrate_domain(from, i);
+        }
+
+        /// @brief Move the live pairs of one old domain into the current table
+        /// @note  Holds both locks of the old domain, so locking readers of that domain wait instead of missing a pair.
+        /// @note  Lock free readers find the pair on one side or the other : the old domain is marked migrated
+        /// @note  and only then let go of its pairs (finish_migration), after they were published in the new table
+        void migrate_domain(table& from, const size_t& index)
+        {
+            if (from.is_migrated(index))
+                return;
+
+            domain_lock& lock = from.locks[index];
+            gp_std::scoped_lock<gp_std::spinlock> push_back(lock.push_back_lock);
+            gp_std::scoped_lock<gp_std::spinlock> modify(lock.value_modifier_lock);
+
+            if (from.is_migrated(index))
+                return;
+
+            table* to = current_table.load(std::memory_order_acquire);
+
+            if (from.is_constructed(index))
+            {
+                domain_type& domain = from.domain(index);
+                for (size_t slot = 0; slot < domain_ops::slot_count(domain); ++slot)
+                {
+                    if (!domain_ops::is_live(domain, slot))
+                        continue;
+
+                    const size_t target = to->index(domain[slot].hash_value);
+                    gp_std::scoped_lock<gp_std::spinlock> target_lock(to->locks[target].push_back_lock);
+                    domain_ops::migrate(domain, slot, to->writable(target));
+                }
+            }
+
+            from.mark_migrated(index);
+            if (from.is_constructed(index))
+                domain_ops::finish_migration(from.domain(index));
+
+            if (migrated_domains.fetch_add(1, std::memory_order_acq_rel) + 1 == from.count())
+            {
+                table* expected = &from;
+                if (previous_table.compare_exchange_strong(expected, nullptr))
+                    retired_pending.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        /// @brief Find key in the old domain (still being migrated) and then in the current table
+        bool locate(const Key& key, const hash128_t& hash_val, location& found) const
+        {
+            for (;;)
+            {
+                table* current  = current_table.load();
+                table* previous = previous_table.load();
+
+                if (previous != nullptr && previous != current)
+                {
+                    const size_t old_index = previous->index(hash_val);
+                    if (domain_ops::lock_free_reads)
+                    {
+                        // An emptied block means the pairs are already in the current table
+                        if (const pair<Key, Value>* item = domain_ops::find_item(previous->view(old_index), hash_val, [&key](const pair<Key, Value>& p) { return p.key == key; }))
+                        {
+                            found = location{ previous, old_index, item };
+                            return true;
+                        }
+                    }
+                    else if (!previous->is_migrated(old_index))
+                    {
+                        gp_std::scoped_lock<gp_std::spinlock> lock(previous->locks[old_index].push_back_lock);
+                        if (!previous->is_migrated(old_index))
+                        {
+                            if (const pair<Key, Value>* item = domain_ops::find_item(previous->view(old_index), hash_val, [&key](const pair<Key, Value>& p) { return p.key == key; }))
+                            {
+                                found = location{ previous, old_index, item };
+                                return true;
+                            }
+                        }
+                    }
+                }
+
+                const size_t domain_index = current->index(hash_val);
+                const pair<Key, Value>* item = search_item(*current, key, hash_val, domain_index);
+
+                // The domain moved on while we looked, look again in the newer table
+                if (current->is_migrated(domain_index))
+                    continue;
+
+                if (item == nullptr)
+                    return false;
+
+                found = location{ current, domain_index, item };
+                return true;
+            }
+        }
+
+        const pair<Key, Value>* search_item(table& target, const Key &key, const hash128_t& hash_val, const size_t& domain_index) const
+        {
+            // Slots of a snapshot domain can shift under us, only the node itself is stable
+            if (domain_ops::lock_free_reads)
+                return domain_ops::find_item(target.view(domain_index), hash_val, [&key](const pair<Key, Value>& p) { return p.key == key; });
+
+            // Sequences and flat domains move their memory on insert, they are read under the writers' lock
+            gp_std::scoped_lock<gp_std::spinlock> lock(target.locks[domain_index].push_back_lock);
+            gp_std::optional<size_t> key_index = search_concurrent(target, key, hash_val, domain_index);
+            return (key_index) ? &target.domain(domain_index)[key_index.value()] : nullptr;
+        }
+
+        // Caller holds the domain's push_back_lock, so no pair is appended while the device scans
+        // A domain goes to the device once its scan costs more than a launch saves (scan_cost() against
+        // cpu_compute_device::launch_overhead()), and only if no other launch holds the device
+        gp_std::optional<size_t> search_concurrent(table& target, const Key &key, const hash128_t& hash_val, const size_t& domain_index) const
+        {
+            const domain_type& domain = target.view(domain_index);
+
+            size_t slot = domain_ops::npos;
+            if (!search_on_device(domain, key, hash_val, slot, std::integral_constant<bool, domain_ops::supports_device>()))
+                slot = domain_ops::find(domain, hash_val, [&key](const pair<Key, Value>& p) { return p.key == key; });
+
+            if (slot != domain_ops::npos)
+                return slot;
+
+            return gp_std::nullopt;
+        }
+
+        // True if a device scanned the domain, slot then holds the match or npos
+        bool search_on_device(const domain_type&, const Key&, const hash128_t&, size_t&, std::false_type) const { return false; }
+
+        bool search_on_device(const domain_type& domain, const Key& key, const hash128_t& hash_val, size_t& slot, std::true_type) const
+        {
+            // Under a batch per wave no launch can pay off, do not even look for a device
+            if (domain.size() < 2 * hash_detail::scan_batch)
+                return false;
+
+            gp_std::cpu_compute_device* device = (external_device != nullptr) ? external_device : gp_std::compute_device::active_device();
+            if (device == nullptr || !device->pays_off(domain.size(), scan_cost()))
+                return false;
+
+            std::atomic<size_t> found(hash_detail::no_match);
+            search_kernel kernel(domain, key, hash_val, found);
+            if (!device->try_load_kernel(&kernel))
+                return false;
+
+            device->launch_waves();
+            device->wait();
+
+            const size_t match = found.load(std::memory_order_relaxed);
+            slot = (match != hash_detail::no_match) ? match : domain_ops::npos;
+            return true;
         }
     };
 } // end of namespace gp_std
@@ -6,15 +6,31 @@
 #include <algorithm>
 #include <unordered_map>
 #include <map>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "../memory/gp_pages.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <xmmintrin.h>
+#endif
 
 namespace gp_std
 {
 //
-/// @brief template <typename Key, typename Value> 
+/// @brief template <typename Key, typename Value>
 /// @brief class lookup_table
 // Primary API for lookup_table class. Go to this class for Actually using them
 // A lookup table is a read-only data structure that maps keys to values
-// Its Base Container is a std::vector of std::pair<Key, Value>
+// Its tables are laid out once, when built, for the lookups that follow
 // When a key is looked up, the table returns a pointer to the value
 
 // Advantages:
@@ -23,8 +39,22 @@ namespace gp_std
 // It supports both hash-based and tree-based lookup tables
 // It is a header-only library
 
+// Layouts:
+// The hash table is a minimal perfect hash (PTHash style, one pilot per bucket of about 4 keys),
+// keys and values live in two arrays of exactly size() entries and a lookup reads one key and one value.
+// The tree table keeps its keys in Eytzinger (breadth first) order, the first levels of the tree
+// share cache lines and the next levels are prefetched while the search walks down.
+// lookup_many() interleaves a batch of lookups so their cache misses overlap.
+
+// Snapshots:
+// A table of trivially copyable keys and values can be saved to a file and opened again with mmap,
+// the arrays of the table are used in place from the mapping, so opening does no parsing nor copying
+// and every process opening the same file shares its pages. The file keeps the layout it was built with.
+
 // Limitations:
 // Insertions are not allowed in the lookup table but values can be modified
+// Tables are built on one thread, build once and save() a snapshot so the other processes open it instead.
+// Building the partitions of a large table in parallel (on an executor) is not done yet.
 
 // Usage:
 // --> Create a lookup table from a std::map or std::unordered_map
@@ -33,8 +63,9 @@ namespace gp_std
 
 // --> Construct a lookup table
 // lookup_table<int, std::string> table(data);
-// or 
-// lookup_table<int, std::string> table(data.begin(), data.end(), size(if known));
+// or
+// lookup_table<int, std::string> table(data.begin(), data.end(), size(if known));                 // hash table
+// lookup_table<int, std::string> table(lookup_ordered, data.begin(), data.end(), size(if known)); // tree table
 
 // --> Query the lookup table whether its a hash table or tree table
 //  table.is_tree_table() or table.is_hash_table()
@@ -44,9 +75,27 @@ namespace gp_std
 // {
 //     std::cout << *value << std::endl; // Output: two
 // }
+
+// --> Look up many keys at once
+// std::string* values[3];
+// int keys[3] = {1, 3, 7};
+// table.lookup_many(keys, 3, values); // values[2] == nullptr
+
+// --> Save a table and map it back, in this process or another one
+// lookup_table<uint64_t, double> prices(data);
+// prices.save("prices.gplt");
+// lookup_table<uint64_t, double> mapped = lookup_table<uint64_t, double>::open("prices.gplt"); // same Hash / Compare as the saved table
 template <typename Key, typename Value>
 class lookup_table;
 
+// Tag asking a lookup_table built from a range for the tree layout
+struct lookup_ordered_t
+{
+    constexpr lookup_ordered_t() {}
+};
+
+static constexpr lookup_ordered_t lookup_ordered{};
+
 namespace gp_private
 {
 template <typename Key, typename Value>
@@ -58,17 +107,298 @@ class lookup_hashtable;
 template <typename Key, typename Value, typename Compare , typename Allocator>
 class lookup_treetable;
 
+inline void lookup_prefetch(const void* address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+// Lookups lookup_many keeps in flight together
+static constexpr size_t lookup_batch = 16;
+
+// Array of a table, either built into a vector it owns or borrowed from a mapped snapshot
+template <typename T>
+class table_array
+{
+public:
+    table_array() = default;
+
+    table_array(const table_array& other) : m_owned(other.m_owned), m_size(other.m_size)
+    {
+        m_data = other.m_data != other.m_owned.data() ? other.m_data : m_owned.data();
+    }
+
+    table_array(table_array&& other) noexcept : m_owned(std::move(other.m_owned)), m_data(other.m_data), m_size(other.m_size)
+    {
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+
+    table_array& operator=(table_array other) noexcept
+    {
+        m_owned.swap(other.m_owned);
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        return *this;
+    }
+
+    void assign(std::vector<T>&& values)
+    {
+        m_owned = std::move(values);
+        m_data = m_owned.data();
+        m_size = m_owned.size();
+    }
+
+    ///@brief Use size elements at data, owned by someone else for as long as this array lives
+    void borrow(T* data, size_t size)
+    {
+        std::vector<T>().swap(m_owned);
+        m_data = data;
+        m_size = size;
+    }
+
+    T* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    T& operator[](size_t index) const { return m_data[index]; }
+
+private:
+    std::vector<T> m_owned;
+    T* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+// Snapshot file : the header, then the sections, each one starting on a multiple of snapshot_alignment
+static constexpr char snapshot_magic[8] = { 'G', 'P', 'L', 'O', 'O', 'K', 'U', 'P' };
+static constexpr uint32_t snapshot_version = 1;
+static constexpr uint32_t snapshot_byte_order = 0x01020304;
+static constexpr uint64_t snapshot_alignment = 64;
+
+enum snapshot_layout : uint32_t
+{
+    snapshot_hash = 1,
+    snapshot_tree = 2
+};
+
+enum snapshot_section : size_t
+{
+    section_keys,
+    section_values,
+    section_pilots,
+    section_remap,
+    section_count
+};
+
+struct snapshot_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;                 // snapshot_byte_order as the writer stored it
+    uint32_t layout;                     // snapshot_layout
+    uint32_t key_size;
+    uint32_t key_align;
+    uint32_t value_size;
+    uint32_t value_align;
+    uint32_t reserved;
+    uint64_t count;                      // entries
+    uint64_t seed;                       // hash layout only
+    uint64_t slot_count;                 // hash layout only
+    uint64_t placed;                     // hash layout only
+    uint64_t offsets[section_count];     // from the start of the file
+    uint64_t sizes[section_count];       // in bytes
+    uint64_t file_size;
+};
+
+///@brief Write header and the sections at data (sizes already in header) to path
+/// @note  The file is written next to path and renamed over it, processes still mapping the old file keep their pages
+inline void write_snapshot(const char* path, snapshot_header header, const void* const data[section_count])
+{
+    std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+    header.version = snapshot_version;
+    header.byte_order = snapshot_byte_order;
+
+    uint64_t offset = sizeof(snapshot_header);
+    for (size_t i = 0; i < section_count; ++i)
+    {
+        offset = (offset + snapshot_alignment - 1) / snapshot_alignment * snapshot_alignment;
+        header.offsets[i] = offset;
+        offset += header.sizes[i];
+    }
+    header.file_size = offset;
+
+    const std::string temporary = std::string(path) + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (file == nullptr)
+        throw std::runtime_error("lookup_table : can not write " + temporary);
+
+    static const char padding[snapshot_alignment] = {};
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t position = sizeof(header);
+    for (size_t i = 0; i < section_count && written; ++i)
+    {
+        written = fwrite(padding, 1, static_cast<size_t>(header.offsets[i] - position), file) == header.offsets[i] - position;
+        if (written && header.sizes[i] != 0)
+            written = fwrite(data[i], 1, static_cast<size_t>(header.sizes[i]), file) == header.sizes[i];
+        position = header.offsets[i] + header.sizes[i];
+    }
+    written = fclose(file) == 0 && written;
+
+#if defined(_WIN32)
+    if (written)
+        remove(path); // rename does not replace on Windows
+#endif
+    if (!written || rename(temporary.c_str(), path) != 0)
+    {
+        remove(temporary.c_str());
+        throw std::runtime_error(std::string("lookup_table : can not write ") + path);
+    }
+}
+
+// A snapshot file mapped copy-on-write, checked against the key and value types asking for it
+class snapshot_file
+{
+public:
+    snapshot_file(const char* path, uint32_t key_size, uint32_t key_align, uint32_t value_size, uint32_t value_align)
+    {
+        m_data = static_cast<char*>(pages::map_file(path, m_size));
+        if (m_data == nullptr)
+            throw std::runtime_error(std::string("lookup_table : can not map ") + path);
+
+        const char* problem = check(key_size, key_align, value_size, value_align);
+        if (problem != nullptr)
+        {
+            pages::unmap_file(m_data, m_size);
+            throw std::runtime_error(std::string("lookup_table : ") + path + " " + problem);
+        }
+    }
+
+    snapshot_file(const snapshot_file&) = delete;
+    snapshot_file& operator=(const snapshot_file&) = delete;
+
+    ~snapshot_file()
+    {
+        pages::unmap_file(m_data, m_size);
+    }
+
+    const snapshot_header& header() const
+    {
+        return *reinterpret_cast<const snapshot_header*>(m_data);
+    }
+
+    template <typename T>
+    T* section(snapshot_section index) const
+    {
+        return reinterpret_cast<T*>(m_data + header().offsets[index]);
+    }
+
+    template <typename T>
+    size_t section_size(snapshot_section index) const
+    {
+        return static_cast<size_t>(header().sizes[index] / sizeof(T));
+    }
+
+private:
+    const char* check(uint32_t key_size, uint32_t key_align, uint32_t value_size, uint32_t value_align) const
+    {
+        if (m_size < sizeof(snapshot_header))
+            return "is not a lookup table snapshot";
+
+        const snapshot_header& h = header();
+        if (std::memcmp(h.magic, snapshot_magic, sizeof(h.magic)) != 0)
+            return "is not a lookup table snapshot";
+        if (h.version != snapshot_version)
+            return "was written by another version";
+        if (h.byte_order != snapshot_byte_order)
+            return "was written on a machine of another byte order";
+        if (h.layout != snapshot_hash && h.layout != snapshot_tree)
+            return "has an unknown layout";
+        if (h.key_size != key_size || h.key_align != key_align || h.value_size != value_size || h.value_align != value_align)
+            return "holds keys or values of other types";
+        if (h.file_size != m_size)
+            return "is truncated";
+        if (h.sizes[section_keys] != h.count * key_size || h.sizes[section_values] != h.count * value_size)
+            return "is corrupted";
+
+        for (size_t i = 0; i < section_count; ++i)
+        {
+            if (h.offsets[i] % snapshot_alignment != 0 || h.offsets[i] > m_size || h.sizes[i] > m_size - h.offsets[i])
+                return "is corrupted";
+        }
+        return nullptr;
+    }
+
+    char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+/// @brief Iterator over the (key, value) entries of a lookup table, in the order of its layout
+template <typename Key, typename Value>
+class lookup_iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<const Key&, Value&>;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type;
+
+    // Proxy so it->first works, the pair of references only lives as long as the expression
+    struct pointer
+    {
+        value_type entry;
+        const value_type* operator->() const { return &entry; }
+    };
+
+    lookup_iterator(const Key* key, Value* value) : m_key(key), m_value(value) {}
+
+    reference operator*() const { return value_type(*m_key, *m_value); }
+    pointer operator->() const { return pointer{ value_type(*m_key, *m_value) }; }
+
+    lookup_iterator& operator++()
+    {
+        ++m_key;
+        ++m_value;
+        return *this;
+    }
+
+    lookup_iterator operator++(int)
+    {
+        lookup_iterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    bool operator==(const lookup_iterator& other) const { return m_key == other.m_key; }
+    bool operator!=(const lookup_iterator& other) const { return m_key != other.m_key; }
+
+private:
+    const Key* m_key;
+    Value* m_value;
+};
+
 // Interface for lookup tables (Insertions are not allowed)
+// m_keys[i] maps to m_values[i], in whatever order the layout of the table wants them
 template <typename Key, typename Value>
 class base_lookup_table
 {
 protected:
-    std::vector<std::pair<Key, Value>> m_table;
+    table_array<Key> m_keys;
+    table_array<Value> m_values;
+    std::shared_ptr<const snapshot_file> m_snapshot; // the mapping m_keys and m_values point into, if opened from a file
 
 public:
+    using iterator = lookup_iterator<Key, Value>;
+
     virtual ~base_lookup_table() = default;
     virtual Value* lookup(const Key& key) const = 0;
-    
+
+    ///@brief results[i] = lookup(keys[i]) for every i < count, with the memory accesses of a batch of keys overlapped
+    virtual void lookup_many(const Key* keys, size_t count, Value** results) const = 0;
+
     Value* operator[](const Key& key) const
     {
         Value* value = lookup(key);
@@ -77,20 +407,20 @@ public:
         return nullptr;
     }
 
-    std::pair<const Key&, Value&>* begin() 
-    { return this->m_table.begin(); }
+    iterator begin() const
+    { return iterator(m_keys.data(), m_values.data()); }
 
-    std::pair<const Key&, Value&>* end() 
-    { return this->m_table.end();   }
+    iterator end() const
+    { return iterator(m_keys.data() + m_keys.size(), m_values.data() + m_values.size()); }
 
     bool empty() const
     {
-        return m_table.empty();
+        return m_keys.empty();
     }
 
     size_t size() const
     {
-        return m_table.size();
+        return m_keys.size();
     }
 
     bool operator==(const base_lookup_table<Key, Value>& other) const
@@ -98,16 +428,18 @@ public:
         return is_equal(other);
     }
 
+    // Same keys mapped to equal values, whatever the layout of each table
     bool is_equal(const base_lookup_table<Key, Value>& other) const
     {
-        if (m_table.size() != other.m_table.size())
+        if (size() != other.size())
         {
             return false;
         }
 
-        for (size_t i = 0; i < m_table.size(); ++i)
+        for (size_t i = 0; i < m_keys.size(); ++i)
         {
-            if (m_table[i] != other.m_table[i])
+            const Value* value = other.lookup(m_keys[i]);
+            if (value == nullptr || !(*value == m_values[i]))
             {
                 return false;
             }
@@ -125,58 +457,169 @@ public:
     virtual bool is_hash_table() const = 0;
 
     virtual std::shared_ptr<base_lookup_table<Key, Value>> clone() const = 0;
+
+    ///@brief Write the table to path, to be mapped back by lookup_table::open
+    /// @note  Throws std::runtime_error if the keys or values are not trivially copyable, or the file can not be written
+    virtual void save(const char* path) const = 0;
+
+protected:
+    // Header and sections of the keys and values, the layout fills in the rest of them
+    void save_snapshot(const char* path, snapshot_header header, const void* data[section_count]) const
+    {
+        if (!std::is_trivially_copyable<Key>::value || !std::is_trivially_copyable<Value>::value)
+            throw std::runtime_error("lookup_table : only tables of trivially copyable keys and values can be saved");
+
+        header.key_size = sizeof(Key);
+        header.key_align = alignof(Key);
+        header.value_size = sizeof(Value);
+        header.value_align = alignof(Value);
+        header.count = m_keys.size();
+        header.sizes[section_keys] = m_keys.size() * sizeof(Key);
+        header.sizes[section_values] = m_values.size() * sizeof(Value);
+        data[section_keys] = m_keys.data();
+        data[section_values] = m_values.data();
+        write_snapshot(path, header, data);
+    }
+
+    void map_snapshot(std::shared_ptr<const snapshot_file> file)
+    {
+        m_keys.borrow(file->template section<Key>(section_keys), file->template section_size<Key>(section_keys));
+        m_values.borrow(file->template section<Value>(section_values), file->template section_size<Value>(section_values));
+        m_snapshot = std::move(file);
+    }
 };
 
+// Bits of the minimal perfect hash
+namespace mph
+{
+    // splitmix64 finalizer, std::hash of an integer is often the integer itself
+    inline uint64_t mix(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // x scaled to [0, range) without a division
+    inline uint64_t reduce(uint64_t x, uint64_t range)
+    {
+    #if defined(__SIZEOF_INT128__)
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(x) * range) >> 64);
+    #elif defined(_MSC_VER) && defined(_M_X64)
+        return __umulh(x, range);
+    #else
+        return x % range;
+    #endif
+    }
+
+    // Average keys per bucket, more keys per bucket is a smaller pilot array and a longer build
+    static constexpr size_t bucket_load = 4;
+
+    inline uint64_t bucket_count(uint64_t keys) { return (keys + bucket_load - 1) / bucket_load; }
+
+    // Slots per key while placing, the slots past size() are remapped into the holes below size()
+    static constexpr double slot_load = 0.95;
+
+    // Pilots tried for one bucket before the build starts over with another seed
+    static constexpr uint64_t max_pilot = uint64_t(1) << 20;
+} // namespace mph
+
 // Hash-based lookup table
+// A minimal perfect hash over the keys: key -> bucket -> pilot -> slot, then one key compare to reject absent keys.
+// Keys whose 64-bit hash is shared with another key cannot be told apart by any pilot, they are stored after the others and scanned.
 template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
 class lookup_hashtable : public base_lookup_table<Key, Value>
 {
 private:
-    std::vector<size_t> m_hashes;
+    uint64_t m_seed = 0;
+    uint64_t m_slot_count = 0;
+    uint64_t m_bucket_count = 0;
+    table_array<uint32_t> m_pilots;     // one per bucket
+    table_array<uint32_t> m_remap;      // slot - m_placed -> entry, for the slots past m_placed
+    size_t m_placed = 0;                // entries placed by the hash, the ones after them share their whole hash with one of them
 
 public:
     explicit lookup_hashtable(const std::unordered_map<Key, Value, Hash, KeyEqual, Allocator>& data)
     {
-       import_data(data);
-       sort_hashtable();
+        build(data.begin(), data.end(), data.size(), false);
     }
 
     explicit lookup_hashtable(std::unordered_map<Key, Value, Hash, KeyEqual, Allocator>&& data)
     {
-        import_data(std::move(data));
-        sort_hashtable();
+        build(data.begin(), data.end(), data.size(), true);
     }
 
     template <typename It>
-    explicit lookup_hashtable(It Begin, It End)
+    explicit lookup_hashtable(It Begin, It End, uint32_t size = 0)
     {
-        import_data(Begin, End);
-        sort_hashtable();
+        build(Begin, End, size, false);
+    }
+
+    // The table of a snapshot file, its arrays point into the mapping
+    explicit lookup_hashtable(std::shared_ptr<const snapshot_file> file)
+    {
+        const snapshot_header& header = file->header();
+        m_seed = header.seed;
+        m_slot_count = header.slot_count;
+        m_placed = static_cast<size_t>(header.placed);
+        m_pilots.borrow(file->section<uint32_t>(section_pilots), file->section_size<uint32_t>(section_pilots));
+        m_remap.borrow(file->section<uint32_t>(section_remap), file->section_size<uint32_t>(section_remap));
+        m_bucket_count = m_pilots.size();
+        this->map_snapshot(std::move(file));
+
+        if (m_placed > this->m_keys.size() || m_slot_count < m_placed || m_remap.size() != m_slot_count - m_placed ||
+            m_bucket_count != mph::bucket_count(m_placed))
+            throw std::runtime_error("lookup_table : corrupted hash table snapshot");
+
+        // Keys land where this Hash sends them only if it is the one the table was built with
+        for (size_t i = 0; i < std::min<size_t>(m_placed, 64); ++i)
+        {
+            if (entry_of(hash_of(this->m_keys[i])) != i)
+                throw std::runtime_error("lookup_table : hash table snapshot built with another hash function");
+        }
     }
 
     Value* lookup(const Key& key) const override
     {
-        size_t key_hash = Hash<Key>{}(key);
+        if (this->m_keys.empty())
+            return nullptr;
+
+        const size_t entry = entry_of(hash_of(key));
+        if (KeyEqual{}(this->m_keys[entry], key))
+            return &this->m_values[entry];
 
-        auto it = std::lower_bound(m_hashes.begin(), m_hashes.end(), key_hash);
-        
-        // If the hash value is found
-        if (it != m_hashes.end() && *it == key_hash)
+        return lookup_overflow(key);
+    }
+
+    // Hash and prefetch the key and value of a whole batch, then compare
+    void lookup_many(const Key* keys, size_t count, Value** results) const override
+    {
+        size_t entries[lookup_batch];
+        for (size_t first = 0; first < count; first += lookup_batch)
         {
-            // This Logic is to handle the case where multiple keys have the same hash value
-            size_t index = std::distance(m_hashes.begin(), it);
-            while (index < m_hashes.size() && m_hashes[index] == key_hash)
+            const size_t batch = std::min(lookup_batch, count - first);
+            if (this->m_keys.empty())
             {
-                // If the key is found
-                if (this->m_table[index].first == key)
-                {
-                    return &this->m_table[index].second;
-                }
-                ++index;
+                std::fill(results + first, results + first + batch, nullptr);
+                continue;
+            }
+
+            for (size_t i = 0; i < batch; ++i)
+            {
+                entries[i] = entry_of(hash_of(keys[first + i]));
+                lookup_prefetch(&this->m_keys[entries[i]]);
+                lookup_prefetch(&this->m_values[entries[i]]);
+            }
+
+            for (size_t i = 0; i < batch; ++i)
+            {
+                const Key& key = keys[first + i];
+                results[first + i] = KeyEqual{}(this->m_keys[entries[i]], key) ? &this->m_values[entries[i]] : lookup_overflow(key);
             }
         }
-        
-        return nullptr;
     }
 
     std::shared_ptr<base_lookup_table<Key, Value>> clone() const override
@@ -184,152 +627,469 @@ public:
         return std::make_shared<lookup_hashtable<Key, Value, Hash, KeyEqual, Allocator>>(*this);
     }
 
-    private:
-    void import_data(std::unordered_map<Key, Value, Hash, KeyEqual, Allocator>&& data)
-    {       
-        this->m_type = base_lookup_table<Key, Value>::table_type::hash_table;
-        this->m_table.reserve(data.size());
-        m_hashes.reserve(data.size());
+    void save(const char* path) const override
+    {
+        snapshot_header header = {};
+        header.layout = snapshot_hash;
+        header.seed = m_seed;
+        header.slot_count = m_slot_count;
+        header.placed = m_placed;
+        header.sizes[section_pilots] = m_pilots.size() * sizeof(uint32_t);
+        header.sizes[section_remap] = m_remap.size() * sizeof(uint32_t);
+
+        const void* data[section_count] = { nullptr, nullptr, m_pilots.data(), m_remap.data() };
+        this->save_snapshot(path, header, data);
+    }
 
-        for (const auto &entry : data)
-        {
-            size_t hash_value = Hash<Key>{}(entry.first);
-            this->m_table.emplace_back(std::move(entry.first), std::move(entry.second));
-            m_hashes.push_back(hash_value);
-        }
+    bool is_tree_table() const override final { return false; }
+
+    bool is_hash_table() const override final { return true;  }
+
+private:
+    uint64_t hash_of(const Key& key) const
+    {
+        return mph::mix(static_cast<uint64_t>(Hash{}(key)) + m_seed);
+    }
+
+    size_t bucket_of(uint64_t hash) const
+    {
+        return static_cast<size_t>(mph::reduce(hash, m_bucket_count));
+    }
 
+    uint64_t slot_of(uint64_t hash, uint32_t pilot) const
+    {
+        return mph::reduce(mph::mix(hash ^ mph::mix(pilot + m_seed)), m_slot_count);
     }
 
-    void import_data(const std::unordered_map<Key, Value, Hash, KeyEqual, Allocator>& data)
+    size_t entry_of(uint64_t hash) const
     {
-        this->m_table.reserve(data.size());
-        m_hashes.reserve(data.size());
+        const uint64_t slot = slot_of(hash, m_pilots[bucket_of(hash)]);
+        return slot < m_placed ? static_cast<size_t>(slot) : m_remap[static_cast<size_t>(slot - m_placed)];
+    }
 
-        for (const auto &entry : data)
+    Value* lookup_overflow(const Key& key) const
+    {
+        for (size_t i = m_placed; i < this->m_keys.size(); ++i)
         {
-            size_t hash_value = Hash<Key>{}(entry.first);
-            this->m_table.emplace_back((entry.first), (entry.second));
-            m_hashes.push_back(hash_value);
+            if (KeyEqual{}(this->m_keys[i], key))
+                return &this->m_values[i];
         }
+        return nullptr;
     }
 
     template <typename It>
-    void import_data(It begin, It end, 
-        typename std::enable_if<
-            std::is_same<typename std::iterator_traits<It>::value_type, 
-                         typename std::unordered_map<Key, Value>::value_type>::value, 
-            int>::type = 0, uint32_t size = 0)
-    {
-        this->m_table.reserve(size);
-        m_hashes.reserve(size);
-
-        while (begin != end) {
-            size_t hash_value = Hash<Key>{}(begin->first);
-            this->m_table.emplace_back(begin->first, begin->second);
-            m_hashes.push_back(hash_value);
-            ++begin;
+    void build(It begin, It end, size_t size_hint, bool move_values)
+    {
+        std::vector<std::pair<Key, Value>> entries;
+        entries.reserve(size_hint);
+        for (; begin != end; ++begin)
+        {
+            if (move_values)
+                entries.emplace_back(begin->first, std::move(begin->second));
+            else
+                entries.emplace_back(begin->first, begin->second);
         }
-    }
 
-    void sort_hashtable()
-    {
-        std::vector<size_t> indices(m_hashes.size());
+        if (entries.empty())
+            return;
 
-        for(size_t i = 0; i < indices.size(); i++)
+        std::vector<size_t> slot_to_entry;
+        std::vector<uint32_t> pilots;
+        for (m_seed = 0; !place(entries, slot_to_entry, pilots); ++m_seed)
         {
-            indices[i] = i;
         }
+        m_pilots.assign(std::move(pilots));
 
-        std::sort(indices.begin(), indices.end(), [&](size_t i, size_t j)
-                  { return m_hashes[i] < m_hashes[j]; });
+        // Entries land at their slot, the slots past size() fill the holes below size()
+        const size_t count = m_placed;
+        std::vector<size_t> order(slot_to_entry.begin(), slot_to_entry.begin() + count);
+        std::vector<uint32_t> holes;
+        for (size_t slot = 0; slot < count; ++slot)
+        {
+            if (order[slot] == no_entry)
+                holes.push_back(static_cast<uint32_t>(slot));
+        }
+
+        std::vector<uint32_t> remap(static_cast<size_t>(m_slot_count - count), 0);
+        size_t next_hole = 0;
+        for (size_t slot = count; slot < m_slot_count; ++slot)
+        {
+            if (slot_to_entry[slot] == no_entry)
+                continue;
+            const uint32_t hole = holes[next_hole++];
+            order[hole] = slot_to_entry[slot];
+            remap[slot - count] = hole;
+        }
+        m_remap.assign(std::move(remap));
+
+        order.insert(order.end(), m_duplicates.begin(), m_duplicates.end());
+        std::vector<Key> keys;
+        std::vector<Value> values;
+        keys.reserve(order.size());
+        values.reserve(order.size());
+        for (size_t entry : order)
+        {
+            keys.push_back(std::move(entries[entry].first));
+            values.push_back(std::move(entries[entry].second));
+        }
+        this->m_keys.assign(std::move(keys));
+        this->m_values.assign(std::move(values));
+        m_duplicates.clear();
+        m_duplicates.shrink_to_fit();
+    }
 
-        std::vector<std::pair<Key, Value>> sorted_table(this->m_table.size());
-        std::vector<size_t> sorted_hashes(indices.size());
+    static constexpr size_t no_entry = size_t(-1);
 
-        for (size_t i = 0; i < indices.size(); i++)
+    // Find a pilot per bucket, biggest buckets first, so every key gets a slot of its own
+    // slot_to_entry is sized to every slot and pilots to every bucket on success, false if some bucket ran out of pilots
+    bool place(const std::vector<std::pair<Key, Value>>& entries, std::vector<size_t>& slot_to_entry, std::vector<uint32_t>& pilots)
+    {
+        struct hashed
+        {
+            uint64_t hash;
+            size_t entry;
+        };
+
+        std::vector<hashed> hashes;
+        hashes.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i)
+            hashes.push_back(hashed{ hash_of(entries[i].first), i });
+
+        // Group the hashes by bucket with a counting sort, bucket b holds grouped[bucket_begin[b], bucket_begin[b + 1]).
+        // Equal hashes share a bucket and can not be separated by any pilot : the first is kept, the other keys are stored
+        // after the placed ones and a key seen before is dropped. The bucket count follows the kept hashes,
+        // so when some were set aside the kept ones are grouped again.
+        m_duplicates.clear();
+        std::vector<hashed> grouped;
+        std::vector<uint32_t> bucket_begin;
+        for (;;)
         {
-            sorted_table[i]  = this->m_table[indices[i]];
-            sorted_hashes[i] = m_hashes[indices[i]];
+            m_bucket_count = mph::bucket_count(hashes.size());
+            group_by_bucket(hashes, grouped, bucket_begin);
+
+            size_t unique = 0;
+            for (size_t b = 0; b < static_cast<size_t>(m_bucket_count); ++b)
+            {
+                const size_t first = bucket_begin[b];
+                const size_t last = bucket_begin[b + 1];
+                std::sort(grouped.begin() + first, grouped.begin() + last,
+                          [](const hashed& a, const hashed& c) { return a.hash < c.hash || (a.hash == c.hash && a.entry < c.entry); });
+
+                size_t run_duplicates = m_duplicates.size(); // keys already set aside for the current hash
+                for (size_t i = first; i < last; ++i)
+                {
+                    if (i == first || grouped[i - 1].hash != grouped[i].hash)
+                    {
+                        hashes[unique++] = grouped[i];
+                        run_duplicates = m_duplicates.size();
+                        continue;
+                    }
+
+                    const Key& key = entries[grouped[i].entry].first;
+                    bool seen = KeyEqual{}(entries[hashes[unique - 1].entry].first, key);
+                    for (size_t j = run_duplicates; j < m_duplicates.size() && !seen; ++j)
+                        seen = KeyEqual{}(entries[m_duplicates[j]].first, key);
+                    if (!seen)
+                        m_duplicates.push_back(grouped[i].entry);
+                }
+            }
+
+            if (unique == hashes.size())
+                break;
+            hashes.resize(unique);
         }
+        hashes.clear();
+        hashes.shrink_to_fit();
+
+        const size_t count = grouped.size();
+        m_placed = count;
+        m_slot_count = std::max<uint64_t>(count, static_cast<uint64_t>(static_cast<double>(count) / mph::slot_load) + 1);
+        pilots.assign(static_cast<size_t>(m_bucket_count), 0);
+
+        // Visit the buckets from the largest down (counting sort on the size), empty buckets keep pilot 0
+        const size_t bucket_total = static_cast<size_t>(m_bucket_count);
+        size_t largest = 0;
+        for (size_t b = 0; b < bucket_total; ++b)
+            largest = std::max<size_t>(largest, bucket_begin[b + 1] - bucket_begin[b]);
+
+        std::vector<uint32_t> size_begin(largest + 2, 0);
+        for (size_t b = 0; b < bucket_total; ++b)
+            ++size_begin[largest - (bucket_begin[b + 1] - bucket_begin[b]) + 1];
+        for (size_t i = 0; i + 1 < size_begin.size(); ++i)
+            size_begin[i + 1] += size_begin[i];
+
+        std::vector<uint32_t> order(bucket_total);
+        for (size_t b = 0; b < bucket_total; ++b)
+            order[size_begin[largest - (bucket_begin[b + 1] - bucket_begin[b])]++] = static_cast<uint32_t>(b);
+
+        // One bit per slot while searching, 1/64 of the memory of slot_to_entry and it stays in cache
+        std::vector<uint64_t> taken(static_cast<size_t>((m_slot_count + 63) / 64), 0);
+        auto is_taken = [&taken](uint64_t slot) { return ((taken[static_cast<size_t>(slot >> 6)] >> (slot & 63)) & 1) != 0; };
+
+        slot_to_entry.assign(static_cast<size_t>(m_slot_count), no_entry);
+        std::vector<uint64_t> slots(largest);
+        for (const uint32_t bucket_index : order)
+        {
+            const size_t first = bucket_begin[bucket_index];
+            const size_t size = bucket_begin[bucket_index + 1] - first;
+            if (size == 0)
+                break;
+
+            uint64_t pilot = 0;
+            for (;; ++pilot)
+            {
+                if (pilot == mph::max_pilot)
+                    return false;
+
+                // slot_of() with the pilot mixed once for the whole bucket
+                const uint64_t pilot_hash = mph::mix(pilot + m_seed);
+                size_t fitted = 0;
+                for (; fitted < size; ++fitted)
+                {
+                    const uint64_t slot = mph::reduce(mph::mix(grouped[first + fitted].hash ^ pilot_hash), m_slot_count);
+                    if (is_taken(slot) || std::find(slots.begin(), slots.begin() + fitted, slot) != slots.begin() + fitted)
+                        break;
+                    slots[fitted] = slot;
+                }
+                if (fitted == size)
+                    break;
+            }
 
-        this->m_table = std::move(sorted_table);
-        m_hashes = std::move(sorted_hashes);
+            pilots[bucket_index] = static_cast<uint32_t>(pilot);
+            for (size_t i = 0; i < size; ++i)
+            {
+                taken[static_cast<size_t>(slots[i] >> 6)] |= uint64_t(1) << (slots[i] & 63);
+                slot_to_entry[static_cast<size_t>(slots[i])] = grouped[first + i].entry;
+            }
+        }
+        return true;
     }
 
-    bool is_tree_table() const override final { return false; }
+    template <typename Hashed>
+    void group_by_bucket(const std::vector<Hashed>& hashes, std::vector<Hashed>& grouped, std::vector<uint32_t>& bucket_begin) const
+    {
+        const size_t bucket_total = static_cast<size_t>(m_bucket_count);
+        bucket_begin.assign(bucket_total + 1, 0);
+        for (const Hashed& h : hashes)
+            ++bucket_begin[bucket_of(h.hash) + 1];
+        for (size_t b = 0; b < bucket_total; ++b)
+            bucket_begin[b + 1] += bucket_begin[b];
+
+        grouped.resize(hashes.size());
+        std::vector<uint32_t> cursor(bucket_begin.begin(), bucket_begin.end() - 1);
+        for (const Hashed& h : hashes)
+            grouped[cursor[bucket_of(h.hash)]++] = h;
+    }
 
-    bool is_hash_table() const override final { return true;  }
+    std::vector<size_t> m_duplicates; // only used while building
 };
 
 // Tree-based lookup table
+// Keys sorted, then stored in Eytzinger order : node k has its children at 2k and 2k + 1, index 0 is unused.
+// A search is log2(size()) steps without a branch on the outcome, the line holding the node 4 levels below is prefetched at each step.
 template <typename Key, typename Value, typename Compare = std::less<Key> , typename Allocator = std::allocator<std::pair<const Key, Value>>>
 class lookup_treetable : public base_lookup_table<Key, Value>
 {
 public:
     explicit lookup_treetable(const std::map<Key, Value, Compare, Allocator>& data)
     {
-        this->m_table.reserve(data.size());
-        for (const auto &entry : data)
-        {
-            this->m_table.emplace_back(entry.first, entry.second);
-        }
+        build(data.begin(), data.end(), data.size(), false, true);
     }
 
     explicit lookup_treetable(std::map<Key, Value, Compare, Allocator>&& data)
     {
-        this->m_table.reserve(data.size());
-        for (auto &entry : data)
-        {
-            this->m_table.emplace_back(std::move(entry.first), std::move(entry.second));
-        }
+        build(data.begin(), data.end(), data.size(), true, true);
     }
 
     template <typename It>
-    explicit lookup_treetable(It Begin, It End, 
-        typename std::enable_if<
-            std::is_same<typename std::iterator_traits<It>::value_type, 
-                         typename std::map<Key, Value>::value_type>::value, 
-            int>::type = 0, uint32_t size = 0)
-    {
-        this->m_table.reserve(size);
-        while (Begin != End) {
-            this->m_table.emplace_back(Begin->first, Begin->second);
-            ++Begin;
+    explicit lookup_treetable(It Begin, It End, uint32_t size = 0)
+    {
+        build(Begin, End, size, false, false);
+    }
+
+    // The table of a snapshot file, its arrays point into the mapping
+    explicit lookup_treetable(std::shared_ptr<const snapshot_file> file)
+    {
+        this->map_snapshot(std::move(file));
+        m_full_levels = full_levels(this->m_keys.size());
+
+        // The first levels are in order only under the Compare the table was built with
+        const size_t n = this->m_keys.size();
+        for (size_t k = 1; k <= std::min<size_t>(n, 64); ++k)
+        {
+            if ((2 * k <= n && !Compare{}(*node(2 * k), *node(k))) || (2 * k + 1 <= n && !Compare{}(*node(k), *node(2 * k + 1))))
+                throw std::runtime_error("lookup_table : tree table snapshot built with another ordering");
         }
     }
 
     Value* lookup(const Key& key) const override
     {
-        auto it = std::lower_bound(this->m_table.begin(), this->m_table.end(), key,
-                                   [](const std::pair<Key, Value>& element, const Key &value)
-                                   {
-                                       return element.first < value;
-                                   });
-
-        if (it != this->m_table.end() && it->first == key)
+        const size_t n = this->m_keys.size();
+        size_t k = 1;
+        while (k <= n)
         {
-            return &it->second;
+            lookup_prefetch(node(k * prefetch_stride));
+            k = 2 * k + (Compare{}(*node(k), key) ? 1 : 0);
         }
+        return found(k, key);
+    }
 
-        return nullptr;
+    // The batch walks down the tree level by level, every key of it one step per level
+    void lookup_many(const Key* keys, size_t count, Value** results) const override
+    {
+        const size_t n = this->m_keys.size();
+        size_t k[lookup_batch];
+        for (size_t first = 0; first < count; first += lookup_batch)
+        {
+            const size_t batch = std::min(lookup_batch, count - first);
+            std::fill(k, k + batch, size_t(1));
+
+            // Every level above the last one is full, each key takes exactly full_levels steps there
+            for (size_t level = 0; level < m_full_levels; ++level)
+            {
+                for (size_t i = 0; i < batch; ++i)
+                {
+                    lookup_prefetch(node(k[i] * prefetch_stride));
+                    k[i] = 2 * k[i] + (Compare{}(*node(k[i]), keys[first + i]) ? 1 : 0);
+                }
+            }
+
+            for (size_t i = 0; i < batch; ++i)
+            {
+                if (k[i] <= n)
+                    k[i] = 2 * k[i] + (Compare{}(*node(k[i]), keys[first + i]) ? 1 : 0);
+                results[first + i] = found(k[i], keys[first + i]);
+            }
+        }
     }
 
     std::shared_ptr<base_lookup_table<Key, Value>> clone() const override
     {
-        return std::make_shared<lookup_treetable<Key, Value>>(*this);
+        return std::make_shared<lookup_treetable<Key, Value, Compare, Allocator>>(*this);
+    }
+
+    void save(const char* path) const override
+    {
+        snapshot_header header = {};
+        header.layout = snapshot_tree;
+
+        const void* data[section_count] = {};
+        this->save_snapshot(path, header, data);
     }
 
     bool is_tree_table() const override final { return true; }
 
     bool is_hash_table() const override final { return false;  }
 
+private:
+    // Nodes in one cache line, k * prefetch_stride is the first node 4 levels below k for 4-byte keys
+    static constexpr size_t prefetch_stride = sizeof(Key) < 64 ? 64 / sizeof(Key) : 1;
+
+    // Eytzinger index k (1 based) to the key at k - 1, only dereferenced for k <= size()
+    const Key* node(size_t k) const
+    {
+        return this->m_keys.data() + (k - 1);
+    }
+
+    // The walk went right after every node smaller than key, undo the trailing right turns and
+    // the last left turn to get the lower bound of key, then check it is key itself
+    Value* found(size_t k, const Key& key) const
+    {
+        k >>= trailing_ones(k) + 1;
+        if (k == 0 || Compare{}(key, *node(k)))
+            return nullptr;
+        return &this->m_values[k - 1];
+    }
+
+    static unsigned trailing_ones(size_t k)
+    {
+        unsigned bits = 0;
+        while (k & 1)
+        {
+            k >>= 1;
+            ++bits;
+        }
+        return bits;
+    }
+
+    template <typename It>
+    void build(It begin, It end, size_t size_hint, bool move_values, bool sorted)
+    {
+        std::vector<std::pair<Key, Value>> entries;
+        entries.reserve(size_hint);
+        for (; begin != end; ++begin)
+        {
+            if (move_values)
+                entries.emplace_back(begin->first, std::move(begin->second));
+            else
+                entries.emplace_back(begin->first, begin->second);
+        }
+
+        if (!sorted)
+        {
+            // Keep the first of equal keys
+            auto less = [](const std::pair<Key, Value>& a, const std::pair<Key, Value>& b) { return Compare{}(a.first, b.first); };
+            std::stable_sort(entries.begin(), entries.end(), less);
+            entries.erase(std::unique(entries.begin(), entries.end(), [](const std::pair<Key, Value>& a, const std::pair<Key, Value>& b)
+                                      { return !Compare{}(a.first, b.first) && !Compare{}(b.first, a.first); }),
+                          entries.end());
+        }
+
+        // In-order walk of the implicit tree hands out the sorted entries
+        const size_t n = entries.size();
+        std::vector<size_t> order(n);
+        size_t next = 0;
+        fill_in_order(order, 1, next);
+
+        std::vector<Key> keys;
+        std::vector<Value> values;
+        keys.reserve(n);
+        values.reserve(n);
+        for (size_t entry : order)
+        {
+            keys.push_back(std::move(entries[entry].first));
+            values.push_back(std::move(entries[entry].second));
+        }
+        this->m_keys.assign(std::move(keys));
+        this->m_values.assign(std::move(values));
+        m_full_levels = full_levels(n);
+    }
+
+    static size_t full_levels(size_t n)
+    {
+        size_t levels = 0;
+        while ((size_t(2) << levels) - 1 <= n)
+            ++levels;
+        return levels;
+    }
+
+    // order[k - 1] = index of the sorted entry stored at node k
+    void fill_in_order(std::vector<size_t>& order, size_t k, size_t& next)
+    {
+        // Iterative in-order walk, the tree is up to 64 levels deep
+        std::vector<size_t> stack;
+        while (k <= order.size() || !stack.empty())
+        {
+            while (k <= order.size())
+            {
+                stack.push_back(k);
+                k = 2 * k;
+            }
+            k = stack.back();
+            stack.pop_back();
+            order[k - 1] = next++;
+            k = 2 * k + 1;
+        }
+    }
+
+    size_t m_full_levels = 0; // levels of the tree with every node present
 };
 } // namespace gp_private
 
 
 /// @class lookup_table
-/// @tparam Key 
-/// @tparam Value 
+/// @tparam Key
+/// @tparam Value
 /// @brief A lookup table is a read-only data structure that maps keys to values.
 /// @brief The lookup table is optimized for read-only use cases and provides fast lookups.
 /// @brief The lookup table can be created from a std::map or std::unordered_map.
@@ -339,13 +1099,15 @@ class lookup_table
 protected:
     std::shared_ptr<gp_private::base_lookup_table<Key, Value>> m_table;
 
+    explicit lookup_table(std::shared_ptr<gp_private::base_lookup_table<Key, Value>> table) : m_table(std::move(table)) {}
+
 public:
-    
+    using iterator = typename gp_private::base_lookup_table<Key, Value>::iterator;
+
     template <typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
     explicit lookup_table(const std::unordered_map<Key, Value, Hash, KeyEqual, Allocator>& data)
     {
         m_table = std::make_shared<gp_private::lookup_hashtable<Key, Value, Hash, KeyEqual, Allocator>>(data);
-        m_table_type = 
     }
 
     template <typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
@@ -354,43 +1116,66 @@ public:
         m_table = std::make_shared<gp_private::lookup_hashtable<Key, Value, Hash, KeyEqual, Allocator>>(std::move(data));
     }
 
+    // A hash table over the (key, value) pairs of [Begin, End), the first of equal keys wins
     template <typename It>
-    explicit lookup_table(It Begin, It End, 
-        typename std::enable_if<
-            std::is_same<typename std::iterator_traits<It>::value_type, 
-                         typename std::unordered_map<Key, Value>::value_type>::value, 
-            int>::type = 0, uint32_t size = 0)
+    explicit lookup_table(It Begin, It End, uint32_t size = 0)
     {
         m_table = std::make_shared<gp_private::lookup_hashtable<Key, Value>>(Begin, End, size);
     }
-    
+
     template <typename Compare = std::less<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
     explicit lookup_table(const std::map<Key, Value, Compare, Allocator>& data)
     {
-        m_table = std::make_shared<gp_private::lookup_treetable<Key, Value>>(data);
+        m_table = std::make_shared<gp_private::lookup_treetable<Key, Value, Compare, Allocator>>(data);
     }
 
     template <typename Compare = std::less<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
     explicit lookup_table(std::map<Key, Value, Compare, Allocator>&& data)
     {
-        m_table = std::make_shared<gp_private::lookup_treetable<Key, Value>>(std::move(data));
+        m_table = std::make_shared<gp_private::lookup_treetable<Key, Value, Compare, Allocator>>(std::move(data));
     }
 
-    template <typename Compare = std::less<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>, typename It>
-    explicit lookup_table(It Begin, It End, 
-        typename std::enable_if<
-            std::is_same<typename std::iterator_traits<It>::value_type, 
-                         typename std::map<Key, Value>::value_type>::value, 
-            int>::type = 0, uint32_t size = 0)
+    // A tree table over the (key, value) pairs of [Begin, End), in any order, the first of equal keys wins
+    template <typename It>
+    explicit lookup_table(lookup_ordered_t, It Begin, It End, uint32_t size = 0)
     {
         m_table = std::make_shared<gp_private::lookup_treetable<Key, Value>>(Begin, End, size);
     }
 
+    ///@brief Map a table written by save(), its keys and values are used in place from the file
+    /// @note  Hash (or Compare for a tree table) must be the one the table was saved with, which is checked on a few keys.
+    ///        Values written through the table stay private to this process and are shared by its clones.
+    template <typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, typename Compare = std::less<Key>>
+    static lookup_table open(const char* path)
+    {
+        static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value,
+                      "lookup_table : only tables of trivially copyable keys and values can be mapped");
+
+        std::shared_ptr<const gp_private::snapshot_file> file = std::make_shared<const gp_private::snapshot_file>(
+            path, static_cast<uint32_t>(sizeof(Key)), static_cast<uint32_t>(alignof(Key)), static_cast<uint32_t>(sizeof(Value)), static_cast<uint32_t>(alignof(Value)));
+
+        if (file->header().layout == gp_private::snapshot_hash)
+            return lookup_table(std::make_shared<gp_private::lookup_hashtable<Key, Value, Hash, KeyEqual>>(std::move(file)));
+        return lookup_table(std::make_shared<gp_private::lookup_treetable<Key, Value, Compare>>(std::move(file)));
+    }
+
+    ///@brief Write the table to path for open(), throws std::runtime_error on failure
+    void save(const char* path) const
+    {
+        m_table->save(path);
+    }
+
     Value* lookup(const Key& key) const
     {
         return m_table->lookup(key);
     }
 
+    ///@brief results[i] = lookup(keys[i]) for every i < count, faster than one lookup at a time
+    void lookup_many(const Key* keys, size_t count, Value** results) const
+    {
+        m_table->lookup_many(keys, count, results);
+    }
+
     Value* operator[](const Key& key) const
     {
         Value* value = lookup(key);
@@ -399,10 +1184,10 @@ public:
         return nullptr;
     }
 
-    std::pair<const Key&, Value&>* begin() 
+    iterator begin() const
     { return m_table->begin(); }
 
-    std::pair<const Key&, Value&>* end() 
+    iterator end() const
     { return m_table->end();   }
 
     std::shared_ptr<gp_private::base_lookup_table<Key, Value>> clone() const
@@ -446,4 +1231,4 @@ public:
     }
 };
 } // namespace gp_std
-#endif 
+#endif
@@ -0,0 +1,216 @@
+#ifndef _GP_STD_OPTIONAL_HPP_
+#define _GP_STD_OPTIONAL_HPP_
+
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// A value that may be missing, returned by the lookups of hash_map_128_t
+// optional<T&> holds a reference (a pointer under the hood), which std::optional does not allow.
+//
+// Usage :
+// gp_std::optional<Order&> order = orders.get(id);
+// if (order) order.value().filled = true;
+//
+// gp_std::optional<Quote> quote = quotes.load(id);
+// double bid = quote ? quote->bid : 0.0;
+
+namespace gp_std
+{
+    ///@brief Tag of an empty optional
+    struct nullopt_t
+    {
+        constexpr nullopt_t() {}
+    };
+
+    static constexpr nullopt_t nullopt{};
+
+    /// @class optional
+    /// @brief Storage for one T constructed in place, or nothing
+    /// @tparam T The type of the value
+    template <typename T>
+    class optional
+    {
+    public:
+        using value_type = T;
+
+        optional() noexcept : m_engaged(false) {}
+        optional(nullopt_t) noexcept : m_engaged(false) {}
+
+        optional(const T& value) : m_engaged(false) { construct(value); }
+        optional(T&& value) : m_engaged(false) { construct(std::move(value)); }
+
+        optional(const optional& other) : m_engaged(false)
+        {
+            if (other.m_engaged)
+                construct(*other);
+        }
+
+        optional(optional&& other) noexcept(std::is_nothrow_move_constructible<T>::value) : m_engaged(false)
+        {
+            if (other.m_engaged)
+                construct(std::move(*other));
+        }
+
+       ~optional() { reset(); }
+
+        optional& operator=(nullopt_t) noexcept
+        {
+            reset();
+            return *this;
+        }
+
+        optional& operator=(const optional& other)
+        {
+            if (this == &other)
+                return *this;
+
+            if (other.m_engaged)
+                assign(*other);
+            else
+                reset();
+            return *this;
+        }
+
+        optional& operator=(optional&& other) noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value)
+        {
+            if (this == &other)
+                return *this;
+
+            if (other.m_engaged)
+                assign(std::move(*other));
+            else
+                reset();
+            return *this;
+        }
+
+        optional& operator=(const T& value)
+        {
+            assign(value);
+            return *this;
+        }
+
+        optional& operator=(T&& value)
+        {
+            assign(std::move(value));
+            return *this;
+        }
+
+        ///@brief Destroy the current value if any and build a new one from args
+        template <typename... Args>
+        T& emplace(Args&&... args)
+        {
+            reset();
+            construct(std::forward<Args>(args)...);
+            return **this;
+        }
+
+        void reset() noexcept
+        {
+            if (m_engaged)
+            {
+                pointer()->~T();
+                m_engaged = false;
+            }
+        }
+
+        bool has_value() const noexcept { return m_engaged; }
+        explicit operator bool() const noexcept { return m_engaged; }
+
+        T& value()
+        {
+            if (!m_engaged)
+                throw std::runtime_error("optional has no value\n");
+            return **this;
+        }
+
+        const T& value() const
+        {
+            if (!m_engaged)
+                throw std::runtime_error("optional has no value\n");
+            return **this;
+        }
+
+        template <typename U>
+        T value_or(U&& fallback) const
+        {
+            return m_engaged ? **this : static_cast<T>(std::forward<U>(fallback));
+        }
+
+        T& operator*() { return *pointer(); }
+        const T& operator*() const { return *pointer(); }
+
+        T* operator->() { return pointer(); }
+        const T* operator->() const { return pointer(); }
+
+    private:
+        template <typename... Args>
+        void construct(Args&&... args)
+        {
+            ::new (static_cast<void*>(m_storage)) T(std::forward<Args>(args)...);
+            m_engaged = true;
+        }
+
+        template <typename U>
+        void assign(U&& value)
+        {
+            if (m_engaged)
+                **this = std::forward<U>(value);
+            else
+                construct(std::forward<U>(value));
+        }
+
+        T* pointer() { return std::launder(reinterpret_cast<T*>(m_storage)); }
+        const T* pointer() const { return std::launder(reinterpret_cast<const T*>(m_storage)); }
+
+        alignas(T) unsigned char m_storage[sizeof(T)];
+        bool m_engaged;
+    };
+
+    /// @class optional<T&>
+    /// @brief A reference to an element owned elsewhere, or nothing
+    /// @note  Assigning a reference rebinds the optional, it never writes through to the old element
+    template <typename T>
+    class optional<T&>
+    {
+    public:
+        using value_type = T&;
+
+        optional() noexcept : m_ptr(nullptr) {}
+        optional(nullopt_t) noexcept : m_ptr(nullptr) {}
+        optional(T& value) noexcept : m_ptr(&value) {}
+
+        optional(const optional&) = default;
+        optional& operator=(const optional&) = default;
+
+        optional& operator=(nullopt_t) noexcept
+        {
+            m_ptr = nullptr;
+            return *this;
+        }
+
+        void reset() noexcept { m_ptr = nullptr; }
+
+        bool has_value() const noexcept { return m_ptr != nullptr; }
+        explicit operator bool() const noexcept { return m_ptr != nullptr; }
+
+        T& value() const
+        {
+            if (m_ptr == nullptr)
+                throw std::runtime_error("optional has no value\n");
+            return *m_ptr;
+        }
+
+        template <typename U>
+        T& value_or(U& fallback) const { return m_ptr != nullptr ? *m_ptr : fallback; }
+
+        T& operator*() const { return *m_ptr; }
+        T* operator->() const { return m_ptr; }
+
+    private:
+        T* m_ptr;
+    };
+} // namespace gp_std
+
+#endif
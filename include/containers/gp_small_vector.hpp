@@ -0,0 +1,604 @@
+#ifndef _GP_STD_SMALL_VECTOR_HPP_
+#define _GP_STD_SMALL_VECTOR_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// A vector keeping its first N elements inline, in the same storage as fixed_vector, and spilling to the heap past that
+// Short lists never allocate, long ones grow geometrically like std::vector and keep their buffer until shrink_to_fit.
+// Trivially copyable T are relocated, copied and shifted with memcpy / memmove, bulk insert / append / assign included.
+// The heap side comes from Allocator, so an arena plugs in as any std allocator (std::pmr::polymorphic_allocator works as is).
+//
+// Usage :
+// gp_std::small_vector<order_id, 16> scratch;
+// scratch.append(ids, ids + count);           // one memcpy, inline while count <= 16
+// scratch.insert(scratch.begin(), first_id);
+//
+// std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+// gp_std::small_vector<order_id, 16, std::pmr::polymorphic_allocator<order_id>> spilled(&arena);
+
+namespace gp_std
+{
+    /// @class small_vector
+    /// @brief Contiguous sequence with room for N elements inside the object, the heap from Allocator beyond
+    /// @tparam T The type of the elements
+    /// @tparam N Elements stored inline before the first allocation
+    /// @tparam Allocator Std allocator for the spilled buffer, never propagated on copy assignment
+    /// @note  Iterators and references are invalidated by any growth, as for std::vector, and by moving an inline small_vector
+    template <typename T, std::size_t N, typename Allocator = std::allocator<T>>
+    class small_vector
+    {
+        static_assert(N > 0, "small_vector : N must be at least 1, use std::vector for no inline storage");
+
+        using allocator_traits = std::allocator_traits<Allocator>;
+
+        // Relocation by memcpy, the same test inplace_function uses for its function objects
+        static constexpr bool trivial = std::is_trivially_copyable<T>::value;
+
+        template <typename It>
+        using if_iterator = typename std::enable_if<std::is_convertible<typename std::iterator_traits<It>::iterator_category, std::input_iterator_tag>::value>::type;
+
+    public:
+        using value_type = T;
+        using allocator_type = Allocator;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        small_vector() noexcept(std::is_nothrow_default_constructible<Allocator>::value)
+            : m_data(inline_data()), m_size(0), m_capacity(N), m_allocator() {}
+
+        explicit small_vector(const Allocator& allocator) noexcept
+            : m_data(inline_data()), m_size(0), m_capacity(N), m_allocator(allocator) {}
+
+        explicit small_vector(size_type count, const Allocator& allocator = Allocator()) : small_vector(allocator)
+        {
+            resize(count);
+        }
+
+        small_vector(size_type count, const T& value, const Allocator& allocator = Allocator()) : small_vector(allocator)
+        {
+            assign(count, value);
+        }
+
+        template <typename It, typename = if_iterator<It>>
+        small_vector(It first, It last, const Allocator& allocator = Allocator()) : small_vector(allocator)
+        {
+            append(first, last);
+        }
+
+        small_vector(std::initializer_list<T> init, const Allocator& allocator = Allocator()) : small_vector(allocator)
+        {
+            append(init.begin(), init.end());
+        }
+
+        small_vector(const small_vector& other)
+            : small_vector(allocator_traits::select_on_container_copy_construction(other.m_allocator))
+        {
+            append(other.begin(), other.end());
+        }
+
+        // A spilled other hands over its buffer, an inline one its elements
+        small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+            : m_data(inline_data()), m_size(0), m_capacity(N), m_allocator(std::move(other.m_allocator))
+        {
+            if (other.is_inline())
+            {
+                relocate(other.m_data, other.m_size, m_data);
+                m_size = other.m_size;
+                other.m_size = 0;
+            }
+            else
+            {
+                steal(other);
+            }
+        }
+
+       ~small_vector()
+        {
+            destroy(m_data, m_size);
+            release_heap();
+        }
+
+        small_vector& operator=(const small_vector& other)
+        {
+            if (this != &other)
+                assign(other.begin(), other.end());
+            return *this;
+        }
+
+        small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value &&
+            (allocator_traits::propagate_on_container_move_assignment::value || allocator_traits::is_always_equal::value))
+        {
+            if (this == &other)
+                return *this;
+
+            clear();
+            bool can_steal = !other.is_inline();
+            if constexpr (allocator_traits::propagate_on_container_move_assignment::value)
+            {
+                release_heap();
+                m_allocator = std::move(other.m_allocator);
+            }
+            else if (can_steal && m_allocator == other.m_allocator)
+            {
+                release_heap();
+            }
+            else
+            {
+                can_steal = false;
+            }
+
+            if (can_steal)
+            {
+                steal(other);
+            }
+            else
+            {
+                // Inline elements, or a buffer of an allocator we can not free with
+                reserve(other.m_size);
+                relocate(other.m_data, other.m_size, m_data);
+                m_size = other.m_size;
+                other.m_size = 0;
+            }
+            return *this;
+        }
+
+        small_vector& operator=(std::initializer_list<T> init)
+        {
+            assign(init);
+            return *this;
+        }
+
+        // Capacity
+        size_type size() const noexcept { return m_size; }
+        size_type capacity() const noexcept { return m_capacity; }
+        bool empty() const noexcept { return m_size == 0; }
+        static constexpr size_type inline_capacity() noexcept { return N; }
+        size_type max_size() const noexcept { return allocator_traits::max_size(m_allocator); }
+
+        // True while the elements live inside the object
+        bool is_inline() const noexcept { return m_data == inline_data(); }
+
+        allocator_type get_allocator() const noexcept { return m_allocator; }
+
+        // Room for new_capacity elements, exactly, without changing the size
+        void reserve(size_type new_capacity)
+        {
+            if (new_capacity > m_capacity)
+                reallocate(new_capacity);
+        }
+
+        // Back inline when the elements fit, else a heap buffer of the exact size
+        void shrink_to_fit()
+        {
+            if (is_inline() || m_size == m_capacity)
+                return;
+
+            if (m_size <= N)
+            {
+                T* heap = m_data;
+                const size_type heap_capacity = m_capacity;
+                relocate(heap, m_size, inline_data());
+                allocator_traits::deallocate(m_allocator, heap, heap_capacity);
+                m_data = inline_data();
+                m_capacity = N;
+            }
+            else
+            {
+                reallocate(m_size);
+            }
+        }
+
+        // Element access
+        reference operator[](size_type index) noexcept { return m_data[index]; }
+        const_reference operator[](size_type index) const noexcept { return m_data[index]; }
+
+        reference at(size_type index)
+        {
+            if (index >= m_size) throw std::out_of_range("small_vector : index out of range");
+            return m_data[index];
+        }
+
+        const_reference at(size_type index) const
+        {
+            if (index >= m_size) throw std::out_of_range("small_vector : index out of range");
+            return m_data[index];
+        }
+
+        reference front() { return at(0); }
+        const_reference front() const { return at(0); }
+        reference back() { return at(m_size - 1); }
+        const_reference back() const { return at(m_size - 1); }
+
+        pointer data() noexcept { return m_data; }
+        const_pointer data() const noexcept { return m_data; }
+
+        // Iterators
+        iterator begin() noexcept { return m_data; }
+        const_iterator begin() const noexcept { return m_data; }
+        const_iterator cbegin() const noexcept { return m_data; }
+        iterator end() noexcept { return m_data + m_size; }
+        const_iterator end() const noexcept { return m_data + m_size; }
+        const_iterator cend() const noexcept { return m_data + m_size; }
+
+        // Modifiers
+        void push_back(const T& value) { emplace_back(value); }
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        // args may refer to an element of this vector, it is read before the old buffer goes
+        template <typename... Args>
+        reference emplace_back(Args&&... args)
+        {
+            if (m_size == m_capacity)
+                return grow_and_emplace_back(std::forward<Args>(args)...);
+
+            T* slot = ::new (static_cast<void*>(m_data + m_size)) T(std::forward<Args>(args)...);
+            ++m_size;
+            return *slot;
+        }
+
+        void pop_back()
+        {
+            if (m_size == 0) throw std::underflow_error("small_vector : pop_back on an empty vector");
+            m_data[--m_size].~T();
+        }
+
+        iterator insert(const_iterator pos, const T& value) { return insert(pos, size_type(1), value); }
+
+        iterator insert(const_iterator pos, T&& value)
+        {
+            const size_type index = index_of(pos);
+            if constexpr (trivial)
+            {
+                const T moved(value); // value may live in the part shifted by the gap
+                T* gap = open_gap(index, 1);
+                ::new (static_cast<void*>(gap)) T(moved);
+                return gap;
+            }
+            emplace_back(std::move(value));
+            if (index == m_size - 1)
+                return m_data + index;
+            std::rotate(m_data + index, m_data + m_size - 1, m_data + m_size);
+            return m_data + index;
+        }
+
+        // count copies of value before pos
+        iterator insert(const_iterator pos, size_type count, const T& value)
+        {
+            const size_type index = index_of(pos);
+            if (count == 0)
+                return m_data + index;
+
+            const T copy(value); // value may live in this vector
+            if constexpr (trivial)
+            {
+                T* gap = open_gap(index, count);
+                for (size_type i = 0; i < count; ++i)
+                    ::new (static_cast<void*>(gap + i)) T(copy);
+                return gap;
+            }
+
+            const size_type old_size = m_size;
+            grow_for(count);
+            for (size_type i = 0; i < count; ++i)
+                emplace_back(copy);
+            std::rotate(m_data + index, m_data + old_size, m_data + m_size);
+            return m_data + index;
+        }
+
+        // The elements of [first, last) before pos, the range must not come from this vector
+        template <typename It, typename = if_iterator<It>>
+        iterator insert(const_iterator pos, It first, It last)
+        {
+            using category = typename std::iterator_traits<It>::iterator_category;
+            return insert_range(index_of(pos), first, last, category());
+        }
+
+        iterator insert(const_iterator pos, std::initializer_list<T> init)
+        {
+            return insert(pos, init.begin(), init.end());
+        }
+
+        // The elements of [first, last) at the end, the range must not come from this vector
+        template <typename It, typename = if_iterator<It>>
+        void append(It first, It last)
+        {
+            insert(end(), first, last);
+        }
+
+        void append(std::initializer_list<T> init) { insert(end(), init.begin(), init.end()); }
+
+        // Replace the content by the elements of [first, last), the range must not come from this vector
+        template <typename It, typename = if_iterator<It>>
+        void assign(It first, It last)
+        {
+            clear();
+            insert(end(), first, last);
+        }
+
+        void assign(size_type count, const T& value)
+        {
+            const T copy(value);
+            clear();
+            insert(end(), count, copy);
+        }
+
+        void assign(std::initializer_list<T> init) { assign(init.begin(), init.end()); }
+
+        // Grow with value initialized elements (zeroes for arithmetic T) or shrink to new_size
+        void resize(size_type new_size)
+        {
+            if (new_size <= m_size)
+            {
+                truncate(new_size);
+                return;
+            }
+            grow_for(new_size - m_size);
+            for (; m_size < new_size; ++m_size)
+                ::new (static_cast<void*>(m_data + m_size)) T();
+        }
+
+        void resize(size_type new_size, const T& value)
+        {
+            if (new_size <= m_size)
+                truncate(new_size);
+            else
+                insert(end(), new_size - m_size, value);
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            if (pos < begin() || pos >= end()) throw std::out_of_range("small_vector : erase out of range");
+            return erase(pos, pos + 1);
+        }
+
+        // Remove the elements in [first, last), the ones after shift down
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            if (first < begin() || last > end() || first > last) throw std::out_of_range("small_vector : erase out of range");
+
+            T* const from = m_data + (first - m_data);
+            T* const to = m_data + (last - m_data);
+            if (from == to)
+                return from; // moving the tail onto itself would self move assign
+            if constexpr (trivial)
+            {
+                std::memmove(static_cast<void*>(from), to, static_cast<size_type>(end() - to) * sizeof(T));
+                m_size -= static_cast<size_type>(to - from);
+            }
+            else
+            {
+                truncate(static_cast<size_type>(std::move(to, end(), from) - m_data));
+            }
+            return from;
+        }
+
+        // Destroys the elements, the capacity stays
+        void clear() noexcept
+        {
+            destroy(m_data, m_size);
+            m_size = 0;
+        }
+
+        bool operator==(const small_vector& other) const
+        {
+            return m_size == other.m_size && std::equal(begin(), end(), other.begin());
+        }
+
+        bool operator!=(const small_vector& other) const { return !(*this == other); }
+
+    private:
+        T* inline_data() noexcept { return reinterpret_cast<T*>(&m_inline[0]); }
+        const T* inline_data() const noexcept { return reinterpret_cast<const T*>(&m_inline[0]); }
+
+        size_type index_of(const_iterator pos) const noexcept { return static_cast<size_type>(pos - m_data); }
+
+        static void destroy(T* first, size_type count) noexcept
+        {
+            if (!std::is_trivially_destructible<T>::value)
+                for (size_type i = 0; i < count; ++i)
+                    first[i].~T();
+        }
+
+        // Move count elements from src to the raw storage at dest and end their lifetime in src
+        // T that may throw on move are copied, so a throw leaves src as it was
+        static void relocate(T* src, size_type count, T* dest)
+        {
+            if constexpr (trivial)
+            {
+                if (count != 0)
+                    std::memcpy(static_cast<void*>(dest), src, count * sizeof(T));
+                return;
+            }
+
+            size_type built = 0;
+            try
+            {
+                for (; built < count; ++built)
+                    ::new (static_cast<void*>(dest + built)) T(std::move_if_noexcept(src[built]));
+            }
+            catch (...)
+            {
+                destroy(dest, built);
+                throw;
+            }
+            destroy(src, count);
+        }
+
+        void truncate(size_type new_size) noexcept
+        {
+            destroy(m_data + new_size, m_size - new_size);
+            m_size = new_size;
+        }
+
+        // Heap buffer back to the allocator, the vector is inline and empty after
+        void release_heap() noexcept
+        {
+            if (!is_inline())
+                allocator_traits::deallocate(m_allocator, m_data, m_capacity);
+            m_data = inline_data();
+            m_capacity = N;
+        }
+
+        // Take the heap buffer of other, this is inline and empty
+        void steal(small_vector& other) noexcept
+        {
+            m_data = other.m_data;
+            m_size = other.m_size;
+            m_capacity = other.m_capacity;
+            other.m_data = other.inline_data();
+            other.m_size = 0;
+            other.m_capacity = N;
+        }
+
+        // Capacity for count = m_size + extra elements, doubling so repeated appends stay amortised
+        size_type grown_capacity(size_type extra) const
+        {
+            if (extra > max_size() - m_size)
+                throw std::length_error("small_vector : too many elements");
+            const size_type needed = m_size + extra;
+            const size_type doubled = m_capacity <= max_size() / 2 ? 2 * m_capacity : max_size();
+            return std::max(needed, doubled);
+        }
+
+        void grow_for(size_type extra)
+        {
+            if (extra > m_capacity - m_size)
+                reallocate(grown_capacity(extra));
+        }
+
+        void reallocate(size_type new_capacity)
+        {
+            T* fresh = allocator_traits::allocate(m_allocator, new_capacity);
+            try
+            {
+                relocate(m_data, m_size, fresh);
+            }
+            catch (...)
+            {
+                allocator_traits::deallocate(m_allocator, fresh, new_capacity);
+                throw;
+            }
+            const size_type size = m_size;
+            release_heap();
+            m_data = fresh;
+            m_size = size;
+            m_capacity = new_capacity;
+        }
+
+        template <typename... Args>
+        reference grow_and_emplace_back(Args&&... args)
+        {
+            const size_type new_capacity = grown_capacity(1);
+            T* fresh = allocator_traits::allocate(m_allocator, new_capacity);
+            T* slot = nullptr;
+            try
+            {
+                // Built before the old elements move, args may point into them
+                slot = ::new (static_cast<void*>(fresh + m_size)) T(std::forward<Args>(args)...);
+                relocate(m_data, m_size, fresh);
+            }
+            catch (...)
+            {
+                if (slot != nullptr)
+                    slot->~T();
+                allocator_traits::deallocate(m_allocator, fresh, new_capacity);
+                throw;
+            }
+            const size_type size = m_size;
+            release_heap();
+            m_data = fresh;
+            m_size = size + 1;
+            m_capacity = new_capacity;
+            return *slot;
+        }
+
+        // Only for trivial T : raw room for count elements at index, the size already counts them
+        T* open_gap(size_type index, size_type count)
+        {
+            T* const old_data = m_data;
+            const size_type tail = m_size - index;
+            if (count <= m_capacity - m_size)
+            {
+                if (tail != 0)
+                    std::memmove(static_cast<void*>(old_data + index + count), old_data + index, tail * sizeof(T));
+                m_size += count;
+                return old_data + index;
+            }
+
+            const size_type new_capacity = grown_capacity(count);
+            T* fresh = allocator_traits::allocate(m_allocator, new_capacity);
+            if (index != 0)
+                std::memcpy(static_cast<void*>(fresh), old_data, index * sizeof(T));
+            if (tail != 0)
+                std::memcpy(static_cast<void*>(fresh + index + count), old_data + index, tail * sizeof(T));
+
+            const size_type size = m_size;
+            release_heap();
+            m_data = fresh;
+            m_size = size + count;
+            m_capacity = new_capacity;
+            return fresh + index;
+        }
+
+        // Forward ranges are counted first : one growth, then a memcpy when they are contiguous T
+        template <typename It>
+        iterator insert_range(size_type index, It first, It last, std::forward_iterator_tag)
+        {
+            const size_type count = static_cast<size_type>(std::distance(first, last));
+            if (count == 0)
+                return m_data + index;
+
+            if constexpr (trivial && std::is_same<typename std::iterator_traits<It>::value_type, T>::value)
+            {
+                T* gap = open_gap(index, count);
+                if constexpr (std::is_pointer<It>::value)
+                    std::memcpy(static_cast<void*>(gap), first, count * sizeof(T));
+                else
+                    std::uninitialized_copy(first, last, gap);
+                return gap;
+            }
+            else
+            {
+                const size_type old_size = m_size;
+                grow_for(count);
+                for (; first != last; ++first)
+                    emplace_back(*first);
+                std::rotate(m_data + index, m_data + old_size, m_data + m_size);
+                return m_data + index;
+            }
+        }
+
+        template <typename It>
+        iterator insert_range(size_type index, It first, It last, std::input_iterator_tag)
+        {
+            const size_type old_size = m_size;
+            for (; first != last; ++first)
+                emplace_back(*first);
+            std::rotate(m_data + index, m_data + old_size, m_data + m_size);
+            return m_data + index;
+        }
+
+        T* m_data;
+        size_type m_size;
+        size_type m_capacity;
+        Allocator m_allocator;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type m_inline[N];
+    };
+}
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef _GP_STD_SNAPSHOT_DOMAIN_HPP_
+#define _GP_STD_SNAPSHOT_DOMAIN_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "../memory/gp_epoch.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Copy on write storage for one domain of hash_map_128_t (see base_container), for read mostly maps
+// Every element lives in its own node, the domain holds an immutable block of { hash, node } entries.
+// A writer builds the next block, publishes it with one atomic store and retires the old block (and the
+// node it replaced or erased) through gp_std::epoch_manager. Readers load the block and scan it without
+// a lock, whatever they find stays allocated while they hold an epoch pin, and a node is never written
+// once published, so a reader sees a pair either before or after a concurrent update, never half of both.
+//
+// Usage :
+// gp_std::hash_map_128_t<uint64_t, Quote, gp_std::hash<uint64_t>, gp_std::snapshot_domain> quotes(1024);
+// gp_std::optional<Quote> quote = quotes.load(id);   // never blocks, copies the value while pinned
+
+namespace gp_std
+{
+    /// @class snapshot_domain
+    /// @brief Immutable block of node pointers replaced on every write, readers need an epoch pin and no lock
+    /// @tparam T Element type, must expose hash_value (comparable with ==)
+    /// @note   Writers must be serialized by the caller (hash_map_128_t holds the domain's push_back_lock)
+    /// @note   Node addresses are stable : a reference stays valid until its element is replaced or erased
+    /// @note   A write copies the block, O(size()), which suits domains of a few dozen elements
+    template <typename T>
+    class snapshot_domain
+    {
+    public:
+        using value_type = T;
+        using hash_type  = typename std::decay<decltype(std::declval<const T&>().hash_value)>::type;
+
+        static constexpr size_t npos = size_t(-1);
+
+        snapshot_domain() : m_block(nullptr) {}
+
+        snapshot_domain(const snapshot_domain& other) : m_block(nullptr)
+        {
+            copy_from(other);
+        }
+
+        snapshot_domain& operator=(const snapshot_domain& other)
+        {
+            if (this != &other)
+            {
+                destroy(m_block.load(std::memory_order_relaxed));
+                m_block.store(nullptr, std::memory_order_relaxed);
+                copy_from(other);
+            }
+            return *this;
+        }
+
+        // The owner guarantees no reader is left, see hash_map_128_t::table
+        ~snapshot_domain() { destroy(m_block.load(std::memory_order_relaxed)); }
+
+        size_t size() const
+        {
+            const block* current = m_block.load(std::memory_order_acquire);
+            return current != nullptr ? current->size : 0;
+        }
+
+        bool empty() const { return size() == 0; }
+
+        // Every slot holds an element, erase() compacts the block
+        size_t slot_count() const { return size(); }
+
+        T& operator[](size_t slot) { return *m_block.load(std::memory_order_acquire)->entries()[slot].item; }
+        const T& operator[](size_t slot) const { return *m_block.load(std::memory_order_acquire)->entries()[slot].item; }
+
+        /// @brief The element whose hash_value equals hash and for which equal(element) holds, nullptr if none
+        /// @note  Safe without a lock, the result is valid while the caller stays pinned
+        template <typename Hash, typename KeyEqual>
+        const T* find_item(const Hash& hash, KeyEqual&& equal) const
+        {
+            const block* current = m_block.load(std::memory_order_acquire);
+            if (current == nullptr)
+                return nullptr;
+
+            const entry* entries = current->entries();
+            for (size_t slot = 0; slot < current->size; ++slot)
+            {
+                if (entries[slot].hash == hash && equal(*entries[slot].item))
+                    return entries[slot].item;
+            }
+            return nullptr;
+        }
+
+        /// @brief Slot of the matching element, npos if none ; slots only stay meaningful under the writer lock
+        template <typename Hash, typename KeyEqual>
+        size_t find(const Hash& hash, KeyEqual&& equal) const
+        {
+            const block* current = m_block.load(std::memory_order_acquire);
+            if (current == nullptr)
+                return npos;
+
+            const entry* entries = current->entries();
+            for (size_t slot = 0; slot < current->size; ++slot)
+            {
+                if (entries[slot].hash == hash && equal(*entries[slot].item))
+                    return slot;
+            }
+            return npos;
+        }
+
+        /// @brief Hint the cache with the block a lookup is about to scan
+        void prefetch() const
+        {
+            const block* current = m_block.load(std::memory_order_acquire);
+            if (current == nullptr)
+                return;
+        #if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(current);
+        #elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_prefetch(reinterpret_cast<const char*>(current), _MM_HINT_T0);
+        #endif
+        }
+
+        size_t insert(const T& value) { return adopt(std::unique_ptr<T>(new T(value))); }
+        size_t insert(T&& value) { return adopt(std::unique_ptr<T>(new T(std::move(value)))); }
+
+        void push_back(const T& value) { insert(value); }
+        void push_back(T&& value) { insert(std::move(value)); }
+
+        /// @brief Publish item as a new element, the domain owns it once adopt() returns
+        /// @note  If the new block can not be allocated the item stays with the caller
+        size_t adopt(T* item)
+        {
+            block* next = appended(item);
+            const size_t slot = next->size - 1;
+            publish(next);
+            return slot;
+        }
+
+        /// @brief adopt() for a node nobody else holds, it is freed if the domain can not take it
+        size_t adopt(std::unique_ptr<T> item)
+        {
+            block* next = appended(item.get());
+            const size_t slot = next->size - 1;
+            item.release(); // next holds it from here
+            publish(next);
+            return slot;
+        }
+
+        /// @brief Swap the element at slot for a new node built from value, readers keep the old one until they unpin
+        template <typename U>
+        void replace(size_t slot, U&& value)
+        {
+            const block* current = m_block.load(std::memory_order_relaxed);
+            T* stale = current->entries()[slot].item;
+            std::unique_ptr<T> fresh(new T(std::forward<U>(value)));
+
+            block* next = block::allocate(current->size);
+            for (size_t i = 0; i < current->size; ++i)
+                next->set(i, (i == slot) ? entry{ fresh->hash_value, fresh.get() } : current->entries()[i]);
+            fresh.release(); // next holds it from here
+            publish(next);
+            epoch_manager::global().retire(stale);
+        }
+
+        void erase(size_t slot)
+        {
+            const block* current = m_block.load(std::memory_order_relaxed);
+            if (current == nullptr || slot >= current->size)
+                return;
+
+            T* stale = current->entries()[slot].item;
+            block* next = nullptr;
+            if (current->size > 1)
+            {
+                next = block::allocate(current->size - 1);
+                for (size_t i = 0, j = 0; i < current->size; ++i)
+                {
+                    if (i != slot)
+                        next->set(j++, current->entries()[i]);
+                }
+            }
+            publish(next);
+            epoch_manager::global().retire(stale);
+        }
+
+        /// @brief The node at slot, to hand it to another domain with adopt()
+        T* item(size_t slot) const { return m_block.load(std::memory_order_relaxed)->entries()[slot].item; }
+
+        /// @brief Empty the domain without freeing the nodes, every one of them was adopted elsewhere
+        void disown()
+        {
+            publish(nullptr);
+        }
+
+        void clear()
+        {
+            const block* current = m_block.load(std::memory_order_relaxed);
+            if (current == nullptr)
+                return;
+
+            for (size_t slot = 0; slot < current->size; ++slot)
+                epoch_manager::global().retire(current->entries()[slot].item);
+            publish(nullptr);
+        }
+
+    private:
+        struct entry
+        {
+            hash_type hash;
+            T* item;
+        };
+
+        static_assert(std::is_trivially_destructible<entry>::value, "block entries are never destroyed one by one");
+
+        // The entries follow the header in the same allocation, a lookup is one pointer chase away from them
+        struct alignas(entry) block
+        {
+            size_t size;
+
+            entry* entries() { return reinterpret_cast<entry*>(this + 1); }
+            const entry* entries() const { return reinterpret_cast<const entry*>(this + 1); }
+
+            void set(size_t slot, const entry& e) { ::new (static_cast<void*>(entries() + slot)) entry(e); }
+
+            static block* allocate(size_t size)
+            {
+                block* b = ::new (::operator new(sizeof(block) + size * sizeof(entry))) block;
+                b->size = size;
+                return b;
+            }
+
+            static void release(void* b) { ::operator delete(b); }
+        };
+
+        // A copy of the current block with item appended, the domain is left as it was if the allocation throws
+        block* appended(T* item) const
+        {
+            const block* current = m_block.load(std::memory_order_relaxed);
+            const size_t size = (current != nullptr) ? current->size : 0;
+
+            block* next = block::allocate(size + 1);
+            for (size_t slot = 0; slot < size; ++slot)
+                next->set(slot, current->entries()[slot]);
+            next->set(size, entry{ item->hash_value, item });
+            return next;
+        }
+
+        void publish(block* next)
+        {
+            block* stale = m_block.load(std::memory_order_relaxed);
+            m_block.store(next, std::memory_order_release);
+            if (stale != nullptr)
+                epoch_manager::global().retire(stale, &block::release);
+        }
+
+        void copy_from(const snapshot_domain& other)
+        {
+            const block* source = other.m_block.load(std::memory_order_acquire);
+            if (source == nullptr || source->size == 0)
+                return;
+
+            block* copy = block::allocate(source->size);
+            for (size_t slot = 0; slot < source->size; ++slot)
+                copy->set(slot, entry{ source->entries()[slot].hash, new T(*source->entries()[slot].item) });
+            m_block.store(copy, std::memory_order_release);
+        }
+
+        static void destroy(block* current)
+        {
+            if (current == nullptr)
+                return;
+
+            for (size_t slot = 0; slot < current->size; ++slot)
+                delete current->entries()[slot].item;
+            block::release(current);
+        }
+
+        std::atomic<block*> m_block;
+    };
+} // namespace gp_std
+
+#endif
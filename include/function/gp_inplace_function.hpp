@@ -0,0 +1,156 @@
+#ifndef GP_INPLACE_FUNCTION_HPP
+#define GP_INPLACE_FUNCTION_HPP
+
+#include <type_traits>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+
+
+namespace gp_std
+{
+/// @brief An owning, move-only wrapper of any function object complying with a specific signature,
+/// @brief the function object lives inside the inplace_function itself and never on the heap
+/// @tparam Signature The function signature of the inplace_function
+/// @tparam Capacity Bytes of inline storage, storing a bigger function object does not compile
+/// @note  The default capacity makes the whole object one 64 byte cache line on 64-bit targets
+template <typename Signature, std::size_t Capacity = 6 * sizeof(void*)>
+class inplace_function;
+
+/// Specialization for inplace_function objects with a specific signature
+/// e.g., void()
+template <typename ReturnType, typename... Args, std::size_t Capacity>
+class inplace_function<ReturnType(Args...), Capacity>
+{
+public:
+    inplace_function() noexcept : m_ops(nullptr) {}
+
+    inplace_function(std::nullptr_t) noexcept : m_ops(nullptr) {}
+
+    // Construct from any function object, moved or copied into the inline storage
+    template <typename Callable, typename = typename std::enable_if<!std::is_same<typename std::decay<Callable>::type, inplace_function>::value>::type>
+    inplace_function(Callable&& func) : m_ops(ops_for<typename std::decay<Callable>::type>::table())
+    {
+        using Stored = typename std::decay<Callable>::type;
+        static_assert(sizeof(Stored) <= Capacity, "inplace_function : the function object does not fit in Capacity, capture less or raise Capacity");
+        static_assert(alignof(Stored) <= alignof(storage_type), "inplace_function : the function object is over-aligned");
+        static_assert(std::is_nothrow_move_constructible<Stored>::value, "inplace_function : the function object must be nothrow move constructible");
+        ::new (static_cast<void*>(&m_storage)) Stored(std::forward<Callable>(func));
+    }
+
+    inplace_function(const inplace_function&) = delete;
+    inplace_function& operator=(const inplace_function&) = delete;
+
+    // Move constructor, other is left empty
+    inplace_function(inplace_function&& other) noexcept : m_ops(other.m_ops)
+    {
+        take(other);
+    }
+
+    // Move assignment, other is left empty
+    inplace_function& operator=(inplace_function&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            m_ops = other.m_ops;
+            take(other);
+        }
+        return *this;
+    }
+
+    template <typename Callable, typename = typename std::enable_if<!std::is_same<typename std::decay<Callable>::type, inplace_function>::value>::type>
+    inplace_function& operator=(Callable&& func)
+    {
+        return *this = inplace_function(std::forward<Callable>(func));
+    }
+
+    inplace_function& operator=(std::nullptr_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    ~inplace_function() { reset(); }
+
+    // Destroy the function object, if any
+    void reset() noexcept
+    {
+        if (m_ops != nullptr && m_ops->destroy != nullptr)
+            m_ops->destroy(&m_storage);
+        m_ops = nullptr;
+    }
+
+    explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+    // Callable operator
+    ReturnType operator()(Args... args) const
+    {
+        if(m_ops == nullptr)
+        { assert(false && "Callable object is not initialized"); }
+        return m_ops->invoke(&m_storage, std::forward<Args>(args)...);
+    }
+
+private:
+    using storage_type = typename std::aligned_storage<Capacity, alignof(std::max_align_t)>::type;
+
+    // move and destroy are null for trivially copyable and trivially destructible function objects,
+    // those are moved with one memcpy of the storage and dropped as they are
+    struct operations
+    {
+        ReturnType (*invoke)(void*, Args...);
+        void (*move)(void* src, void* dest) noexcept;
+        void (*destroy)(void*) noexcept;
+    };
+
+    template <typename Callable>
+    struct ops_for
+    {
+        static ReturnType invoke(void* callable, Args... args)
+        {
+            return (*static_cast<Callable*>(callable))(std::forward<Args>(args)...);
+        }
+
+        static void move(void* src, void* dest) noexcept
+        {
+            ::new (dest) Callable(std::move(*static_cast<Callable*>(src)));
+            static_cast<Callable*>(src)->~Callable();
+        }
+
+        static void destroy(void* callable) noexcept
+        {
+            static_cast<Callable*>(callable)->~Callable();
+        }
+
+        // Constant initialized, no guard on the way in
+        static const operations* table()
+        {
+            static const operations ops = {
+                &invoke,
+                std::is_trivially_copyable<Callable>::value ? nullptr : &move,
+                std::is_trivially_destructible<Callable>::value ? nullptr : &destroy
+            };
+            return &ops;
+        }
+    };
+
+    // Move the function object of other (m_ops already copied from it) into this storage
+    void take(inplace_function& other) noexcept
+    {
+        if (m_ops == nullptr)
+            return;
+        if (m_ops->move != nullptr)
+            m_ops->move(&other.m_storage, &m_storage);
+        else
+            std::memcpy(&m_storage, &other.m_storage, sizeof(storage_type));
+        other.m_ops = nullptr;
+    }
+
+    mutable storage_type m_storage;
+    const operations* m_ops;
+};
+
+}// namespace gp_std
+#endif // GP_INPLACE_FUNCTION_HPP
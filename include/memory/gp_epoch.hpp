@@ -0,0 +1,212 @@
+#ifndef _GP_STD_EPOCH_HPP_
+#define _GP_STD_EPOCH_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Epoch based reclamation for readers that never take a lock
+// A reader pins the global epoch for the length of one operation, a writer unlinks an object and retires it.
+// The epoch only moves from e to e + 1 once no reader is left pinned in e - 1, so nobody can still reach
+// an object retired in epoch r once the epoch reached r + 2, that is when it is freed.
+//
+// Usage :
+// {
+//     gp_std::epoch_manager::guard pin = gp_std::epoch_manager::global().pin();
+//     const node* n = head.load(std::memory_order_acquire);   // n stays alive until pin goes out of scope
+// }
+// gp_std::epoch_manager::global().retire(old_node);             // once old_node can no longer be reached
+
+namespace gp_std
+{
+    /// @class epoch_manager
+    /// @brief Process wide epoch, reader pins and per thread lists of retired objects
+    /// @note  pin() is two atomic increments on a slot shared by few threads, retire() is a push_back
+    /// @note  and every collect_threshold retires the calling thread tries to move the epoch and frees what it can
+    /// @warning A reader that stays pinned stops the epoch, keep pins as short as one operation
+    class epoch_manager
+    {
+    public:
+        // Readers are spread over this many counters so they do not all hit one cache line
+        static constexpr size_t slot_count = 64;
+
+        // A thread tries to free what it retired every collect_threshold retires
+        static constexpr size_t collect_threshold = 64;
+
+        /// @brief Keeps the epoch it was taken in pinned until destroyed
+        class guard
+        {
+        public:
+            explicit guard(std::atomic<size_t>* counter) : m_counter(counter) {}
+            guard(guard&& other) noexcept : m_counter(other.m_counter) { other.m_counter = nullptr; }
+            guard(const guard&) = delete;
+            guard& operator=(const guard&) = delete;
+            guard& operator=(guard&&) = delete;
+
+           ~guard()
+            {
+                if (m_counter != nullptr)
+                    m_counter->fetch_sub(1, std::memory_order_release);
+            }
+
+        private:
+            std::atomic<size_t>* m_counter;
+        };
+
+        ///@brief The manager every container of the process shares
+        static epoch_manager& global()
+        {
+            static epoch_manager manager;
+            return manager;
+        }
+
+        epoch_manager(const epoch_manager&) = delete;
+        epoch_manager& operator=(const epoch_manager&) = delete;
+
+       ~epoch_manager()
+        {
+            // Only reached at exit, nobody is pinned any more
+            for (retired& object : m_orphans)
+                object.deleter(object.pointer);
+        }
+
+        ///@brief Pin the current epoch, objects reachable now stay allocated while the guard lives
+        guard pin()
+        {
+            slot& own = m_slots[slot_index()];
+            const uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+            std::atomic<size_t>& counter = own.pinned[epoch & 1];
+            counter.fetch_add(1, std::memory_order_seq_cst);
+            return guard(&counter);
+        }
+
+        uint64_t epoch() const
+        {
+            return m_epoch.load(std::memory_order_seq_cst);
+        }
+
+        ///@brief True once nothing unlinked before retired_epoch was read can still be in use
+        bool is_safe(const uint64_t& retired_epoch) const
+        {
+            return epoch() >= retired_epoch + 2;
+        }
+
+        ///@brief Move the epoch forward if no reader is left in the one before the current epoch
+        bool try_advance()
+        {
+            uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+            const size_t parity = (epoch + 1) & 1;
+            for (const slot& s : m_slots)
+            {
+                if (s.pinned[parity].load(std::memory_order_seq_cst) != 0)
+                    return false;
+            }
+            return m_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+        }
+
+        ///@brief Free object with delete once no pinned reader can hold it, object must already be unreachable
+        template <typename T>
+        void retire(T* object)
+        {
+            retire(static_cast<void*>(object), [](void* pointer) { delete static_cast<T*>(pointer); });
+        }
+
+        void retire(void* object, void (*deleter)(void*))
+        {
+            retire_list& list = local_list();
+            list.objects.push_back(retired{ object, deleter, epoch() });
+            if (list.objects.size() % collect_threshold == 0)
+                collect(list.objects);
+        }
+
+        ///@brief Free what the calling thread retired and is safe by now
+        void collect()
+        {
+            collect(local_list().objects);
+        }
+
+    private:
+        struct alignas(64) slot
+        {
+            slot() : pinned{ {0}, {0} } {}
+            std::atomic<size_t> pinned[2];  // readers pinned in an even / odd epoch
+        };
+
+        struct retired
+        {
+            void* pointer;
+            void (*deleter)(void*);
+            uint64_t epoch;
+        };
+
+        // At thread exit whatever is not safe yet is handed to the manager
+        struct retire_list
+        {
+            std::vector<retired> objects;
+
+           ~retire_list()
+            {
+                epoch_manager& manager = global();
+                manager.collect(objects);
+                if (objects.empty())
+                    return;
+
+                std::lock_guard<std::mutex> lock(manager.m_orphans_lock);
+                manager.m_orphans.insert(manager.m_orphans.end(), objects.begin(), objects.end());
+                manager.m_orphans_pending.store(true, std::memory_order_release);
+            }
+        };
+
+        epoch_manager() : m_epoch(2), m_slots(), m_orphans_pending(false), m_orphans_lock(), m_orphans() {}
+
+        static size_t slot_index()
+        {
+            static std::atomic<size_t> next_slot(0);
+            static thread_local const size_t index = next_slot.fetch_add(1, std::memory_order_relaxed) % slot_count;
+            return index;
+        }
+
+        static retire_list& local_list()
+        {
+            static thread_local retire_list list;
+            return list;
+        }
+
+        // Objects are retired in epoch order, so the safe ones are a prefix
+        void collect(std::vector<retired>& objects)
+        {
+            try_advance();
+            free_safe(objects);
+
+            if (m_orphans_pending.load(std::memory_order_acquire))
+            {
+                std::lock_guard<std::mutex> lock(m_orphans_lock);
+                free_safe(m_orphans);
+                m_orphans_pending.store(!m_orphans.empty(), std::memory_order_relaxed);
+            }
+        }
+
+        void free_safe(std::vector<retired>& objects)
+        {
+            size_t freed = 0;
+            while (freed < objects.size() && is_safe(objects[freed].epoch))
+            {
+                objects[freed].deleter(objects[freed].pointer);
+                ++freed;
+            }
+            objects.erase(objects.begin(), objects.begin() + freed);
+        }
+
+        std::atomic<uint64_t> m_epoch;
+        std::array<slot, slot_count> m_slots;
+
+        std::atomic<bool> m_orphans_pending;
+        std::mutex m_orphans_lock;
+        std::vector<retired> m_orphans;
+    };
+} // namespace gp_std
+
+#endif
@@ -6,13 +6,25 @@
 #include <cassert>     // For assert
 #include <type_traits> // For std::is_base_of
 
+#include "gp_ref_count.hpp"
+
 namespace gp_std
 {
     template <typename T>
     class intrusive_ptr; // Forward declaration
 
+    // Common root of every basic_ref_counted, what intrusive_ptr checks T against
+    class ref_counted_base
+    {
+    protected:
+        ref_counted_base() = default;
+        ~ref_counted_base() = default;
+    };
+
     // Base class providing intrusive reference counting
-    class ref_counted
+    // RefCount is local_ref_count for objects that stay on one thread, atomic_ref_count for objects shared across threads
+    template <typename RefCount>
+    class basic_ref_counted : public ref_counted_base
     {
     private:
         template <typename T>
@@ -20,13 +32,12 @@ namespace gp_std
         // Intrusive reference counting
         void ___add_ref() noexcept
         {
-            ++ref_count_;
+            ref_count_.add_ref();
         }
 
         void ___release() noexcept
         {
-            --ref_count_;
-            if (ref_count_ == 0)
+            if (ref_count_.release())
             {
                 delete this;
             }
@@ -34,28 +45,34 @@ namespace gp_std
 
         void ___init_ref_count() noexcept
         {
-            ref_count_ = 1;
+            ref_count_.init();
         }
 
         int intrusive_ref_count() const noexcept
         {
-            return ref_count_;
+            return ref_count_.use_count();
         }
 
     protected:
-        ref_counted() : ref_count_(-1) {}
-        virtual ~ref_counted() {}
+        basic_ref_counted() = default;
+        virtual ~basic_ref_counted() {}
 
     private:
-        int ref_count_;
+        RefCount ref_count_;
     };
 
+    // Thread confined objects, no atomic on copies
+    using ref_counted = basic_ref_counted<local_ref_count>;
+
+    // Objects whose intrusive_ptr copies are made and dropped on several threads
+    using atomic_ref_counted = basic_ref_counted<atomic_ref_count>;
+
     // Templated intrusive pointer for managing ref_counted-derived objects
     template <typename T>
     class intrusive_ptr
     {
     public:
-        static_assert(std::is_base_of<ref_counted, T>::value, "T must be derived from ref_counted");
+        static_assert(std::is_base_of<ref_counted_base, T>::value, "T must be derived from ref_counted or atomic_ref_counted");
         /// @brief Constructs an intrusive_ptr with a nullptr
         intrusive_ptr() noexcept : ptr_(nullptr) {}
 
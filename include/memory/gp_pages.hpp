@@ -0,0 +1,188 @@
+#ifndef _GP_STD_PAGES_HPP_
+#define _GP_STD_PAGES_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Memory taken straight from the OS, in whole pages, for allocators that grow and shrink in large steps
+// Mappings can be aligned to any power of two, so the owner of an address is found by masking it.
+// Files can be mapped copy-on-write : pages are shared with every process mapping the same file until one writes to them.
+//
+// Usage :
+// char* slab = static_cast<char*>(gp_std::pages::map_aligned(1 << 21, 1 << 21, true));
+// ...
+// gp_std::pages::unmap(slab, 1 << 21);
+
+namespace gp_std
+{
+    namespace pages
+    {
+        // Size of the huge pages asked for by map_aligned, the common one on x86-64 and aarch64
+        static constexpr std::size_t huge_page_size = std::size_t(1) << 21;
+
+        inline std::size_t page_size()
+        {
+        #if defined(_WIN32)
+            static const std::size_t size = []() { SYSTEM_INFO info; GetSystemInfo(&info); return static_cast<std::size_t>(info.dwPageSize); }();
+        #else
+            static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        #endif
+            return size;
+        }
+
+        ///@brief Round size up to a whole number of pages
+        inline std::size_t round_up(std::size_t size)
+        {
+            const std::size_t page = page_size();
+            return (size + page - 1) / page * page;
+        }
+
+        ///@brief Map size bytes of zeroed memory
+        /// @return nullptr when the OS refuses
+        inline void* map(std::size_t size)
+        {
+        #if defined(_WIN32)
+            return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        #else
+            void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            return ptr == MAP_FAILED ? nullptr : ptr;
+        #endif
+        }
+
+        ///@brief Map size bytes of zeroed memory starting on a multiple of alignment (a power of two)
+        /// @note  huge asks for huge pages, explicit ones first then transparent ones, and quietly settles for normal pages
+        /// @return nullptr when the OS refuses
+        inline void* map_aligned(std::size_t size, std::size_t alignment, bool huge = false)
+        {
+        #if defined(_WIN32)
+            (void)huge; // large pages need SeLockMemoryPrivilege, not worth failing for
+
+            // Reserve more than needed to find an aligned address, release it and take the aligned part,
+            // another thread can grab the range in between so try again a few times
+            for (int attempt = 0; attempt < 8; ++attempt)
+            {
+                char* probe = static_cast<char*>(VirtualAlloc(nullptr, size + alignment, MEM_RESERVE, PAGE_NOACCESS));
+                if (probe == nullptr)
+                    return nullptr;
+
+                const std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(probe) + alignment - 1) & ~(alignment - 1);
+                VirtualFree(probe, 0, MEM_RELEASE);
+
+                void* ptr = VirtualAlloc(reinterpret_cast<void*>(aligned), size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+                if (ptr != nullptr)
+                    return ptr;
+            }
+            return nullptr;
+        #else
+        #if defined(MAP_HUGETLB)
+            if (huge && size % huge_page_size == 0 && alignment <= huge_page_size)
+            {
+                void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (ptr != MAP_FAILED)
+                    return ptr;
+            }
+        #endif
+            // Over-map by alignment and trim both ends
+            char* raw = static_cast<char*>(map(size + alignment));
+            if (raw == nullptr)
+                return nullptr;
+
+            char* ptr = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(raw) + alignment - 1) & ~(alignment - 1));
+            if (ptr != raw)
+                munmap(raw, static_cast<std::size_t>(ptr - raw));
+            if (ptr + size != raw + size + alignment)
+                munmap(ptr + size, static_cast<std::size_t>(raw + size + alignment - (ptr + size)));
+
+        #if defined(MADV_HUGEPAGE)
+            if (huge)
+                madvise(ptr, size, MADV_HUGEPAGE);
+        #endif
+            return ptr;
+        #endif
+        }
+
+        ///@brief Give back a mapping made by map or map_aligned, size as it was mapped
+        inline void unmap(void* ptr, std::size_t size)
+        {
+        #if defined(_WIN32)
+            (void)size;
+            VirtualFree(ptr, 0, MEM_RELEASE);
+        #else
+            munmap(ptr, size);
+        #endif
+        }
+
+        ///@brief Map the whole file at path copy-on-write, or read only, its size goes to size
+        /// @note  Writes land in private copies of the pages, the file itself never changes
+        /// @return nullptr if the file can not be opened or mapped, or is empty
+        inline void* map_file(const char* path, std::size_t& size, bool read_only = false)
+        {
+            size = 0;
+        #if defined(_WIN32)
+            HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                return nullptr;
+
+            LARGE_INTEGER file_size;
+            void* ptr = nullptr;
+            if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+            {
+                HANDLE mapping = CreateFileMappingA(file, nullptr, read_only ? PAGE_READONLY : PAGE_WRITECOPY, 0, 0, nullptr);
+                if (mapping != nullptr)
+                {
+                    // The view keeps the mapping alive once the handles are closed
+                    ptr = MapViewOfFile(mapping, read_only ? FILE_MAP_READ : FILE_MAP_COPY, 0, 0, 0);
+                    CloseHandle(mapping);
+                }
+                if (ptr != nullptr)
+                    size = static_cast<std::size_t>(file_size.QuadPart);
+            }
+            CloseHandle(file);
+            return ptr;
+        #else
+            const int fd = open(path, O_RDONLY);
+            if (fd < 0)
+                return nullptr;
+
+            struct stat info;
+            void* ptr = nullptr;
+            if (fstat(fd, &info) == 0 && info.st_size > 0)
+            {
+                const int protection = read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+                ptr = mmap(nullptr, static_cast<std::size_t>(info.st_size), protection, MAP_PRIVATE, fd, 0);
+                if (ptr == MAP_FAILED)
+                    ptr = nullptr;
+                else
+                    size = static_cast<std::size_t>(info.st_size);
+            }
+            close(fd);
+            return ptr;
+        #endif
+        }
+
+        ///@brief Give back a mapping made by map_file
+        inline void unmap_file(const void* ptr, std::size_t size)
+        {
+        #if defined(_WIN32)
+            (void)size;
+            UnmapViewOfFile(ptr);
+        #else
+            munmap(const_cast<void*>(ptr), size);
+        #endif
+        }
+    } // namespace pages
+} // namespace gp_std
+
+#endif
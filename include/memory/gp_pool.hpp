@@ -0,0 +1,172 @@
+#ifndef _GP_STD_POOL_HPP_
+#define _GP_STD_POOL_HPP_
+
+#include <cstddef>
+#include <new>
+
+// Small heap blocks recycled through free lists of the calling thread, one per size class (16 to 256 bytes)
+// No lock and no atomic on either path : a block freed on another thread simply joins the free lists of that thread.
+// Each thread keeps at most max_cached blocks per class and gives them back to the heap when it exits.
+//
+// Usage :
+// void* p = gp_std::block_cache::allocate(48, alignof(message));
+// gp_std::block_cache::deallocate(p, 48, alignof(message));
+//
+// gp_std::shared<T> takes its blocks through pool_allocator, so can any std container
+
+namespace gp_std
+{
+    /// @class block_cache
+    /// @brief Per thread free lists behind a static allocate / deallocate pair, size and alignment as allocated
+    /// @note  Bigger or over-aligned blocks go straight to the global operator new
+    class block_cache
+    {
+    public:
+        static constexpr std::size_t class_count = 5;
+        static constexpr std::size_t smallest_class = 16;
+        static constexpr std::size_t largest_class = smallest_class << (class_count - 1);
+        static constexpr std::size_t max_cached = 256;
+
+        static void* allocate(std::size_t size, std::size_t alignment)
+        {
+            const std::size_t index = class_of(size);
+            if (index == class_count || alignment > alignof(std::max_align_t))
+                return heap_allocate(size, alignment);
+
+            free_lists* lists = local();
+            if (lists != nullptr && lists->head[index] != nullptr)
+            {
+                free_block* block = lists->head[index];
+                lists->head[index] = block->next;
+                --lists->count[index];
+                return block;
+            }
+            return ::operator new(smallest_class << index);
+        }
+
+        static void deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept
+        {
+            const std::size_t index = class_of(size);
+            if (index == class_count || alignment > alignof(std::max_align_t))
+            {
+                heap_deallocate(ptr, alignment);
+                return;
+            }
+
+            free_lists* lists = local();
+            if (lists == nullptr || lists->count[index] == max_cached)
+            {
+                ::operator delete(ptr);
+                return;
+            }
+            free_block* block = static_cast<free_block*>(ptr);
+            block->next = lists->head[index];
+            lists->head[index] = block;
+            ++lists->count[index];
+        }
+
+    private:
+        struct free_block
+        {
+            free_block* next;
+        };
+
+        struct free_lists
+        {
+            free_block* head[class_count] = {};
+            std::size_t count[class_count] = {};
+
+            ~free_lists()
+            {
+                torn_down() = true;
+                for (free_block* block : head)
+                {
+                    while (block != nullptr)
+                    {
+                        free_block* next = block->next;
+                        ::operator delete(block);
+                        block = next;
+                    }
+                }
+            }
+        };
+
+        static std::size_t class_of(std::size_t size) noexcept
+        {
+            std::size_t index = 0;
+            while (index < class_count && (smallest_class << index) < size)
+                ++index;
+            return index;
+        }
+
+        static void* heap_allocate(std::size_t size, std::size_t alignment)
+        {
+        #ifdef __cpp_aligned_new
+            if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                return ::operator new(size, std::align_val_t(alignment));
+        #endif
+            (void)alignment;
+            return ::operator new(size);
+        }
+
+        static void heap_deallocate(void* ptr, std::size_t alignment) noexcept
+        {
+        #ifdef __cpp_aligned_new
+            if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            {
+                ::operator delete(ptr, std::align_val_t(alignment));
+                return;
+            }
+        #endif
+            (void)alignment;
+            ::operator delete(ptr);
+        }
+
+        // Set once the free lists of this thread are gone, blocks freed later by other thread_locals go to the heap
+        static bool& torn_down() noexcept
+        {
+            static thread_local bool flag = false;
+            return flag;
+        }
+
+        static free_lists* local() noexcept
+        {
+            if (torn_down())
+                return nullptr;
+            static thread_local free_lists lists;
+            return &lists;
+        }
+    };
+
+    /// @class pool_allocator
+    /// @brief Stateless std allocator over block_cache, single objects come from the thread free lists
+    template <typename T>
+    class pool_allocator
+    {
+    public:
+        using value_type = T;
+
+        pool_allocator() noexcept = default;
+
+        template <typename U>
+        pool_allocator(const pool_allocator<U>&) noexcept {}
+
+        T* allocate(std::size_t n)
+        {
+            return static_cast<T*>(block_cache::allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* ptr, std::size_t n) noexcept
+        {
+            block_cache::deallocate(ptr, n * sizeof(T), alignof(T));
+        }
+
+        template <typename U>
+        bool operator==(const pool_allocator<U>&) const noexcept { return true; }
+
+        template <typename U>
+        bool operator!=(const pool_allocator<U>&) const noexcept { return false; }
+    };
+}
+
+#endif
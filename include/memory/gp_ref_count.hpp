@@ -0,0 +1,51 @@
+#ifndef _GP_STD_REF_COUNT_HPP_
+#define _GP_STD_REF_COUNT_HPP_
+
+#include <atomic>
+
+// Reference count policies shared by basic_ref_counted (intrusive_ptr) and shared
+// Every policy starts at one reference and offers the same four calls :
+//   init()       back to one reference, for an object adopted by its first owner
+//   add_ref()    one more reference
+//   release()    one less, true for the release that dropped the last one
+//   use_count()  references held, a snapshot for atomic_ref_count
+//
+// local_ref_count   plain integer, for objects confined to one thread
+// atomic_ref_count  relaxed increment and acq_rel decrement, for objects shared across threads
+
+namespace gp_std
+{
+    class local_ref_count
+    {
+    public:
+        void init() noexcept { m_count = 1; }
+
+        void add_ref() noexcept { ++m_count; }
+
+        bool release() noexcept { return --m_count == 0; }
+
+        int use_count() const noexcept { return m_count; }
+
+    private:
+        int m_count = 1;
+    };
+
+    class atomic_ref_count
+    {
+    public:
+        void init() noexcept { m_count.store(1, std::memory_order_relaxed); }
+
+        // A new reference is made from an existing one, nothing to order against
+        void add_ref() noexcept { m_count.fetch_add(1, std::memory_order_relaxed); }
+
+        // Release publishes this thread's writes to the object, acquire on the last one sees all of them before destruction
+        bool release() noexcept { return m_count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+        int use_count() const noexcept { return m_count.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int> m_count{ 1 };
+    };
+}
+
+#endif
@@ -2,144 +2,214 @@
 #define _GP_SHARED_HPP_
 
 #include <memory>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "gp_pool.hpp"
+#include "gp_ref_count.hpp"
+
+// gp_std::shared<T> owns a T together with its reference count in one block, allocated by emplace()
+// RefCount picks how copies count : atomic_ref_count (default) when copies are made and dropped on several threads,
+// local_ref_count when the object never leaves its thread.
+// Blocks come from Allocator, by default pool_allocator which recycles them through the free lists of the calling thread.
+// Allocator is default constructed for every allocation, stateless allocators only.
 
 namespace gp_std
 {
-    template <typename T>
+    template <typename T, typename RefCount = atomic_ref_count, typename Allocator = pool_allocator<T>>
     class shared;
 
-    template <typename T>
+    template <typename T, typename RefCount, typename Allocator>
     class shared
     {
+    private:
+        // Copies of a shared are copies, not a T built from one
+        template <typename... Args>
+        struct is_shared : std::false_type {};
+
+        template <typename Arg>
+        struct is_shared<Arg> : std::is_same<typename std::decay<Arg>::type, shared> {};
+
     public:
-        shared() : m_ptr(nullptr) {}
+        shared() : m_block(nullptr) {}
 
-        template <typename... Args>
-        shared(Args &&...args)
+        template <typename... Args, typename = typename std::enable_if<!is_shared<Args...>::value>::type>
+        shared(Args &&...args) : m_block(nullptr)
         {
             emplace(std::forward<Args>(args)...);
         }
 
-        shared(const shared& other)
+        shared(const shared& other) : m_block(other.m_block)
         {
-            m_ptr = other.m_ptr;
+            if (m_block) m_block->count.add_ref();
         }
 
-        shared(shared&& other)
+        shared(shared&& other) noexcept : m_block(other.m_block)
         {
-            m_ptr = std::move(other.m_ptr);
+            other.m_block = nullptr;
         }
 
-        shared& operator=(shared&& other)
+        ~shared()
         {
-            m_ptr = std::move(other.m_ptr);
+            release();
+        }
+
+        shared& operator=(shared&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                m_block = other.m_block;
+                other.m_block = nullptr;
+            }
             return *this;
         }
 
         shared& operator=(const shared& other)
         {
-            m_ptr = other.m_ptr;
+            if (m_block != other.m_block)
+            {
+                if (other.m_block) other.m_block->count.add_ref();
+                release();
+                m_block = other.m_block;
+            }
             return *this;
         }
 
         shared& operator=(const T& value)
         {
-            if(m_ptr) *m_ptr = value; else emplace(value);
+            if(m_block) m_block->value = value; else emplace(value);
             return *this;
         }
 
         shared& operator=(T&& value)
         {
-            if(m_ptr) *m_ptr = std::move(value); else emplace(std::move(value));
+            if(m_block) m_block->value = std::move(value); else emplace(std::move(value));
             return *this;
         }
 
+        // A new T and its count in a single allocation, the object held before is released
         template <typename... Args>
         void emplace(Args&&... args)
         {
-            if(m_ptr)
+            block_allocator allocator;
+            block* fresh = std::allocator_traits<block_allocator>::allocate(allocator, 1);
+            try
             {
-                new(m_ptr.get()) T(std::forward<Args>(args)...);
+                ::new (static_cast<void*>(fresh)) block(std::forward<Args>(args)...);
             }
-            m_ptr = std::make_shared<T>(std::forward<Args>(args)...);
+            catch (...)
+            {
+                std::allocator_traits<block_allocator>::deallocate(allocator, fresh, 1);
+                throw;
+            }
+            release();
+            m_block = fresh;
         }
 
         template <typename... Args>
         shared& store(Args &&...args)
         {
             emplace(std::forward<Args>(args)...);
+            return *this;
         }
 
         template <typename... Args>
         shared& detach_and_store(Args &&...args)
         {
-            m_ptr = std::make_shared<T>(std::forward<Args>(args)...);
+            emplace(std::forward<Args>(args)...);
+            return *this;
         }
 
         // Use Count
         size_t use_count() const
         {
-            return m_ptr.use_count();
+            return m_block ? static_cast<size_t>(m_block->count.use_count()) : 0;
         }
 
         T* operator->()
         {
-            assert(m_ptr != nullptr && "gp_std::shared : Operator -> called on nullptr");
-            return m_ptr.get();
+            assert(m_block != nullptr && "gp_std::shared : Operator -> called on nullptr");
+            return &m_block->value;
         }
 
         const T* operator->() const
         {
-            assert(m_ptr != nullptr && "gp_std::shared : Operator -> called on nullptr");
-            return m_ptr.get();
+            assert(m_block != nullptr && "gp_std::shared : Operator -> called on nullptr");
+            return &m_block->value;
         }
 
         T& operator*()
         {
-            assert(m_ptr != nullptr && "gp_std::shared : Operator * called on nullptr");
-            return *m_ptr;
+            assert(m_block != nullptr && "gp_std::shared : Operator * called on nullptr");
+            return m_block->value;
         }
 
         const T& operator*() const
         {
-            assert(m_ptr != nullptr && "gp_std::shared : Operator * called on nullptr");
-            return *m_ptr;
+            assert(m_block != nullptr && "gp_std::shared : Operator * called on nullptr");
+            return m_block->value;
         }
 
         operator T&()
         {
-            assert(m_ptr != nullptr && "gp_std::shared : Operator T& called on nullptr");
-            return *m_ptr;
+            assert(m_block != nullptr && "gp_std::shared : Operator T& called on nullptr");
+            return m_block->value;
         }
 
         operator const T&() const
         {
-            assert(m_ptr != nullptr && "gp_std::shared : Operator const T& called on nullptr");
-            return *m_ptr;
+            assert(m_block != nullptr && "gp_std::shared : Operator const T& called on nullptr");
+            return m_block->value;
         }
-        
-        operator bool()
+
+        operator bool() const
         {
-            return m_ptr != nullptr;
+            return m_block != nullptr;
         }
 
-        bool operator==(const shared &other)
+        bool operator==(const shared &other) const
         {
-            return m_ptr == other.m_ptr;
+            return m_block == other.m_block;
         }
 
-        bool operator!=(const shared &other)
+        bool operator!=(const shared &other) const
         {
             return !(*this == other);
         }
 
-        bool operator==(const void *other)
+        bool operator==(const void *other) const
         {
-            return static_cast<void *>(m_ptr.get()) == other;
+            return static_cast<const void *>(m_block ? &m_block->value : nullptr) == other;
         }
 
     private:
-        std::shared_ptr<T> m_ptr;
+        // The count sits in front of the value, one cache line for small T
+        struct block
+        {
+            template <typename... Args>
+            explicit block(Args&&... args) : count(), value(std::forward<Args>(args)...) {}
+
+            RefCount count;
+            T value;
+        };
+
+        using block_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<block>;
+
+        void release() noexcept
+        {
+            if (m_block && m_block->count.release())
+            {
+                block_allocator allocator;
+                m_block->~block();
+                std::allocator_traits<block_allocator>::deallocate(allocator, m_block, 1);
+            }
+            m_block = nullptr;
+        }
+
+        block* m_block;
     };
 }
 
@@ -0,0 +1,163 @@
+#ifndef _GP_STD_ATOMIC_HPP_
+#define _GP_STD_ATOMIC_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+#include "gp_stats.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GP_ATOMIC_PAUSE() _mm_pause()
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define GP_ATOMIC_PAUSE() __yield()
+#else
+#define GP_ATOMIC_PAUSE() __asm__ __volatile__("yield")
+#endif
+#else
+#define GP_ATOMIC_PAUSE() ((void)0)
+#endif
+
+// Small synchronization primitives shared by the containers
+// spinlock guards the hash_map_128_t domains and tables, atomic<T> is the pointer cell behind atomic_sync_ref
+//
+// Usage :
+// gp_std::spinlock lock;
+// {
+//     gp_std::scoped_lock<gp_std::spinlock> guard(lock);
+// }
+
+namespace gp_std
+{
+    ///@brief Tell the core we are busy waiting (pause / yield instruction where there is one)
+    inline void cpu_relax()
+    {
+        GP_ATOMIC_PAUSE();
+    }
+
+    /// @class spinlock
+    /// @brief Test and test-and-set lock for critical sections of a few dozen instructions
+    /// @note  Waiters spin on a plain load so the line stays shared until the owner releases it,
+    /// @note  and give their time slice away once spinning for longer than yield_after rounds
+    /// @note  With GP_STD_STATS, acquisitions and waits are counted under the lock_site given at construction
+    class spinlock
+    {
+    public:
+        // Rounds of cpu_relax() before a waiter starts yielding to the scheduler
+        static constexpr size_t yield_after = 128;
+
+        spinlock() : m_locked(false), m_site(stats::lock_site::other) {}
+        explicit spinlock(stats::lock_site site) : m_locked(false), m_site(site) {}
+
+        spinlock(const spinlock&) = delete;
+        spinlock& operator=(const spinlock&) = delete;
+
+        void lock()
+        {
+            if (m_locked.exchange(true, std::memory_order_acquire))
+                wait();
+            stats::record_lock(m_site);
+        }
+
+        bool try_lock()
+        {
+            if (m_locked.load(std::memory_order_relaxed) || m_locked.exchange(true, std::memory_order_acquire))
+                return false;
+            stats::record_lock(m_site);
+            return true;
+        }
+
+        void unlock()
+        {
+            m_locked.store(false, std::memory_order_release);
+        }
+
+        bool is_locked() const
+        {
+            return m_locked.load(std::memory_order_acquire);
+        }
+
+    private:
+        // The lock was taken, spin on loads until it looks free and try again
+        void wait()
+        {
+            const uint64_t start = stats::wait_start();
+            size_t spins = 0;
+            do
+            {
+                size_t rounds = 0;
+                while (m_locked.load(std::memory_order_relaxed))
+                {
+                    if (++rounds < yield_after)
+                        cpu_relax();
+                    else
+                        std::this_thread::yield();
+                }
+                spins += rounds;
+            } while (m_locked.exchange(true, std::memory_order_acquire));
+            stats::record_wait(m_site, spins, start);
+        }
+
+        std::atomic<bool> m_locked;
+        stats::lock_site m_site;
+    };
+
+    /// @class atomic
+    /// @brief Pointer cell with atomic loads and stores, used like gp_std::ptr (see atomic_sync_ref)
+    /// @tparam T The type pointed to
+    template <typename T>
+    class atomic
+    {
+    public:
+        atomic() : m_ptr(nullptr) {}
+        atomic(T* ptr) : m_ptr(ptr) {}
+        atomic(const atomic& other) : m_ptr(other.get()) {}
+
+        atomic& operator=(const atomic& other)
+        {
+            if (this != &other)
+                m_ptr.store(other.get(), std::memory_order_release);
+            return *this;
+        }
+
+        atomic& operator=(T* ptr)
+        {
+            m_ptr.store(ptr, std::memory_order_release);
+            return *this;
+        }
+
+        bool operator==(T* ptr) const { return get() == ptr; }
+        bool operator!=(T* ptr) const { return get() != ptr; }
+
+        bool operator!() const { return get() == nullptr; }
+        operator bool()  const { return get() != nullptr; }
+
+        operator T* () const { return get(); }
+
+        T& operator*()  const { return *get(); }
+        T* operator->() const { return get(); }
+
+        T* get() const { return m_ptr.load(std::memory_order_acquire); }
+
+        void reset(T* ptr = nullptr) { m_ptr.store(ptr, std::memory_order_release); }
+
+        ///@brief Store ptr and return the previous pointer
+        T* exchange(T* ptr) { return m_ptr.exchange(ptr, std::memory_order_acq_rel); }
+
+        ///@brief Store desired if the cell still holds expected, otherwise load the current pointer into expected
+        bool compare_exchange(T*& expected, T* desired)
+        {
+            return m_ptr.compare_exchange_strong(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire);
+        }
+
+    private:
+        std::atomic<T*> m_ptr;
+    };
+} // namespace gp_std
+
+#undef GP_ATOMIC_PAUSE
+
+#endif
@@ -0,0 +1,323 @@
+#ifndef GP_CHUNKED_STREAM_HPP
+#define GP_CHUNKED_STREAM_HPP
+
+#include <stdio.h>
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <iterator>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "gp_stream.hpp"
+#include "../memory/gp_pages.hpp"
+
+namespace gp_std
+{
+// int main()
+// {
+// -----> Sum the even values of a file of int records without loading it
+//     gp_std::ChunkedStream<int> chunks = gp_std::ChunkedStream<int>::from_file("values.bin", 1 << 20);
+//
+//     long long total = chunks.reduce_chunks<long long>(0,
+//         [](gp_stream<int>& chunk) -> long long
+//         {
+//             return chunk.lazy().
+//                    filter([](const int& x) { return x % 2 == 0; }).
+//                    map([](const int& x) { return static_cast<long long>(x); }).
+//                    parallel_reduce([](const long long& a, const long long& b) { return a + b; }, 0);
+//         },
+//         [](const long long& a, const long long& b) { return a + b; });
+//
+// -----> Generators and iterators work the same way
+//     int next = 0;
+//     auto numbers = gp_std::ChunkedStream<int>::from_generator([&next](int& out) { out = next++; return next <= 1000000; }, 4096);
+// }
+
+namespace stream_detail
+{
+    // Read only view of a whole file, pages already consumed can be handed back to keep the resident set bounded
+    class mapped_file
+    {
+    public:
+        explicit mapped_file(const char* path) : m_data(nullptr), m_size(0)
+        {
+            m_data = static_cast<const unsigned char*>(pages::map_file(path, m_size, true));
+            if (m_data == nullptr)
+            {
+                // An empty file has nothing to map and is a valid, empty source
+                FILE* file = fopen(path, "rb");
+                if (file == nullptr)
+                    throw std::runtime_error(std::string("Unable to open ") + path + "\n");
+                const bool empty = fgetc(file) == EOF;
+                fclose(file);
+                if (!empty)
+                    throw std::runtime_error(std::string("Unable to map ") + path + "\n");
+            }
+        #if !defined(_WIN32)
+            else
+                ::madvise(const_cast<unsigned char*>(m_data), m_size, MADV_SEQUENTIAL);
+        #endif
+        }
+
+        ~mapped_file()
+        {
+            if (m_data != nullptr)
+                pages::unmap_file(m_data, m_size);
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        const unsigned char* data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+        // Drops the whole pages of [0, end) from the resident set, they are read again from the file if touched
+        void release_before(size_t end)
+        {
+        #if !defined(_WIN32)
+            size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            size_t aligned = (end / page) * page;
+            if (aligned != 0 && m_data != nullptr)
+                ::madvise(const_cast<unsigned char*>(m_data), aligned, MADV_DONTNEED);
+        #else
+            (void)end;
+        #endif
+        }
+
+    private:
+        const unsigned char* m_data;
+        size_t m_size;
+    };
+} // namespace stream_detail
+
+/// @brief Pushes a source that does not fit in memory through Stream, one chunk of at most chunk_size elements at a time
+/// @note  A task of the executor reads the next chunk while the current one is processed (double buffering),
+/// @note  so at most two chunks are alive and their storage is reused from chunk to chunk
+/// @note  Chunks are regular Streams and inherit the executor and grain size set here, use lazy() on them for fused stages
+/// @warning Single pass : the source is consumed by the first for_each_chunk / reduce_chunks
+template <typename T, template <typename, typename> class Container = std::vector, typename Allocator = std::allocator<T>>
+class ChunkedStream
+{
+public:
+    using Stream_Type = Stream<T, Container, Allocator>;
+
+    using ContainerType = typename Stream_Type::ContainerType;
+
+    // Appends up to max_count elements to the (empty) chunk and returns how many it appended, 0 ends the stream
+    using Source = std::function<size_t(ContainerType& chunk, size_t max_count)>;
+
+    static constexpr size_t default_chunk_size = 1 << 16;
+
+    explicit ChunkedStream(Source source, size_t chunk_size = default_chunk_size)
+        : m_source(std::move(source)), m_chunk_size(chunk_size == 0 ? 1 : chunk_size), m_executor(), m_grain_size(Stream_Type::default_grain_size) {}
+
+    // +-----------------------------------------------------------------------------------------------------------------+
+    // | Sources                                                                                                         |
+    // +-----------------------------------------------------------------------------------------------------------------+
+
+    /// @brief generator(T& out) writes the next element and returns true, or returns false when it has no more
+    template <typename Generator>
+    static ChunkedStream from_generator(Generator generator, size_t chunk_size = default_chunk_size)
+    {
+        std::shared_ptr<Generator> state = std::make_shared<Generator>(std::move(generator));
+        return ChunkedStream([state](ContainerType& chunk, size_t max_count) -> size_t
+        {
+            size_t count = 0;
+            T value;
+            while (count < max_count && (*state)(value))
+            {
+                chunk.push_back(std::move(value));
+                ++count;
+            }
+            return count;
+        }, chunk_size);
+    }
+
+    /// @brief Elements of [first, last), single pass input iterators are enough
+    template <typename InputIt>
+    static ChunkedStream from_range(InputIt first, InputIt last, size_t chunk_size = default_chunk_size)
+    {
+        std::shared_ptr<std::pair<InputIt, InputIt>> state = std::make_shared<std::pair<InputIt, InputIt>>(first, last);
+        return ChunkedStream([state](ContainerType& chunk, size_t max_count) -> size_t
+        {
+            size_t count = 0;
+            for (; count < max_count && state->first != state->second; ++state->first, ++count)
+            {
+                chunk.push_back(*state->first);
+            }
+            return count;
+        }, chunk_size);
+    }
+
+    /// @brief Memory maps a file of packed T records, a trailing partial record is ignored
+    /// @note  Consumed pages are released from the mapping, the resident set stays around two chunks
+    static ChunkedStream from_file(const char* path, size_t chunk_size = default_chunk_size)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "ChunkedStream::from_file needs trivially copyable records");
+
+        std::shared_ptr<stream_detail::mapped_file> file = std::make_shared<stream_detail::mapped_file>(path);
+        std::shared_ptr<size_t> position = std::make_shared<size_t>(0);
+
+        return ChunkedStream([file, position](ContainerType& chunk, size_t max_count) -> size_t
+        {
+            size_t total = file->size() / sizeof(T);
+            size_t count = std::min(max_count, total - *position);
+            if (count == 0)
+                return 0;
+
+            const T* first = reinterpret_cast<const T*>(file->data()) + *position;
+            chunk.insert(chunk.end(), first, first + count);
+
+            *position += count;
+            file->release_before(*position * sizeof(T));
+            return count;
+        }, chunk_size);
+    }
+
+    // +-----------------------------------------------------------------------------------------------------------------+
+    // | Parallel Backend of the chunks                                                                                  |
+    // +-----------------------------------------------------------------------------------------------------------------+
+
+    ChunkedStream& set_executor(const executor& exec)
+    {
+        m_executor = exec;
+        return *this;
+    }
+
+    ChunkedStream& set_grain_size(size_t grain_size)
+    {
+        m_grain_size = grain_size == 0 ? 1 : grain_size;
+        return *this;
+    }
+
+    size_t chunk_size() const { return m_chunk_size; }
+
+    // +-----------------------------------------------------------------------------------------------------------------+
+    // | Terminal Operations                                                                                             |
+    // +-----------------------------------------------------------------------------------------------------------------+
+
+    /// @brief Calls process(Stream_Type& chunk) for every chunk in source order
+    /// @returns Number of elements streamed
+    template <typename Process>
+    size_t for_each_chunk(Process&& process)
+    {
+        size_t streamed = 0;
+        run([&](Stream_Type& chunk)
+        {
+            streamed += chunk.size();
+            process(chunk);
+        });
+        return streamed;
+    }
+
+    /// @brief Folds process(Stream_Type& chunk) -> R over all chunks with combine(R, R)
+    template <typename R, typename Process, typename Combine>
+    R reduce_chunks(const R& identity, Process&& process, Combine&& combine)
+    {
+        R result = identity;
+        run([&](Stream_Type& chunk)
+        {
+            result = combine(result, process(chunk));
+        });
+        return result;
+    }
+
+private:
+    // The calling thread processes slot i % 2 while a task of the executor reads the next chunk into the other one
+    // Executors that only take batches (sequential, async) read the next chunk between two chunks instead
+    template <typename Consumer>
+    void run(Consumer&& consume)
+    {
+        if (!m_source)
+            return;
+
+        Stream_Type buffers[2];
+        size_t counts[2] = {0, 0};
+        task_latch filled[2];
+
+        for (Stream_Type& buffer : buffers)
+        {
+            if (m_executor.valid())
+                buffer.set_executor(m_executor);
+            buffer.set_grain_size(m_grain_size);
+        }
+
+        const executor& exec = buffers[0].get_executor();
+        const bool prefetch = exec.supports_spawn();
+
+        auto fill = [&](size_t slot)
+        {
+            ContainerType& chunk = buffers[slot].m_data;
+            chunk.clear();
+            try
+            {
+                counts[slot] = m_source(chunk, m_chunk_size);
+            }
+            catch (const std::exception& e)
+            {
+                printf("Exception caught in ChunkedStream source: %s\n", e.what());
+                counts[slot] = 0;
+            }
+            catch (...)
+            {
+                printf("Unknown exception caught in ChunkedStream source\n");
+                counts[slot] = 0;
+            }
+        };
+
+        fill(0);
+
+        for (size_t i = 0; counts[i & 1] != 0; ++i)
+        {
+            size_t slot = i & 1;
+            size_t next = slot ^ 1;
+
+            if (prefetch)
+            {
+                filled[next].reset(1);
+                exec.spawn([&fill, &filled, next]()
+                {
+                    fill(next);
+                    filled[next].count_down();
+                });
+            }
+
+            try
+            {
+                consume(buffers[slot]);
+            }
+            catch (const std::exception& e)
+            {
+                printf("Exception caught in ChunkedStream chunk %zu: %s\n", i, e.what());
+            }
+            catch (...)
+            {
+                printf("Unknown exception caught in ChunkedStream chunk %zu\n", i);
+            }
+
+            // The pool keeps running tasks on this thread until the next chunk is in
+            if (prefetch)
+                exec.wait(filled[next]);
+            else
+                fill(next);
+        }
+    }
+
+    Source m_source;
+    size_t m_chunk_size;
+
+    executor m_executor;
+    size_t m_grain_size;
+};
+
+} // namespace gp_std
+
+#endif
@@ -0,0 +1,405 @@
+#ifndef _GP_STD_COMPUTE_DEVICE_HPP_
+#define _GP_STD_COMPUTE_DEVICE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "gp_atomic.hpp"
+
+// Data parallel kernels over a persistent pool of cpu workers
+// A launch splits one kernel into wave_count() waves, wave i owns the i-th slice of the work (see
+// base_kernel::get_current_wave_min_max). The workers and the launching thread claim waves from a shared
+// counter, so a launch never waits on a worker that is still asleep : the caller runs what nobody took.
+// Workers spin for a short while after a launch before going to sleep, back to back launches skip the wake up.
+//
+// Usage :
+// class sum_kernel : public gp_std::base_kernel { ... void operator()() override { gp_std::min_max mm = get_current_wave_min_max(n); ... } };
+// gp_std::cpu_compute_device* device = gp_std::compute_device::shared(); // nullptr on a single core machine
+// sum_kernel kernel(values);
+// if (device != nullptr)
+// {
+//     device->load_kernel(&kernel);
+//     device->launch_waves();
+//     device->wait();
+// }
+
+namespace gp_std
+{
+    /// @brief Half open range [min, max) of work items
+    struct min_max
+    {
+        size_t min;
+        size_t max;
+    };
+
+    /// @class progress
+    /// @brief Shared by the waves of one launch, a wave that has the answer tells the others to stop
+    class progress
+    {
+    public:
+        progress() : m_finished(false) {}
+
+        bool is_finished() const { return m_finished.load(std::memory_order_relaxed); }
+        void finish() { m_finished.store(true, std::memory_order_relaxed); }
+        void reset() { m_finished.store(false, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<bool> m_finished;
+    };
+
+    namespace device_detail
+    {
+        // The wave the calling thread is running, set by the device before it calls the kernel
+        struct wave_context
+        {
+            size_t index;
+            size_t count;
+        };
+
+        inline wave_context& current_wave()
+        {
+            static thread_local wave_context wave{ 0, 1 };
+            return wave;
+        }
+    }
+
+    /// @class base_kernel
+    /// @brief Work a device runs once per wave
+    /// @note  Every wave of a launch calls operator() on the same kernel at the same time,
+    /// @note  state written by a wave must be its own or atomic
+    class base_kernel
+    {
+    public:
+        base_kernel() : task_progress(nullptr) {}
+        virtual ~base_kernel() = default;
+
+        ///@brief Run the calling thread's wave
+        virtual void operator()() = 0;
+
+        // Set by the device for the length of a launch
+        progress* task_progress;
+
+    protected:
+        ///@brief The slice of [0, count) the current wave owns, slices of all waves cover the range once
+        static min_max get_current_wave_min_max(const size_t& count)
+        {
+            const device_detail::wave_context& wave = device_detail::current_wave();
+            return min_max{ count * wave.index / wave.count, count * (wave.index + 1) / wave.count };
+        }
+
+        static size_t get_current_wave_index() { return device_detail::current_wave().index; }
+        static size_t get_current_wave_count() { return device_detail::current_wave().count; }
+    };
+
+    /// @class cpu_compute_device
+    /// @brief Persistent pool of worker threads running base_kernel waves
+    /// @note  One launch at a time : load_kernel() owns the device until wait() returns,
+    /// @note  try_load_kernel() lets a caller fall back to doing the work alone when the device is busy
+    /// @note  The cost of an empty launch and the parallelism the workers reach are measured at construction,
+    /// @note  see pays_off()
+    class cpu_compute_device
+    {
+    public:
+        // Rounds a worker keeps polling for the next launch before it sleeps
+        static constexpr size_t spin_rounds = 1 << 14;
+
+        // Measured parallelism under which launches are never worth it
+        static constexpr double min_parallelism = 1.5;
+
+        static size_t default_worker_count()
+        {
+            const size_t threads = std::thread::hardware_concurrency();
+            return threads > 1 ? threads - 1 : 0;
+        }
+
+        /// @param worker_count Threads besides the caller, every launch has worker_count + 1 waves
+        explicit cpu_compute_device(const size_t& worker_count = default_worker_count()) :
+            m_kernel(nullptr), m_wave_count(worker_count + 1), m_next_wave(m_wave_count), m_done_waves(0),
+            m_generation(0), m_stop(false), m_sleepers(0), m_launch_overhead(0.0), m_parallelism(1.0)
+        {
+            m_workers.reserve(worker_count);
+            for (size_t i = 0; i < worker_count; ++i)
+                m_workers.emplace_back([this]() { work(); });
+
+            calibrate();
+        }
+
+        cpu_compute_device(const cpu_compute_device&) = delete;
+        cpu_compute_device& operator=(const cpu_compute_device&) = delete;
+
+       ~cpu_compute_device()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                m_stop.store(true);
+            }
+            m_wake.notify_all();
+
+            for (std::thread& worker : m_workers)
+                worker.join();
+        }
+
+        size_t wave_count() const { return m_wave_count; }
+
+        ///@brief Nanoseconds an empty launch costs the caller, measured when the device was built
+        double launch_overhead() const { return m_launch_overhead; }
+
+        ///@brief How many waves actually ran at once when the device was built, 1 ... wave_count()
+        /// @note  Workers sharing cores with each other (or with the caller) bring it down towards 1
+        double parallelism() const { return m_parallelism; }
+
+        ///@brief Smallest number of items, each costing ns_per_item alone, for which a launch is faster
+        size_t break_even(const double& ns_per_item) const
+        {
+            const double saved_per_item = ns_per_item * saved_fraction();
+            if (saved_per_item <= 0.0)
+                return std::numeric_limits<size_t>::max();
+
+            return static_cast<size_t>(m_launch_overhead / saved_per_item) + 1;
+        }
+
+        ///@brief True if spreading items, each costing ns_per_item alone, over the waves beats one thread
+        bool pays_off(const size_t& items, const double& ns_per_item) const
+        {
+            return static_cast<double>(items) * ns_per_item * saved_fraction() > m_launch_overhead;
+        }
+
+        ///@brief Take the device for kernel, waits for the launch of another thread to finish
+        void load_kernel(base_kernel* kernel)
+        {
+            m_launch_lock.lock();
+            bind(kernel);
+        }
+
+        ///@brief Take the device for kernel unless another launch holds it
+        bool try_load_kernel(base_kernel* kernel)
+        {
+            if (!m_launch_lock.try_lock())
+                return false;
+
+            bind(kernel);
+            return true;
+        }
+
+        ///@brief Start the loaded kernel on the workers
+        void launch_waves()
+        {
+            m_done_waves.store(0, std::memory_order_relaxed);
+            m_next_wave.store(0, std::memory_order_release);
+            m_generation.fetch_add(1, std::memory_order_seq_cst);
+
+            if (m_sleepers.load(std::memory_order_seq_cst) != 0)
+            {
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                m_wake.notify_all();
+            }
+        }
+
+        ///@brief Run the waves nobody took yet, wait for the others and release the device
+        void wait()
+        {
+            run_waves();
+
+            while (m_done_waves.load(std::memory_order_acquire) != m_wave_count)
+                cpu_relax();
+
+            m_kernel.store(nullptr, std::memory_order_relaxed);
+            m_launch_lock.unlock();
+        }
+
+    private:
+        // Part of the serial time a launch saves once its overhead is paid
+        double saved_fraction() const { return 1.0 - 1.0 / m_parallelism; }
+
+        void bind(base_kernel* kernel)
+        {
+            m_progress.reset();
+            kernel->task_progress = &m_progress;
+            m_kernel.store(kernel, std::memory_order_relaxed);
+        }
+
+        // Claim waves until none is left, the claim orders the read of m_kernel after launch_waves()
+        void run_waves()
+        {
+            for (;;)
+            {
+                const size_t wave = m_next_wave.fetch_add(1, std::memory_order_acq_rel);
+                if (wave >= m_wave_count)
+                    return;
+
+                device_detail::current_wave() = device_detail::wave_context{ wave, m_wave_count };
+                (*m_kernel.load(std::memory_order_relaxed))();
+                m_done_waves.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+        void work()
+        {
+            uint64_t seen = 0;
+            for (;;)
+            {
+                uint64_t generation = m_generation.load(std::memory_order_acquire);
+                for (size_t round = 0; generation == seen && round < spin_rounds && !m_stop.load(std::memory_order_relaxed); ++round)
+                {
+                    cpu_relax();
+                    generation = m_generation.load(std::memory_order_acquire);
+                }
+
+                if (generation == seen)
+                {
+                    std::unique_lock<std::mutex> lock(m_sleep_mutex);
+                    m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+                    m_wake.wait(lock, [this, seen]() { return m_stop.load() || m_generation.load(std::memory_order_seq_cst) != seen; });
+                    m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+                    generation = m_generation.load(std::memory_order_acquire);
+                }
+
+                if (m_stop.load())
+                    return;
+
+                seen = generation;
+                run_waves();
+            }
+        }
+
+        // Kernel that burns the same amount of cpu in every wave
+        class spin_kernel : public base_kernel
+        {
+        public:
+            explicit spin_kernel(const size_t& rounds) : m_rounds(rounds) {}
+
+            void operator()() override { spin(m_rounds); }
+
+            static void spin(const size_t& rounds)
+            {
+                volatile uint64_t state = 1;
+                for (size_t i = 0; i < rounds; ++i)
+                    state = state * 6364136223846793005ull + 1442695040888963407ull;
+            }
+
+        private:
+            size_t m_rounds;
+        };
+
+        // Median time of a few launches of kernel, after a couple of launches to get the workers going
+        double time_launches(base_kernel& kernel, const size_t& samples)
+        {
+            constexpr size_t warm_up = 2;
+            constexpr size_t max_samples = 15;
+
+            double timings[max_samples];
+            const size_t count = std::min(samples, max_samples);
+            for (size_t i = 0; i < warm_up + count; ++i)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                load_kernel(&kernel);
+                launch_waves();
+                wait();
+                const auto stop = std::chrono::steady_clock::now();
+
+                if (i >= warm_up)
+                    timings[i - warm_up] = std::chrono::duration<double, std::nano>(stop - start).count();
+            }
+
+            std::nth_element(timings, timings + count / 2, timings + count);
+            return timings[count / 2];
+        }
+
+        // Launch overhead from a kernel that does nothing, parallelism from one that spins in every wave :
+        // a launch of it takes overhead + serial time / parallelism
+        void calibrate()
+        {
+            if (m_wave_count < 2)
+                return;
+
+            spin_kernel empty(0);
+            m_launch_overhead = time_launches(empty, 15);
+
+            constexpr size_t rounds = 1 << 14;
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t wave = 0; wave < m_wave_count; ++wave)
+                spin_kernel::spin(rounds);
+            const double serial = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+            spin_kernel busy(rounds);
+            const double parallel = std::max(time_launches(busy, 5) - m_launch_overhead, serial / static_cast<double>(m_wave_count));
+            m_parallelism = std::min(serial / parallel, static_cast<double>(m_wave_count));
+
+            // Less than that is timing noise, the workers share the caller's core
+            if (m_parallelism < min_parallelism)
+                m_parallelism = 1.0;
+        }
+
+        std::vector<std::thread> m_workers;
+
+        gp_std::spinlock m_launch_lock;
+        progress m_progress;
+        std::atomic<base_kernel*> m_kernel;
+
+        const size_t m_wave_count;
+        alignas(64) std::atomic<size_t> m_next_wave;
+        alignas(64) std::atomic<size_t> m_done_waves;
+        alignas(64) std::atomic<uint64_t> m_generation;
+
+        std::atomic<bool> m_stop;
+        std::atomic<size_t> m_sleepers;
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_wake;
+
+        double m_launch_overhead;
+        double m_parallelism;
+    };
+
+    /// @class compute_device
+    /// @brief The device containers use when none was given to them explicitly
+    /// @note  Defaults to shared(), activate(nullptr) turns device launches off for the whole process
+    class compute_device
+    {
+    public:
+        ///@brief Process wide pool, started on first use ; nullptr on a single core machine
+        static cpu_compute_device* shared()
+        {
+            static std::unique_ptr<cpu_compute_device> device(cpu_compute_device::default_worker_count() > 0 ? new cpu_compute_device() : nullptr);
+            return device.get();
+        }
+
+        static cpu_compute_device* active_device()
+        {
+            state& current = get_state();
+            if (!current.selected.load(std::memory_order_acquire))
+                return shared();
+            return current.device.load(std::memory_order_acquire);
+        }
+
+        ///@brief Make device the active one, it must outlive every container launching on it
+        static void activate(cpu_compute_device* device)
+        {
+            state& current = get_state();
+            current.device.store(device, std::memory_order_release);
+            current.selected.store(true, std::memory_order_release);
+        }
+
+    private:
+        struct state
+        {
+            std::atomic<bool> selected{ false };
+            std::atomic<cpu_compute_device*> device{ nullptr };
+        };
+
+        static state& get_state()
+        {
+            static state current;
+            return current;
+        }
+    };
+} // namespace gp_std
+
+#endif
@@ -0,0 +1,491 @@
+#ifndef __GP_EXECUTOR_HPP__
+#define __GP_EXECUTOR_HPP__
+
+#include <cstdio>
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+
+#include "../function/gp_inplace_function.hpp"
+
+// Executors shared by taskflowgraph and Stream
+// gp_std::executor wraps one of them : sequential_executor, async_executor (std::async per task)
+// or work_stealing_executor (persistent pool, use work_stealing_executor::make() for the process wide one)
+
+namespace gp_std
+{
+    // Unit of work handed to the executors, its captures live inline so queuing a task never allocates
+    // A capture bigger than task_capacity does not compile, hold such state through a pointer
+    static constexpr size_t task_capacity = 6 * sizeof(void*);
+    using task_function = inplace_function<void(), task_capacity>;
+
+
+    // Counts down outstanding tasks and releases the threads waiting on them
+    // count_down() only takes the mutex for the final decrement, so it stays cheap for large batches
+    class task_latch
+    {
+    public:
+        explicit task_latch(size_t count = 0) : m_pending(count), m_released(count == 0) {}
+
+        task_latch(const task_latch &) = delete;
+        task_latch &operator=(const task_latch &) = delete;
+
+        void reset(size_t count)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.store(count);
+            m_released = (count == 0);
+        }
+
+        void count_down()
+        {
+            if (m_pending.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_released = true;
+                m_cv.notify_all();
+            }
+        }
+
+        bool try_wait() const { return m_pending.load() == 0; }
+
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_released; });
+        }
+
+        template <typename Rep, typename Period>
+        bool wait_for(const std::chrono::duration<Rep, Period> &timeout)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            return m_cv.wait_for(lock, timeout, [this]() { return m_released; });
+        }
+
+    private:
+        std::atomic<size_t> m_pending;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        bool m_released;
+    };
+
+    class executor_base
+    {
+    public:
+        virtual void enqueue(std::vector<task_function>& tasks) = 0;
+        virtual ~executor_base() = default;
+        virtual std::shared_ptr<executor_base> clone() const = 0;
+
+        // Executors that can accept work while other work is running (thread pools) override these three
+        // Others only get batches through enqueue()
+        virtual bool supports_spawn() const { return false; }
+
+        virtual void spawn(task_function task)
+        {
+            std::vector<task_function> batch;
+            batch.emplace_back(std::move(task));
+            enqueue(batch);
+        }
+
+        virtual void wait(task_latch& latch) { latch.wait(); }
+
+        // How many tasks of one batch can make progress at the same time, used to size data parallel chunks
+        virtual size_t concurrency() const
+        {
+            size_t n = std::thread::hardware_concurrency();
+            return n == 0 ? 1 : n;
+        }
+    };
+
+    class executor
+    {
+        public:
+        executor(std::shared_ptr<executor_base> executor) : m_executor(executor) {}
+
+        executor() : m_executor(nullptr) {}
+
+        executor(const executor& other) = default;
+
+        executor& operator=(std::shared_ptr<executor_base> executor)
+        {
+            m_executor = executor;
+            return *this;
+        }
+
+        executor& operator=(const executor& other)
+        {
+            m_executor = other.m_executor;
+            return *this;
+        }
+       
+        void enqueue(std::vector<task_function>& tasks) const
+        {
+            if(m_executor) m_executor->enqueue(tasks);
+        }
+
+        bool supports_spawn() const
+        {
+            return m_executor ? m_executor->supports_spawn() : false;
+        }
+
+        void spawn(task_function task) const
+        {
+            if(m_executor) m_executor->spawn(std::move(task));
+        }
+
+        void wait(task_latch& latch) const
+        {
+            if(m_executor) m_executor->wait(latch);
+        }
+
+        size_t concurrency() const
+        {
+            return m_executor ? m_executor->concurrency() : 1;
+        }
+
+        bool valid() const { return m_executor != nullptr; }
+
+        executor clone() const
+        {
+            if(m_executor) return executor(m_executor->clone());
+            else throw std::runtime_error("executor is Not Set\n");
+        }
+
+        operator std::shared_ptr<executor_base> () const
+        {
+            if(m_executor) return m_executor;
+            else throw std::runtime_error("executor is Not Set\n");
+        }
+  
+        private:
+        std::shared_ptr<executor_base> m_executor;
+    };
+
+    class sequential_executor : public executor_base
+    {
+    public:
+        
+        void enqueue(std::vector<task_function>& tasks) override
+        {
+            for (auto& task : tasks)
+            {
+                task();
+            }
+        }
+
+        static std::shared_ptr<executor_base> make()  
+        {
+            return std::make_shared<sequential_executor>();
+        }
+
+        size_t concurrency() const override { return 1; }
+
+        std::shared_ptr<executor_base> clone() const override
+        {
+            return std::make_shared<sequential_executor>(*this);
+        }
+        
+        ~sequential_executor() override  = default;
+    };
+
+    // Async executor uses Futures
+    class async_executor : public executor_base
+    {
+    public:
+        void enqueue(std::vector<task_function>& tasks) override
+        {
+            std::vector<std::future<void>> futures;
+        
+            for (auto &task : tasks)
+            {
+                task_function* task_ptr = &task;
+                futures.emplace_back(std::async(std::launch::async, [task_ptr]() { (*task_ptr)(); }));
+            }
+
+            for (auto &future : futures)
+            {
+                future.get();
+            }
+        }
+
+        static std::shared_ptr<executor_base> make()
+        {
+            return std::make_shared<async_executor>();
+        }
+
+        std::shared_ptr<executor_base> clone() const override
+        {
+            return std::make_shared<async_executor>(*this);
+        }
+
+        ~async_executor() override = default;
+    };
+
+    // Work Stealing executor uses a persistent pool of workers
+    // Each worker owns a deque : it pushes / pops its own tasks at the back (LIFO, cache warm)
+    // and steals from the front of the other workers deques (FIFO, oldest first) when it runs dry.
+    // Threads are created once and reused across enqueue() calls, so prefer one instance per process (see make())
+    class work_stealing_executor : public executor_base
+    {
+    public:
+        explicit work_stealing_executor(size_t num_workers = std::thread::hardware_concurrency())
+            : m_queues(num_workers == 0 ? 1 : num_workers), m_queued(0), m_sleeping(0), m_next_queue(0), m_stop(false)
+        {
+            m_workers.reserve(m_queues.size());
+            for (size_t i = 0; i < m_queues.size(); ++i)
+            {
+                m_workers.emplace_back([this, i]() { worker_loop(i); });
+            }
+        }
+
+        work_stealing_executor(const work_stealing_executor &) = delete;
+        work_stealing_executor &operator=(const work_stealing_executor &) = delete;
+
+        // Runs the batch on the pool and returns once every task of the batch has finished
+        // The calling thread helps executing tasks while it waits, so nested enqueue() from a worker can not deadlock
+        void enqueue(std::vector<task_function>& tasks) override
+        {
+            if (tasks.empty())
+                return;
+
+            task_latch latch(tasks.size());
+
+            for (auto &task : tasks)
+            {
+                task_function* task_ptr = &task;
+                task_latch* latch_ptr = &latch;
+                push([task_ptr, latch_ptr]()
+                {
+                    run_guarded(*task_ptr);
+                    latch_ptr->count_down();
+                });
+            }
+
+            help_until(latch);
+        }
+
+        // Pushes a single task and returns immediately
+        // From a worker thread the task lands on that worker's own deque, otherwise queues are picked round robin
+        bool supports_spawn() const override { return true; }
+
+        void spawn(task_function task) override
+        {
+            push(std::move(task));
+        }
+
+        void wait(task_latch& latch) override
+        {
+            help_until(latch);
+        }
+
+        // Keeps executing queued tasks until the latch is released
+        void help_until(task_latch &latch)
+        {
+            bool is_worker = (current_worker_index() != npos);
+
+            while (!latch.try_wait())
+            {
+                task_function task;
+                if (try_acquire(task))
+                {
+                    run_guarded(task);
+                    continue;
+                }
+
+                // Workers must come back to drain their own deque, never block indefinitely here
+                if (is_worker) latch.wait_for(std::chrono::microseconds(50));
+                else           latch.wait();
+            }
+
+            // Synchronise with the last count_down() before the latch goes out of scope
+            latch.wait();
+        }
+
+        size_t worker_count() const { return m_queues.size(); }
+
+        size_t concurrency() const override { return m_queues.size(); }
+
+        // Process wide pool sized to the hardware, created on first use and kept alive until exit
+        static std::shared_ptr<executor_base> make()
+        {
+            static std::shared_ptr<executor_base> instance = std::make_shared<work_stealing_executor>();
+            return instance;
+        }
+
+        static std::shared_ptr<executor_base> make(size_t num_workers)
+        {
+            return std::make_shared<work_stealing_executor>(num_workers);
+        }
+
+        // A pool can not share its threads, clone() creates a new pool with the same number of workers
+        std::shared_ptr<executor_base> clone() const override
+        {
+            return std::make_shared<work_stealing_executor>(m_queues.size());
+        }
+
+        ~work_stealing_executor() override
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                m_stop.store(true);
+            }
+            m_sleep_cv.notify_all();
+
+            for (auto &worker : m_workers)
+            {
+                if (worker.joinable())
+                    worker.join();
+            }
+        }
+
+    private:
+        struct alignas(64) work_queue
+        {
+            std::mutex mutex;
+            std::deque<task_function> tasks;
+        };
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        // Index of the calling thread inside this pool, npos for foreign threads
+        size_t current_worker_index() const
+        {
+            return (tls_owner() == this) ? tls_index() : npos;
+        }
+
+        static const work_stealing_executor*& tls_owner()
+        {
+            static thread_local const work_stealing_executor* owner = nullptr;
+            return owner;
+        }
+
+        static size_t& tls_index()
+        {
+            static thread_local size_t index = npos;
+            return index;
+        }
+
+        void push(task_function task)
+        {
+            size_t index = current_worker_index();
+            if (index == npos)
+            {
+                index = m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_queues[index].mutex);
+                m_queues[index].tasks.emplace_back(std::move(task));
+            }
+
+            m_queued.fetch_add(1);
+
+            // Only pay for the mutex when somebody is actually asleep
+            if (m_sleeping.load() > 0)
+            {
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                m_sleep_cv.notify_one();
+            }
+        }
+
+        static void run_guarded(task_function &task) noexcept
+        {
+            try
+            {
+                task();
+            }
+            catch (const std::exception &e)
+            {
+                printf("Exception caught in work_stealing_executor : %s\n", e.what());
+            }
+            catch (...)
+            {
+                printf("Unknown exception caught in work_stealing_executor\n");
+            }
+        }
+
+        bool try_acquire(task_function &task)
+        {
+            size_t self = current_worker_index();
+            size_t count = m_queues.size();
+
+            // Own deque first, newest task first
+            if (self != npos)
+            {
+                work_queue &queue = m_queues[self];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty())
+                {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                    m_queued.fetch_sub(1);
+                    return true;
+                }
+            }
+
+            // Steal the oldest task of a victim
+            size_t start = (self == npos) ? 0 : self + 1;
+            for (size_t i = 0; i < count; ++i)
+            {
+                work_queue &victim = m_queues[(start + i) % count];
+                std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+                if (lock.owns_lock() && !victim.tasks.empty())
+                {
+                    task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    m_queued.fetch_sub(1);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void worker_loop(size_t index)
+        {
+            tls_owner() = this;
+            tls_index() = index;
+
+            while (true)
+            {
+                task_function task;
+                if (try_acquire(task))
+                {
+                    run_guarded(task);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(m_sleep_mutex);
+                m_sleeping.fetch_add(1);
+                m_sleep_cv.wait(lock, [this]() { return m_stop.load() || m_queued.load() > 0; });
+                m_sleeping.fetch_sub(1);
+
+                if (m_stop.load() && m_queued.load() == 0)
+                    return;
+            }
+        }
+
+    private:
+        std::vector<work_queue> m_queues;
+        std::vector<std::thread> m_workers;
+
+        std::atomic<size_t> m_queued;
+        std::atomic<size_t> m_sleeping;
+        std::atomic<size_t> m_next_queue;
+        std::atomic<bool> m_stop;
+
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_sleep_cv;
+    };
+
+} // namespace gp_std
+#endif
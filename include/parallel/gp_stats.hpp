@@ -0,0 +1,392 @@
+#ifndef _GP_STD_STATS_HPP_
+#define _GP_STD_STATS_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(GP_STD_STATS)
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#endif
+
+// Counters on the internal locks and allocators, compiled in only when GP_STD_STATS is defined
+// (the same way in every translation unit). Without it every record call is empty and take_snapshot() returns zeros.
+// Each thread bumps counters of its own with plain relaxed stores, a snapshot sums the live threads
+// and what exited threads left behind, so reading never stops a writer.
+//
+//   locks           acquisitions, contended acquisitions, spin rounds and wait time, per lock_site
+//   domain_lengths  slots scanned by hash_map_128_t inserts, bucket i counts lengths in [2^(i-1), 2^i)
+//   compactions     domains compacted by hash_map_128_t (remove() or compact()) and the slots given back
+//   string_blocks   block_allocator pools : blocks handed out and freed, bytes mapped, chunks given back to their slab,
+//                   mappings the OS refused
+//
+// Usage :
+// g++ -DGP_STD_STATS ...
+// gp_std::stats::snapshot now = gp_std::stats::take_snapshot();
+// now.visit([](const char* name, uint64_t value) { metrics.gauge(name, value); });
+
+namespace gp_std
+{
+    namespace stats
+    {
+    #if defined(GP_STD_STATS)
+        static constexpr bool enabled = true;
+    #else
+        static constexpr bool enabled = false;
+    #endif
+
+        /// @brief The lock a spinlock reports to, given at construction
+        enum class lock_site : uint8_t
+        {
+            other,
+            hash_map_value_modifier,
+            hash_map_push_back,
+            hash_map_resize,
+            sync_ref_pool,
+            string_fallback
+        };
+
+        static constexpr std::size_t lock_site_count = 6;
+        static constexpr std::size_t histogram_buckets = 16;
+
+        inline const char* site_name(const lock_site& site)
+        {
+            switch (site)
+            {
+                case lock_site::hash_map_value_modifier: return "hash_map.value_modifier_lock";
+                case lock_site::hash_map_push_back:      return "hash_map.push_back_lock";
+                case lock_site::hash_map_resize:         return "hash_map.resize_lock";
+                case lock_site::sync_ref_pool:           return "sync_ref.pool_lock";
+                case lock_site::string_fallback:         return "string.fallback_lock";
+                default:                                 return "other";
+            }
+        }
+
+        struct lock_counters
+        {
+            uint64_t acquisitions = 0;
+            uint64_t contended = 0;     // acquisitions that found the lock taken
+            uint64_t spin_rounds = 0;   // rounds of waiting, cpu_relax() or yield
+            uint64_t wait_ns = 0;       // time between finding the lock taken and getting it
+        };
+
+        struct allocator_counters
+        {
+            uint64_t allocations = 0;
+            uint64_t frees = 0;
+            uint64_t remote_frees = 0;  // blocks freed by another thread than the one owning their arena
+            uint64_t bytes_allocated = 0;
+            uint64_t bytes_freed = 0;
+            uint64_t bytes_mapped = 0;
+            uint64_t bytes_unmapped = 0;
+            uint64_t chunks_returned = 0;
+            uint64_t failed_mappings = 0; // slabs or large blocks the OS did not map, the allocation failed
+
+            uint64_t bytes_in_use() const { return bytes_allocated - bytes_freed; }
+            uint64_t bytes_held() const { return bytes_mapped - bytes_unmapped; }
+
+            ///@brief Share of the mapped bytes not held by a block, 0 when nothing is mapped
+            double fragmentation() const
+            {
+                const uint64_t held = bytes_held();
+                const uint64_t used = bytes_in_use();
+                return held == 0 || used >= held ? 0.0 : 1.0 - static_cast<double>(used) / static_cast<double>(held);
+            }
+        };
+
+        /// @struct snapshot
+        /// @brief Totals since the start of the process, take two and subtract for rates
+        struct snapshot
+        {
+            bool enabled = false;
+            std::array<lock_counters, lock_site_count> locks = {};
+            std::array<uint64_t, histogram_buckets> domain_lengths = {};
+            uint64_t compactions = 0;
+            uint64_t compacted_slots = 0;
+            allocator_counters string_blocks;
+
+            const lock_counters& lock(const lock_site& site) const { return locks[static_cast<std::size_t>(site)]; }
+
+            ///@brief Every counter as a (name, value) pair, for exporters
+            template <typename Visitor>
+            void visit(Visitor&& visitor) const
+            {
+                static const char* const bucket_names[histogram_buckets] = {
+                    "hash_map.domain_length.0", "hash_map.domain_length.1", "hash_map.domain_length.2", "hash_map.domain_length.4",
+                    "hash_map.domain_length.8", "hash_map.domain_length.16", "hash_map.domain_length.32", "hash_map.domain_length.64",
+                    "hash_map.domain_length.128", "hash_map.domain_length.256", "hash_map.domain_length.512", "hash_map.domain_length.1024",
+                    "hash_map.domain_length.2048", "hash_map.domain_length.4096", "hash_map.domain_length.8192", "hash_map.domain_length.16384"
+                };
+                static const char* const lock_fields[4] = { ".acquisitions", ".contended", ".spin_rounds", ".wait_ns" };
+
+                for (std::size_t i = 0; i < lock_site_count; ++i)
+                {
+                    const uint64_t values[4] = { locks[i].acquisitions, locks[i].contended, locks[i].spin_rounds, locks[i].wait_ns };
+                    for (std::size_t field = 0; field < 4; ++field)
+                        visitor((std::string(site_name(static_cast<lock_site>(i))) + lock_fields[field]).c_str(), values[field]);
+                }
+
+                for (std::size_t i = 0; i < histogram_buckets; ++i)
+                    visitor(bucket_names[i], domain_lengths[i]);
+
+                visitor("hash_map.compactions", compactions);
+                visitor("hash_map.compacted_slots", compacted_slots);
+
+                visitor("string.block_allocations", string_blocks.allocations);
+                visitor("string.block_frees", string_blocks.frees);
+                visitor("string.block_remote_frees", string_blocks.remote_frees);
+                visitor("string.bytes_in_use", string_blocks.bytes_in_use());
+                visitor("string.bytes_mapped", string_blocks.bytes_held());
+                visitor("string.chunks_returned", string_blocks.chunks_returned);
+                visitor("string.failed_mappings", string_blocks.failed_mappings);
+            }
+        };
+
+        ///@brief Histogram bucket of a domain scanning length slots : 0, then one bucket per power of two
+        inline std::size_t length_bucket(std::size_t length)
+        {
+            std::size_t bucket = 0;
+            while (length != 0 && bucket + 1 < histogram_buckets)
+            {
+                length >>= 1;
+                ++bucket;
+            }
+            return bucket;
+        }
+
+    #if defined(GP_STD_STATS)
+        namespace stats_detail
+        {
+            // Flat layout of the counters of a thread, four per lock site first
+            static constexpr std::size_t domain_first = lock_site_count * 4;
+            static constexpr std::size_t compactions = domain_first + histogram_buckets;
+            static constexpr std::size_t compacted_slots = compactions + 1;
+            static constexpr std::size_t block_first = compacted_slots + 1;
+            static constexpr std::size_t block_counters = 9;
+            static constexpr std::size_t counter_count = block_first + block_counters;
+
+            struct thread_counters;
+
+            /// @class registry
+            /// @brief Counters of the live threads, and the sum of those that exited
+            class registry
+            {
+            public:
+                void attach(thread_counters* counters)
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_live.push_back(counters);
+                }
+
+                inline void detach(thread_counters* counters);
+
+                void add_retired(const std::size_t& index, const uint64_t& count)
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_retired[index] += count;
+                }
+
+                inline void sum(std::array<uint64_t, counter_count>& totals);
+
+            private:
+                std::mutex m_lock;
+                std::vector<thread_counters*> m_live;
+                std::array<uint64_t, counter_count> m_retired = {};
+            };
+
+            inline registry& global_registry()
+            {
+                static registry* instance = new registry(); // outlives every thread_local counter detaching from it
+                return *instance;
+            }
+
+            struct thread_counters
+            {
+                std::array<std::atomic<uint64_t>, counter_count> values;
+
+                thread_counters()
+                {
+                    for (std::atomic<uint64_t>& value : values)
+                        value.store(0, std::memory_order_relaxed);
+                    global_registry().attach(this);
+                }
+
+               ~thread_counters()
+                {
+                    current() = nullptr;
+                    torn_down() = true;
+                    global_registry().detach(this);
+                }
+
+                // Trivially constructible and destructible, still readable while the thread_local objects are destroyed
+                static bool& torn_down() noexcept
+                {
+                    static thread_local bool flag = false;
+                    return flag;
+                }
+
+                // The counters of this thread once created, a plain load instead of a guarded thread_local on every record
+                static thread_counters*& current() noexcept
+                {
+                    static thread_local thread_counters* counters = nullptr;
+                    return counters;
+                }
+            };
+
+            inline void registry::detach(thread_counters* counters)
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                for (std::size_t i = 0; i < counter_count; ++i)
+                    m_retired[i] += counters->values[i].load(std::memory_order_relaxed);
+                m_live.erase(std::find(m_live.begin(), m_live.end(), counters));
+            }
+
+            inline void registry::sum(std::array<uint64_t, counter_count>& totals)
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                totals = m_retired;
+                for (const thread_counters* counters : m_live)
+                {
+                    for (std::size_t i = 0; i < counter_count; ++i)
+                        totals[i] += counters->values[i].load(std::memory_order_relaxed);
+                }
+            }
+
+            inline thread_counters* create_counters()
+            {
+                if (thread_counters::torn_down())
+                    return nullptr;
+                static thread_local thread_counters counters;
+                thread_counters::current() = &counters;
+                return &counters;
+            }
+
+            inline thread_counters* local_counters()
+            {
+                thread_counters* counters = thread_counters::current();
+                return counters != nullptr ? counters : create_counters();
+            }
+
+            // Only the owning thread writes its counters, a load and a store instead of a locked add
+            inline void add(const std::size_t& index, const uint64_t& count)
+            {
+                thread_counters* counters = local_counters();
+                if (counters == nullptr)
+                {
+                    global_registry().add_retired(index, count);
+                    return;
+                }
+                std::atomic<uint64_t>& value = counters->values[index];
+                value.store(value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+            }
+
+            inline uint64_t now_ns()
+            {
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+            }
+        } // namespace stats_detail
+
+        ///@brief Start of a wait, 0 when the stats are compiled out
+        inline uint64_t wait_start() { return stats_detail::now_ns(); }
+
+        inline void record_lock(const lock_site& site)
+        {
+            stats_detail::add(static_cast<std::size_t>(site) * 4, 1);
+        }
+
+        ///@brief A lock found taken, got after spin_rounds rounds of waiting since start (from wait_start())
+        inline void record_wait(const lock_site& site, const std::size_t& spin_rounds, const uint64_t& start)
+        {
+            const std::size_t first = static_cast<std::size_t>(site) * 4;
+            stats_detail::add(first + 1, 1);
+            stats_detail::add(first + 2, spin_rounds);
+            stats_detail::add(first + 3, stats_detail::now_ns() - start);
+        }
+
+        inline void record_domain_length(const std::size_t& length)
+        {
+            stats_detail::add(stats_detail::domain_first + length_bucket(length), 1);
+        }
+
+        inline void record_compaction(const std::size_t& slots)
+        {
+            stats_detail::add(stats_detail::compactions, 1);
+            stats_detail::add(stats_detail::compacted_slots, slots);
+        }
+
+        inline void record_block_allocation(const std::size_t& bytes)
+        {
+            stats_detail::add(stats_detail::block_first, 1);
+            stats_detail::add(stats_detail::block_first + 3, bytes);
+        }
+
+        inline void record_block_free(const std::size_t& bytes, const bool& remote)
+        {
+            stats_detail::add(stats_detail::block_first + 1, 1);
+            if (remote)
+                stats_detail::add(stats_detail::block_first + 2, 1);
+            stats_detail::add(stats_detail::block_first + 4, bytes);
+        }
+
+        inline void record_mapping(const std::size_t& bytes) { stats_detail::add(stats_detail::block_first + 5, bytes); }
+        inline void record_unmapping(const std::size_t& bytes) { stats_detail::add(stats_detail::block_first + 6, bytes); }
+        inline void record_chunk_returned() { stats_detail::add(stats_detail::block_first + 7, 1); }
+        inline void record_mapping_failure() { stats_detail::add(stats_detail::block_first + 8, 1); }
+
+        inline snapshot take_snapshot()
+        {
+            std::array<uint64_t, stats_detail::counter_count> totals;
+            stats_detail::global_registry().sum(totals);
+
+            snapshot result;
+            result.enabled = true;
+            for (std::size_t i = 0; i < lock_site_count; ++i)
+            {
+                result.locks[i].acquisitions = totals[i * 4];
+                result.locks[i].contended = totals[i * 4 + 1];
+                result.locks[i].spin_rounds = totals[i * 4 + 2];
+                result.locks[i].wait_ns = totals[i * 4 + 3];
+            }
+            for (std::size_t i = 0; i < histogram_buckets; ++i)
+                result.domain_lengths[i] = totals[stats_detail::domain_first + i];
+
+            result.compactions = totals[stats_detail::compactions];
+            result.compacted_slots = totals[stats_detail::compacted_slots];
+
+            allocator_counters& blocks = result.string_blocks;
+            blocks.allocations = totals[stats_detail::block_first];
+            blocks.frees = totals[stats_detail::block_first + 1];
+            blocks.remote_frees = totals[stats_detail::block_first + 2];
+            blocks.bytes_allocated = totals[stats_detail::block_first + 3];
+            blocks.bytes_freed = totals[stats_detail::block_first + 4];
+            blocks.bytes_mapped = totals[stats_detail::block_first + 5];
+            blocks.bytes_unmapped = totals[stats_detail::block_first + 6];
+            blocks.chunks_returned = totals[stats_detail::block_first + 7];
+            blocks.failed_mappings = totals[stats_detail::block_first + 8];
+            return result;
+        }
+    #else
+        inline uint64_t wait_start() { return 0; }
+        inline void record_lock(const lock_site&) {}
+        inline void record_wait(const lock_site&, const std::size_t&, const uint64_t&) {}
+        inline void record_domain_length(const std::size_t&) {}
+        inline void record_compaction(const std::size_t&) {}
+        inline void record_block_allocation(const std::size_t&) {}
+        inline void record_block_free(const std::size_t&, const bool&) {}
+        inline void record_mapping(const std::size_t&) {}
+        inline void record_unmapping(const std::size_t&) {}
+        inline void record_chunk_returned() {}
+        inline void record_mapping_failure() {}
+
+        inline snapshot take_snapshot() { return snapshot(); }
+    #endif
+    } // namespace stats
+} // namespace gp_std
+
+#endif
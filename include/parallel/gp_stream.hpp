@@ -13,7 +13,20 @@
 #include <thread>
 #include <future>
 
+#include <string>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #include "../function/gp_function_ref.hpp"
+#include "gp_executor.hpp"
 
 namespace gp_std
 {
@@ -34,6 +47,17 @@ namespace gp_std
 //     std::function<void(int&)> add_one = [](const int& x) { return x + 1 ; };
 
 
+// ---->   Parallel stages run on a persistent pool (work_stealing_executor::make() by default)
+//          Streams smaller than the grain size stay on the calling thread
+//     stream.set_executor(gp_std::work_stealing_executor::make()).set_grain_size(1 << 14);
+
+// ---->   Lazy pipelines record the stages and fuse them into a single pass when a terminal runs
+//          (collect, to_stream, reduce, parallel_collect, parallel_reduce, count), no intermediate containers
+//     int lazy_sum = stream.lazy().
+//                    filter(is_even).
+//                    map([](const int& x) { return x * 3; }).
+//                    parallel_reduce(add, 0);
+
 // ---->   Apply the functions to the stream
 //     int filtered_data = stream.
 //                         transform(multiply_by_ten).
@@ -49,6 +73,17 @@ namespace gp_std
 //     return 0;
 
 
+template <typename T, typename Out, typename Stages, template <typename, typename> class Container, typename Allocator>
+class LazyStream;
+
+template <typename T, template <typename, typename> class Container, typename Allocator>
+class ChunkedStream;
+
+namespace stream_detail
+{
+    struct identity_stage;
+}
+
 /// @brief Stream API for C++ similar to Java Stream API
 /// @tparam T Type of the elements in the Stream
 /// @tparam Container Container type for the Stream (By default it is std::vector)
@@ -65,6 +100,10 @@ public:
 
     using Stream_Type = Stream<T, Container, Allocator>;
 
+    // Allocator of a Stream of another element type
+    template <typename NewType>
+    using Rebind_Allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<NewType>;
+
     // +-----------------------------------------------------------------------------------------------------------------+
     // | Function Signatures for Stream Operations                                                                       |
     // +-----------------------------------------------------------------------------------------------------------------+
@@ -97,18 +136,21 @@ public:
     // | Constructors                                                                                                    |
     // +-----------------------------------------------------------------------------------------------------------------+
     
-    Stream() = default;
+    // Minimum number of elements per parallel chunk, smaller streams run serially
+    static constexpr size_t default_grain_size = 4096;
+
+    Stream() : m_data(), m_executor(default_executor()), m_grain_size(default_grain_size) {}
 
     template <typename InputIt>
-    Stream(InputIt first, InputIt last) : m_data(first, last) {}
+    Stream(InputIt first, InputIt last) : m_data(first, last), m_executor(default_executor()), m_grain_size(default_grain_size) {}
     
-    Stream(const Stream_Type &other) : m_data(other.m_data) {}
+    Stream(const Stream_Type &other) : m_data(other.m_data), m_executor(other.m_executor), m_grain_size(other.m_grain_size) {}
 
-    Stream(Stream_Type &&other) : m_data(std::move(other.m_data)) {}
+    Stream(Stream_Type &&other) : m_data(std::move(other.m_data)), m_executor(other.m_executor), m_grain_size(other.m_grain_size) {}
 
-    Stream(const ContainerType &data) : m_data(data)       {}
-    Stream(ContainerType &&data) : m_data(std::move(data)) {}
-    Stream(std::initializer_list<T> init) : m_data(init)   {}
+    Stream(const ContainerType &data) : m_data(data), m_executor(default_executor()), m_grain_size(default_grain_size)            {}
+    Stream(ContainerType &&data) : m_data(std::move(data)), m_executor(default_executor()), m_grain_size(default_grain_size)      {}
+    Stream(std::initializer_list<T> init) : m_data(init), m_executor(default_executor()), m_grain_size(default_grain_size)        {}
     
     ~Stream()
     {
@@ -121,6 +163,8 @@ public:
     Stream_Type& operator=(const Stream_Type &other)
     {
         m_data = other.m_data;
+        m_executor = other.m_executor;
+        m_grain_size = other.m_grain_size;
         return *this;
     }
 
@@ -128,9 +172,40 @@ public:
     {
         m_data = std::move(other.m_data);
         m_exceptions = std::move(other.m_exceptions);
+        m_executor = other.m_executor;
+        m_grain_size = other.m_grain_size;
         return *this;
     }
 
+    // +-----------------------------------------------------------------------------------------------------------------+
+    // | Parallel Backend                                                                                                |
+    // +-----------------------------------------------------------------------------------------------------------------+
+
+    // Executor used by the parallel_* operations, streams derived from this one inherit it
+    Stream_Type& set_executor(const executor& exec)
+    {
+        m_executor = exec;
+        return *this;
+    }
+
+    const executor& get_executor() const { return m_executor; }
+
+    // Each parallel chunk gets at least grain_size elements, 0 is treated as 1
+    Stream_Type& set_grain_size(size_t grain_size)
+    {
+        m_grain_size = grain_size == 0 ? 1 : grain_size;
+        return *this;
+    }
+
+    size_t grain_size() const { return m_grain_size; }
+
+    /// @brief Lazy view of this stream, stages chained on it are fused and only run in the terminal operation
+    /// @warning The view refers to this stream, it must not outlive it
+    LazyStream<T, T, stream_detail::identity_stage, Container, Allocator> lazy() const
+    {
+        return LazyStream<T, T, stream_detail::identity_stage, Container, Allocator>(*this, stream_detail::identity_stage());
+    }
+
     Stream_Type& concat(const Stream_Type& other)
     {
         m_data.insert(m_data.end(), other.m_data.begin(), other.m_data.end());
@@ -180,38 +255,24 @@ public:
 
     Stream_Type& parallel_broadcast(const T& value)
     {
-        int num_threads = std::thread::hardware_concurrency();
-        int work_per_thread = m_data.size() / num_threads;
-        std::vector<std::future<void>> futures;
-
-        for (int i = 0; i < num_threads; ++i)
+        run_chunks(m_data.size(), chunk_count(m_data.size()), [&](size_t, size_t start, size_t end)
         {
-            futures.emplace_back(std::async(std::launch::async, [&, i]()
+            for (size_t j = start; j < end; ++j)
             {
-                int start = i * work_per_thread;
-                int end = (i == num_threads - 1) ? m_data.size() : start + work_per_thread;
-                for (int j = start; j < end; ++j)
+                try
                 {
-                    try
-                    {
-                        m_data[j] = value;
-                    }
-                    catch (const std::exception& e)
-                    {
-                        printf("Exception caught in Stream.parallel_broadcast: %s\n", e.what());
-                    }
-                    catch (...)
-                    {
-                        printf("Unknown exception caught in Stream.parallel_broadcast\n");
-                    }
+                    m_data[j] = value;
                 }
-            }));
-        }
-
-        for (auto& future : futures)
-        {
-            future.wait();
-        }
+                catch (const std::exception& e)
+                {
+                    printf("Exception caught in Stream.parallel_broadcast: %s\n", e.what());
+                }
+                catch (...)
+                {
+                    printf("Unknown exception caught in Stream.parallel_broadcast\n");
+                }
+            }
+        });
         
         return *this;
     }
@@ -222,54 +283,135 @@ public:
     {
         ContainerType filtered;
         std::copy_if(m_data.begin(), m_data.end(), std::back_inserter(filtered), predicate);
-        return Stream_Type(std::move(filtered));
+        return derive(std::move(filtered));
     }
 
-    // Parallel Filter: retains only elements that satisfy the predicate in parallel
+    // How parallel_filter finds the survivors again when it scatters them into the output
+    enum class filter_mode
+    {
+        automatic,  // bitmask for trivially copyable T, recompute otherwise
+        recompute,  // evaluate the predicate in both passes, no extra memory
+        bitmask     // evaluate the predicate once, keep one bit per element between the passes
+    };
+
+    // Parallel Filter: retains only elements that satisfy the predicate in parallel, keeps the source order
+    // Pass 1 counts the survivors of each chunk, a prefix sum over the counts gives every chunk its output offset,
+    // pass 2 copies each survivor once, straight into its final slot of a single preallocated container
     // Returns a new Stream
-    Stream_Type parallel_filter(const Predicate& predicate) const
+    Stream_Type parallel_filter(const Predicate& predicate, filter_mode mode = filter_mode::automatic) const
     {
-        ContainerType filtered;
-        int num_threads = std::thread::hardware_concurrency();
-        int work_per_thread = m_data.size() / num_threads;
-        std::vector<std::future<ContainerType>> futures;
+        size_t count = m_data.size();
+        size_t chunks = chunk_count(count);
 
-        for (int i = 0; i < num_threads; ++i)
+        if (chunks <= 1)
         {
-            futures.emplace_back(std::async(std::launch::async, [&, i]() -> ContainerType
+            ContainerType filtered;
+            for (size_t j = 0; j < count; ++j)
             {
-                ContainerType local_filtered;
-                int start = i * work_per_thread;
-                int end = (i == num_threads - 1) ? m_data.size() : start + work_per_thread;
-                for (int j = start; j < end; ++j)
+                if (test_predicate(predicate, j, "parallel_filter"))
+                    filtered.push_back(m_data[j]);
+            }
+            return derive(std::move(filtered));
+        }
+
+        // Scattering into a preallocated container needs T default constructible and assignable,
+        // other types keep the bitmask and are appended in order once the survivors are known
+        constexpr bool scatter = std::is_default_constructible<T>::value && std::is_copy_assignable<T>::value &&
+                                 std::is_move_assignable<T>::value;
+
+        if (!scatter)
+            mode = filter_mode::bitmask;
+        else if (mode == filter_mode::automatic)
+            mode = std::is_trivially_copyable<T>::value ? filter_mode::bitmask : filter_mode::recompute;
+
+        // Chunk boundaries on multiples of 64 elements, so every mask word belongs to exactly one chunk
+        const size_t word_bits = 64;
+        std::vector<uint64_t> mask(mode == filter_mode::bitmask ? (count + word_bits - 1) / word_bits : 0, 0);
+        std::vector<size_t> offsets(chunks + 1, 0);
+
+        run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+        {
+            size_t survivors = 0;
+            for (size_t j = start; j < end; ++j)
+            {
+                if (test_predicate(predicate, j, "parallel_filter"))
                 {
-                    try
+                    ++survivors;
+                    if (mode == filter_mode::bitmask)
+                        mask[j / word_bits] |= uint64_t(1) << (j % word_bits);
+                }
+            }
+            offsets[chunk + 1] = survivors;
+        }, word_bits);
+
+        for (size_t i = 0; i < chunks; ++i)
+        {
+            offsets[i + 1] += offsets[i];
+        }
+
+        if constexpr (!scatter)
+        {
+            ContainerType filtered;
+            for (size_t w = 0; w < mask.size(); ++w)
+            {
+                uint64_t bits = mask[w];
+                while (bits != 0)
+                {
+                    filtered.push_back(m_data[w * word_bits + count_trailing_zeros(bits)]);
+                    bits &= bits - 1;
+                }
+            }
+            return derive(std::move(filtered));
+        }
+        else
+        {
+            ContainerType filtered(offsets[chunks]);
+            std::vector<size_t> written(chunks, 0);
+
+            run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+            {
+                size_t out = offsets[chunk];
+                size_t last = offsets[chunk + 1];
+
+                if (mode == filter_mode::bitmask)
+                {
+                    for (size_t w = start / word_bits; w * word_bits < end; ++w)
                     {
-                        if (predicate(m_data[j]))
+                        uint64_t bits = mask[w];
+                        while (bits != 0)
                         {
-                            local_filtered.push_back(m_data[j]);
+                            filtered[out++] = m_data[w * word_bits + count_trailing_zeros(bits)];
+                            bits &= bits - 1;
                         }
                     }
-                    catch (const std::exception& e)
-                    {
-                        printf("Exception caught in Stream.parallel_filter: %s\n", e.what());
-                    }
-                    catch (...)
+                }
+                else
+                {
+                    for (size_t j = start; j < end && out < last; ++j)
                     {
-                        printf("Unknown exception caught in Stream.parallel_filter\n");
+                        if (test_predicate(predicate, j, "parallel_filter"))
+                            filtered[out++] = m_data[j];
                     }
                 }
-                return local_filtered;
-            }));
-        }
-        
-        for (auto& future : futures)
-        {
-            ContainerType local = future.get();
-            filtered.insert(filtered.end(), local.begin(), local.end());
-        }
+                written[chunk] = out - offsets[chunk];
+            }, word_bits);
+
+            // A predicate that answered differently in the second pass leaves holes, close them serially
+            size_t tail = 0;
+            for (size_t i = 0; i < chunks; ++i)
+            {
+                if (tail != offsets[i])
+                {
+                    for (size_t k = 0; k < written[i]; ++k)
+                        filtered[tail + k] = std::move(filtered[offsets[i] + k]);
+                }
+                tail += written[i];
+            }
+            if (tail != offsets[chunks])
+                filtered.erase(filtered.begin() + tail, filtered.end());
 
-        return Stream_Type(std::move(filtered));
+            return derive(std::move(filtered));
+        }
     }
 
     // Map: applies a function to all elements and returns a new Stream
@@ -282,7 +424,7 @@ public:
         {
             *it++ = mapper(elem);
         }
-        return Stream_Type(std::move(mapped));
+        return derive(std::move(mapped));
     }
 
     // Parallel Map: applies a function to all elements and returns a new Stream in parallel
@@ -290,41 +432,31 @@ public:
     Stream_Type parallel_map(const Mapper& mapper) const
     {
         Container<T, Allocator> mapped(m_data.size());
-        auto it = mapped.begin();
-        int num_threads = std::thread::hardware_concurrency();
-        int work_per_thread = m_data.size() / num_threads;
-        std::vector<std::future<void>> futures;
 
-        for (int i = 0; i < num_threads; ++i)
+        // Each chunk writes its own index range of mapped, boundaries fall on cache lines of the output
+        size_t align = 1, skew = 0;
+        output_alignment(mapped, align, skew);
+
+        run_chunks(m_data.size(), chunk_count(m_data.size()), [&](size_t, size_t start, size_t end)
         {
-            futures.emplace_back(std::async(std::launch::async, [&, i]()
+            for (size_t j = start; j < end; ++j)
             {
-                int start = i * work_per_thread;
-                int end = (i == num_threads - 1) ? m_data.size() : start + work_per_thread;
-                for (int j = start; j < end; ++j)
+                try
                 {
-                    try
-                    {
-                        *it++ = mapper(m_data[j]);
-                    }
-                    catch (const std::exception& e)
-                    {
-                        printf("Exception caught in Stream.parallel_map: %s\n", e.what());
-                    }
-                    catch (...)
-                    {
-                        printf("Unknown exception caught in Stream.parallel_map\n");
-                    }
+                    mapped[j] = mapper(m_data[j]);
                 }
-            }));
-        }
-
-        for (auto& future : futures)
-        {
-            future.wait();
-        }
+                catch (const std::exception& e)
+                {
+                    printf("Exception caught in Stream.parallel_map: %s\n", e.what());
+                }
+                catch (...)
+                {
+                    printf("Unknown exception caught in Stream.parallel_map\n");
+                }
+            }
+        }, align, skew);
 
-        return Stream_Type(std::move(mapped));
+        return derive(std::move(mapped));
     }
 
 
@@ -333,15 +465,17 @@ public:
     /// @note Example: Stream<int> -> map_type<std::string>([](const int& x) { return std::to_string(x); });
     /// @note The above example will return a Stream<std::string>
     template <typename NewType>
-    Stream<NewType, Container, Allocator> map_to_type(const TypeMapper<NewType>& mapper) const
+    Stream<NewType, Container, Rebind_Allocator<NewType>> map_to_type(const TypeMapper<NewType>& mapper) const
     {
-        Container<NewType, Allocator> mapped(m_data.size());
+        Container<NewType, Rebind_Allocator<NewType>> mapped(m_data.size());
         auto it = mapped.begin();
         for (const auto &elem : m_data)
         {
             *it++ = mapper(elem);
         }
-        return Stream<NewType, Container, Allocator>(std::move(mapped));
+        Stream<NewType, Container, Rebind_Allocator<NewType>> result(std::move(mapped));
+        result.set_executor(m_executor).set_grain_size(m_grain_size);
+        return result;
     }
 
     /// @brief Parallel Map Type: applies a function to all elements and returns a new Stream with a different type in parallel
@@ -349,44 +483,36 @@ public:
     /// @note Example: Stream<int> -> parallel_map_type<std::string>([](const int& x) { return std::to_string(x); });
     /// @note The above example will return a Stream<std::string>
     template <typename NewType>
-    Stream<NewType, Container, Allocator> parallel_map_to_type(const TypeMapper<NewType>& mapper) const
+    Stream<NewType, Container, Rebind_Allocator<NewType>> parallel_map_to_type(const TypeMapper<NewType>& mapper) const
     {
-        Container<NewType, Allocator> mapped(m_data.size());
-        auto it = mapped.begin();
-        int num_threads = std::thread::hardware_concurrency();
-        int work_per_thread = m_data.size() / num_threads;
-        std::vector<std::future<void>> futures;
+        Container<NewType, Rebind_Allocator<NewType>> mapped(m_data.size());
+
+        // Each chunk writes its own index range of mapped, boundaries fall on cache lines of the output
+        size_t align = 1, skew = 0;
+        output_alignment(mapped, align, skew);
 
-        for (int i = 0; i < num_threads; ++i)
+        run_chunks(m_data.size(), chunk_count(m_data.size()), [&](size_t, size_t start, size_t end)
         {
-            futures.emplace_back(std::async(std::launch::async, [&, i]()
+            for (size_t j = start; j < end; ++j)
             {
-                int start = i * work_per_thread;
-                int end = (i == num_threads - 1) ? m_data.size() : start + work_per_thread;
-                for (int j = start; j < end; ++j)
+                try
                 {
-                    try
-                    {
-                        *it++ = mapper(m_data[j]);
-                    }
-                    catch (const std::exception& e)
-                    {
-                        printf("Exception caught in Stream.parallel_map_to_type: %s\n", e.what());
-                    }
-                    catch (...)
-                    {
-                        printf("Unknown exception caught in Stream.parallel_map_to_type\n");
-                    }
+                    mapped[j] = mapper(m_data[j]);
                 }
-            }));
-        }
-
-        for (auto& future : futures)
-        {
-            future.wait();
-        }
+                catch (const std::exception& e)
+                {
+                    printf("Exception caught in Stream.parallel_map_to_type: %s\n", e.what());
+                }
+                catch (...)
+                {
+                    printf("Unknown exception caught in Stream.parallel_map_to_type\n");
+                }
+            }
+        }, align, skew);
 
-        return Stream<NewType, Container, Allocator>(std::move(mapped));
+        Stream<NewType, Container, Rebind_Allocator<NewType>> result(std::move(mapped));
+        result.set_executor(m_executor).set_grain_size(m_grain_size);
+        return result;
     }
 
     // Transform: modifies the elements in place
@@ -402,38 +528,24 @@ public:
     // Parallel Transform: modifies the elements in place in parallel
     Stream_Type& parallel_transform(const Transformer& transformer)
     {
-        int num_threads = std::thread::hardware_concurrency();
-        int work_per_thread = m_data.size() / num_threads;
-        std::vector<std::future<void>> futures;
-
-        for (int i = 0; i < num_threads; ++i)
+        run_chunks(m_data.size(), chunk_count(m_data.size()), [&](size_t, size_t start, size_t end)
         {
-            futures.emplace_back(std::async(std::launch::async, [&, i]()
+            for (size_t j = start; j < end; ++j)
             {
-                int start = i * work_per_thread;
-                int end = (i == num_threads - 1) ? m_data.size() : start + work_per_thread;
-                for (int j = start; j < end; ++j)
+                try
                 {
-                    try
-                    {
-                        transformer(m_data[j]);
-                    }
-                    catch (const std::exception& e)
-                    {
-                        printf("Exception caught in Stream.parallel_transform: %s\n", e.what());
-                    }
-                    catch (...)
-                    {
-                        printf("Unknown exception caught in Stream.parallel_transform\n");
-                    }
+                    transformer(m_data[j]);
                 }
-            }));
-        }
-
-        for (auto& future : futures)
-        {
-            future.wait();
-        }
+                catch (const std::exception& e)
+                {
+                    printf("Exception caught in Stream.parallel_transform: %s\n", e.what());
+                }
+                catch (...)
+                {
+                    printf("Unknown exception caught in Stream.parallel_transform\n");
+                }
+            }
+        });
 
         return *this;
     }
@@ -446,45 +558,348 @@ public:
 
     T parallel_reduce(const Accumulator& accumulator, const T& identity) const
     {
-        int num_threads = std::thread::hardware_concurrency();
-        int work_per_thread = m_data.size() / num_threads;
-        std::vector<std::future<T>> futures;
+        size_t chunks = chunk_count(m_data.size());
+        std::vector<T> partials(chunks, identity);
 
-        for (int i = 0; i < num_threads; ++i)
+        run_chunks(m_data.size(), chunks, [&](size_t chunk, size_t start, size_t end)
         {
-            futures.emplace_back(std::async(std::launch::async, [&, i]()
+            T result = identity;
+            for (size_t j = start; j < end; ++j)
             {
-                int start = i * work_per_thread;
-                int end = (i == num_threads - 1) ? m_data.size() : start + work_per_thread;
-                T result = identity;
-                for (int j = start; j < end; ++j)
+                try
                 {
-                    try
-                    {
-                        result = accumulator(result, m_data[j]);
-                    }
-                    catch (const std::exception& e)
-                    {
-                        printf("Exception caught in Stream.parallel_reduce: %s\n", e.what());
-                    }
-                    catch (...)
-                    {
-                        printf("Unknown exception caught in Stream.parallel_reduce\n");
-                    }
+                    result = accumulator(result, m_data[j]);
                 }
-                return result;
-            }));
-        }
+                catch (const std::exception& e)
+                {
+                    printf("Exception caught in Stream.parallel_reduce: %s\n", e.what());
+                }
+                catch (...)
+                {
+                    printf("Unknown exception caught in Stream.parallel_reduce\n");
+                }
+            }
+            partials[chunk] = result;
+        });
 
         T result = identity;
-        for (auto& future : futures)
+        for (auto& partial : partials)
         {
-            result = accumulator(result, future.get());
+            result = accumulator(result, partial);
         }
 
         return result;
     }
     
+    // +-----------------------------------------------------------------------------------------------------------------+
+    // | Sort, Scan, Partition, Grouping                                                                                 |
+    // +-----------------------------------------------------------------------------------------------------------------+
+
+    // Sort: sorts the elements in place
+    template <typename Compare = std::less<T>>
+    Stream_Type& sort(Compare compare = Compare())
+    {
+        std::sort(m_data.begin(), m_data.end(), compare);
+        return *this;
+    }
+
+    // Parallel Sort: every chunk is sorted by std::sort, then the sorted runs are merged pairwise
+    // Each merge round runs its merges in parallel and ping-pongs between m_data and one scratch buffer
+    // Not stable, like std::sort
+    template <typename Compare = std::less<T>>
+    Stream_Type& parallel_sort(Compare compare = Compare())
+    {
+        size_t count = m_data.size();
+        size_t chunks = chunk_count(count);
+
+        if (chunks <= 1)
+        {
+            std::sort(m_data.begin(), m_data.end(), compare);
+            return *this;
+        }
+
+        std::vector<size_t> runs(chunks + 1, count);
+        run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+        {
+            runs[chunk] = start;
+            std::sort(m_data.begin() + start, m_data.begin() + end, compare);
+        });
+
+        ContainerType buffer(count);
+        ContainerType* src = &m_data;
+        ContainerType* dst = &buffer;
+        std::vector<task_function> batch;
+
+        while (runs.size() > 2)
+        {
+            std::vector<size_t> merged;
+            merged.reserve(runs.size() / 2 + 2);
+            batch.clear();
+
+            for (size_t k = 0; k + 1 < runs.size(); k += 2)
+            {
+                size_t first = runs[k];
+                size_t middle = runs[k + 1];
+                size_t last = (k + 2 < runs.size()) ? runs[k + 2] : middle;
+                merged.push_back(first);
+
+                batch.emplace_back([src, dst, first, middle, last, &compare]()
+                {
+                    std::merge(std::make_move_iterator(src->begin() + first), std::make_move_iterator(src->begin() + middle),
+                               std::make_move_iterator(src->begin() + middle), std::make_move_iterator(src->begin() + last),
+                               dst->begin() + first, compare);
+                });
+            }
+            merged.push_back(count);
+
+            run_batch(batch);
+            runs.swap(merged);
+            std::swap(src, dst);
+        }
+
+        if (src != &m_data)
+            m_data.swap(buffer);
+
+        return *this;
+    }
+
+    // Inclusive Scan: element i becomes accumulator(x0, ..., xi), in place
+    Stream_Type& inclusive_scan(const Accumulator& accumulator)
+    {
+        for (size_t j = 1; j < m_data.size(); ++j)
+        {
+            m_data[j] = accumulator(m_data[j - 1], m_data[j]);
+        }
+        return *this;
+    }
+
+    // Exclusive Scan: element i becomes accumulator(identity, x0, ..., xi-1), in place
+    Stream_Type& exclusive_scan(const Accumulator& accumulator, const T& identity)
+    {
+        T running = identity;
+        for (auto& elem : m_data)
+        {
+            T next = accumulator(running, elem);
+            elem = running;
+            running = next;
+        }
+        return *this;
+    }
+
+    // Parallel Inclusive Scan: chunk totals in parallel, a serial scan over the totals, then every chunk rescans with its offset
+    // accumulator must be associative
+    Stream_Type& parallel_inclusive_scan(const Accumulator& accumulator)
+    {
+        size_t count = m_data.size();
+        size_t chunks = chunk_count(count);
+
+        if (chunks <= 1)
+            return inclusive_scan(accumulator);
+
+        std::vector<T> totals(chunks, m_data[0]);
+        run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+        {
+            T total = m_data[start];
+            for (size_t j = start + 1; j < end; ++j)
+            {
+                total = accumulator(total, m_data[j]);
+            }
+            totals[chunk] = total;
+        });
+
+        // totals[i] becomes the combined value of every chunk before i
+        for (size_t i = 2; i < chunks; ++i)
+        {
+            totals[i - 1] = accumulator(totals[i - 2], totals[i - 1]);
+        }
+
+        run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+        {
+            if (chunk != 0)
+                m_data[start] = accumulator(totals[chunk - 1], m_data[start]);
+            for (size_t j = start + 1; j < end; ++j)
+            {
+                m_data[j] = accumulator(m_data[j - 1], m_data[j]);
+            }
+        });
+
+        return *this;
+    }
+
+    // Parallel Exclusive Scan: same three steps as parallel_inclusive_scan
+    // accumulator must be associative and identity its neutral element
+    Stream_Type& parallel_exclusive_scan(const Accumulator& accumulator, const T& identity)
+    {
+        size_t count = m_data.size();
+        size_t chunks = chunk_count(count);
+
+        if (chunks <= 1)
+            return exclusive_scan(accumulator, identity);
+
+        std::vector<T> offsets(chunks + 1, identity);
+        run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+        {
+            T total = identity;
+            for (size_t j = start; j < end; ++j)
+            {
+                total = accumulator(total, m_data[j]);
+            }
+            offsets[chunk + 1] = total;
+        });
+
+        for (size_t i = 1; i <= chunks; ++i)
+        {
+            offsets[i] = accumulator(offsets[i - 1], offsets[i]);
+        }
+
+        run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+        {
+            T running = offsets[chunk];
+            for (size_t j = start; j < end; ++j)
+            {
+                T next = accumulator(running, m_data[j]);
+                m_data[j] = running;
+                running = next;
+            }
+        });
+
+        return *this;
+    }
+
+    // Partition: moves the elements satisfying the predicate to the front, keeps the relative order of both groups
+    // Returns the number of elements satisfying the predicate
+    size_t partition(const Predicate& predicate)
+    {
+        return std::stable_partition(m_data.begin(), m_data.end(), predicate) - m_data.begin();
+    }
+
+    // Parallel Partition: stable, counts both groups per chunk, prefix sums give every chunk its two output offsets
+    // The predicate runs once per element, its result is kept in a bitmask between the passes
+    // Returns the number of elements satisfying the predicate
+    size_t parallel_partition(const Predicate& predicate)
+    {
+        size_t count = m_data.size();
+        size_t chunks = chunk_count(count);
+
+        if (chunks <= 1)
+            return partition(predicate);
+
+        const size_t word_bits = 64;
+        std::vector<uint64_t> mask((count + word_bits - 1) / word_bits, 0);
+        std::vector<size_t> selected(chunks + 1, 0);
+        std::vector<size_t> rejected(chunks + 1, 0);
+
+        run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+        {
+            size_t hits = 0;
+            for (size_t j = start; j < end; ++j)
+            {
+                if (test_predicate(predicate, j, "parallel_partition"))
+                {
+                    ++hits;
+                    mask[j / word_bits] |= uint64_t(1) << (j % word_bits);
+                }
+            }
+            selected[chunk + 1] = hits;
+            rejected[chunk + 1] = (end - start) - hits;
+        }, word_bits);
+
+        for (size_t i = 0; i < chunks; ++i)
+        {
+            selected[i + 1] += selected[i];
+            rejected[i + 1] += rejected[i];
+        }
+
+        size_t split = selected[chunks];
+        ContainerType partitioned(count);
+
+        run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+        {
+            size_t out_selected = selected[chunk];
+            size_t out_rejected = split + rejected[chunk];
+            for (size_t j = start; j < end; ++j)
+            {
+                if (mask[j / word_bits] & (uint64_t(1) << (j % word_bits)))
+                    partitioned[out_selected++] = std::move(m_data[j]);
+                else
+                    partitioned[out_rejected++] = std::move(m_data[j]);
+            }
+        }, word_bits);
+
+        m_data.swap(partitioned);
+        return split;
+    }
+
+    // Group By: buckets the elements by key_of(element), every bucket keeps the source order
+    template <typename KeyFunc, typename Key = typename std::decay<decltype(std::declval<KeyFunc&>()(std::declval<const T&>()))>::type, typename Hash = std::hash<Key>>
+    std::unordered_map<Key, ContainerType, Hash> group_by(KeyFunc&& key_of) const
+    {
+        std::unordered_map<Key, ContainerType, Hash> groups;
+        group_range(key_of, groups, size_t(0), m_data.size(), "group_by");
+        return groups;
+    }
+
+    // Parallel Group By: every chunk groups into its own hash map, the maps are then merged in chunk order
+    template <typename KeyFunc, typename Key = typename std::decay<decltype(std::declval<KeyFunc&>()(std::declval<const T&>()))>::type, typename Hash = std::hash<Key>>
+    std::unordered_map<Key, ContainerType, Hash> parallel_group_by(KeyFunc&& key_of) const
+    {
+        size_t count = m_data.size();
+        size_t chunks = chunk_count(count);
+        std::vector<std::unordered_map<Key, ContainerType, Hash>> locals(chunks);
+
+        run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+        {
+            group_range(key_of, locals[chunk], start, end, "parallel_group_by");
+        });
+
+        std::unordered_map<Key, ContainerType, Hash> groups(std::move(locals[0]));
+        for (size_t i = 1; i < chunks; ++i)
+        {
+            for (auto& group : locals[i])
+            {
+                ContainerType& bucket = groups[group.first];
+                if (bucket.empty())
+                    bucket = std::move(group.second);
+                else
+                    bucket.insert(bucket.end(), std::make_move_iterator(group.second.begin()), std::make_move_iterator(group.second.end()));
+            }
+        }
+        return groups;
+    }
+
+    // Count By: number of elements per key_of(element)
+    template <typename KeyFunc, typename Key = typename std::decay<decltype(std::declval<KeyFunc&>()(std::declval<const T&>()))>::type, typename Hash = std::hash<Key>>
+    std::unordered_map<Key, size_t, Hash> count_by(KeyFunc&& key_of) const
+    {
+        std::unordered_map<Key, size_t, Hash> counts;
+        count_range(key_of, counts, size_t(0), m_data.size(), "count_by");
+        return counts;
+    }
+
+    // Parallel Count By: per chunk hash maps of counters, summed afterwards
+    template <typename KeyFunc, typename Key = typename std::decay<decltype(std::declval<KeyFunc&>()(std::declval<const T&>()))>::type, typename Hash = std::hash<Key>>
+    std::unordered_map<Key, size_t, Hash> parallel_count_by(KeyFunc&& key_of) const
+    {
+        size_t count = m_data.size();
+        size_t chunks = chunk_count(count);
+        std::vector<std::unordered_map<Key, size_t, Hash>> locals(chunks);
+
+        run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+        {
+            count_range(key_of, locals[chunk], start, end, "parallel_count_by");
+        });
+
+        std::unordered_map<Key, size_t, Hash> counts(std::move(locals[0]));
+        for (size_t i = 1; i < chunks; ++i)
+        {
+            for (auto& entry : locals[i])
+            {
+                counts[entry.first] += entry.second;
+            }
+        }
+        return counts;
+    }
+
     /// @note ForEach: applies a function to each element (Might modify)
     /// @note This function is not const as it might modify the elements
     Stream_Type& for_each(const Action& action) 
@@ -523,8 +938,445 @@ public:
         return *this;
     }
 private:
+    template <typename, typename, typename, template <typename, typename> class, typename>
+    friend class LazyStream;
+
+    template <typename, template <typename, typename> class, typename>
+    friend class ChunkedStream;
+
+    static executor default_executor()
+    {
+        return executor(work_stealing_executor::make());
+    }
+
+    // New stream over data that keeps this stream's parallel backend
+    Stream_Type derive(ContainerType &&data) const
+    {
+        Stream_Type result(std::move(data));
+        result.m_executor = m_executor;
+        result.m_grain_size = m_grain_size;
+        return result;
+    }
+
+    // One chunk per worker at most, and never less than m_grain_size elements per chunk
+    size_t chunk_count(size_t count) const
+    {
+        size_t by_grain = count / m_grain_size;
+        size_t workers = m_executor.concurrency();
+        size_t chunks = by_grain < workers ? by_grain : workers;
+        return chunks == 0 ? 1 : chunks;
+    }
+
+    // Runs body(chunk, start, end) over [0, count) split into chunks contiguous ranges
+    // A single chunk runs inline on the calling thread, otherwise the batch goes to m_executor and this call blocks until it is done
+    // Inner boundaries are moved down to an index b with b % align == skew (see output_alignment())
+    template <typename Body>
+    void run_chunks(size_t count, size_t chunks, Body&& body, size_t align = 1, size_t skew = 0) const
+    {
+        if (chunks <= 1 || !m_executor.valid())
+        {
+            body(size_t(0), size_t(0), count);
+            return;
+        }
+
+        size_t work_per_chunk = count / chunks;
+        std::vector<task_function> batch;
+        batch.reserve(chunks);
+
+        auto boundary = [=](size_t i) -> size_t
+        {
+            if (i == 0) return 0;
+            if (i == chunks) return count;
+            size_t nominal = i * work_per_chunk;
+            return nominal < skew ? 0 : skew + ((nominal - skew) / align) * align;
+        };
+
+        for (size_t i = 0; i < chunks; ++i)
+        {
+            size_t start = boundary(i);
+            size_t end = boundary(i + 1);
+            batch.emplace_back([&body, i, start, end]() { body(i, start, end); });
+        }
+
+        m_executor.enqueue(batch);
+    }
+
+    // Predicate for element j, an exception counts as a rejection
+    bool test_predicate(const Predicate& predicate, size_t j, const char* operation) const
+    {
+        try
+        {
+            return predicate(m_data[j]);
+        }
+        catch (const std::exception& e)
+        {
+            printf("Exception caught in Stream.%s: %s\n", operation, e.what());
+        }
+        catch (...)
+        {
+            printf("Unknown exception caught in Stream.%s\n", operation);
+        }
+        return false;
+    }
+
+    template <typename KeyFunc, typename Groups>
+    void group_range(KeyFunc& key_of, Groups& groups, size_t start, size_t end, const char* operation) const
+    {
+        for (size_t j = start; j < end; ++j)
+        {
+            try
+            {
+                groups[key_of(m_data[j])].push_back(m_data[j]);
+            }
+            catch (const std::exception& e)
+            {
+                printf("Exception caught in Stream.%s: %s\n", operation, e.what());
+            }
+            catch (...)
+            {
+                printf("Unknown exception caught in Stream.%s\n", operation);
+            }
+        }
+    }
+
+    template <typename KeyFunc, typename Counts>
+    void count_range(KeyFunc& key_of, Counts& counts, size_t start, size_t end, const char* operation) const
+    {
+        for (size_t j = start; j < end; ++j)
+        {
+            try
+            {
+                ++counts[key_of(m_data[j])];
+            }
+            catch (const std::exception& e)
+            {
+                printf("Exception caught in Stream.%s: %s\n", operation, e.what());
+            }
+            catch (...)
+            {
+                printf("Unknown exception caught in Stream.%s\n", operation);
+            }
+        }
+    }
+
+    // Runs an arbitrary batch on m_executor, or inline when no executor is set
+    void run_batch(std::vector<task_function>& batch) const
+    {
+        if (m_executor.valid())
+        {
+            m_executor.enqueue(batch);
+            return;
+        }
+        for (auto& task : batch) { task(); }
+    }
+
+    static size_t count_trailing_zeros(uint64_t bits)
+    {
+    #if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return index;
+    #else
+        return static_cast<size_t>(__builtin_ctzll(bits));
+    #endif
+    }
+
+    // Chunk alignment for writes into out : align is the number of elements per cache line, skew the first index
+    // that starts a line, so two chunks never write to the same line. Containers without data() only get align
+    static constexpr size_t cache_line_size = 64;
+
+    template <typename OutContainer>
+    static auto first_address(const OutContainer& out, int) -> decltype(reinterpret_cast<uintptr_t>(out.data()))
+    {
+        return reinterpret_cast<uintptr_t>(out.data());
+    }
+
+    template <typename OutContainer>
+    static uintptr_t first_address(const OutContainer&, long) { return 0; }
+
+    template <typename OutContainer>
+    static void output_alignment(const OutContainer& out, size_t& align, size_t& skew)
+    {
+        using U = typename OutContainer::value_type;
+        align = sizeof(U) >= cache_line_size ? 1 : cache_line_size / sizeof(U);
+        skew = 0;
+
+        size_t to_line = (cache_line_size - first_address(out, 0) % cache_line_size) % cache_line_size;
+        if (align > 1 && to_line % sizeof(U) == 0)
+            skew = (to_line / sizeof(U)) % align;
+    }
+
     ContainerType m_data;
     std::vector<std::string> m_exceptions;
+
+    executor m_executor;
+    size_t m_grain_size;
+};
+
+namespace stream_detail
+{
+    // Fused stages push each element into the next stage through a sink, nothing is buffered between stages
+    // Every stage is called with (input element, sink) and calls sink zero or one time
+
+    struct identity_stage
+    {
+        template <typename In, typename Sink>
+        void operator()(const In& in, Sink& sink) const { sink(in); }
+    };
+
+    template <typename Prev, typename Predicate>
+    struct filter_stage
+    {
+        Prev prev;
+        Predicate predicate;
+
+        template <typename In, typename Sink>
+        void operator()(const In& in, Sink& sink) const
+        {
+            auto next = [this, &sink](auto&& value)
+            {
+                if (predicate(value)) { sink(std::forward<decltype(value)>(value)); }
+            };
+            prev(in, next);
+        }
+    };
+
+    template <typename Prev, typename Mapper, typename Result>
+    struct map_stage
+    {
+        Prev prev;
+        Mapper mapper;
+
+        template <typename In, typename Sink>
+        void operator()(const In& in, Sink& sink) const
+        {
+            auto next = [this, &sink](auto&& value)
+            {
+                sink(static_cast<Result>(mapper(value)));
+            };
+            prev(in, next);
+        }
+    };
+
+    // Modifies a copy of the element, the source stream is never written
+    template <typename Prev, typename Transformer>
+    struct transform_stage
+    {
+        Prev prev;
+        Transformer transformer;
+
+        template <typename In, typename Sink>
+        void operator()(const In& in, Sink& sink) const
+        {
+            auto next = [this, &sink](auto&& value)
+            {
+                typename std::decay<decltype(value)>::type copy(std::forward<decltype(value)>(value));
+                transformer(copy);
+                sink(std::move(copy));
+            };
+            prev(in, next);
+        }
+    };
+
+    // Observes the element and passes it on unchanged
+    template <typename Prev, typename Action>
+    struct peek_stage
+    {
+        Prev prev;
+        Action action;
+
+        template <typename In, typename Sink>
+        void operator()(const In& in, Sink& sink) const
+        {
+            auto next = [this, &sink](auto&& value)
+            {
+                action(static_cast<const typename std::decay<decltype(value)>::type&>(value));
+                sink(std::forward<decltype(value)>(value));
+            };
+            prev(in, next);
+        }
+    };
+} // namespace stream_detail
+
+/// @brief Lazy, fused pipeline over a Stream
+/// @note  filter / map / map_to_type / transform / for_each only record a stage, the terminal operation runs all of them
+/// @note  in one pass per chunk, serially or on the source stream's executor, without intermediate containers
+/// @tparam T Element type of the source Stream
+/// @tparam Out Element type produced by the recorded stages
+/// @tparam Stages Fused stage callable, built by the stage methods
+/// @warning Holds a pointer to the source Stream, the source must outlive the pipeline
+template <typename T, typename Out, typename Stages, template <typename, typename> class Container, typename Allocator>
+class LazyStream
+{
+public:
+    using Source_Type = Stream<T, Container, Allocator>;
+
+    using Value_Type = Out;
+
+    using Out_Allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Out>;
+
+    using Out_Container = Container<Out, Out_Allocator>;
+
+    template <typename NewOut, typename NewStages>
+    using Next_Type = LazyStream<T, NewOut, NewStages, Container, Allocator>;
+
+    LazyStream(const Source_Type& source, const Stages& stages) : m_source(&source), m_stages(stages) {}
+
+    // +-----------------------------------------------------------------------------------------------------------------+
+    // | Stages (recorded, nothing runs)                                                                                 |
+    // +-----------------------------------------------------------------------------------------------------------------+
+
+    // Filter: keeps the elements for which predicate(const Out&) is true
+    template <typename Predicate>
+    Next_Type<Out, stream_detail::filter_stage<Stages, typename std::decay<Predicate>::type>> filter(Predicate&& predicate) const
+    {
+        using Stage = stream_detail::filter_stage<Stages, typename std::decay<Predicate>::type>;
+        return Next_Type<Out, Stage>(*m_source, Stage{m_stages, std::forward<Predicate>(predicate)});
+    }
+
+    // Map: replaces each element by mapper(const Out&), the element type follows the mapper's return type
+    template <typename Mapper, typename Result = typename std::decay<decltype(std::declval<Mapper&>()(std::declval<const Out&>()))>::type>
+    Next_Type<Result, stream_detail::map_stage<Stages, typename std::decay<Mapper>::type, Result>> map(Mapper&& mapper) const
+    {
+        using Stage = stream_detail::map_stage<Stages, typename std::decay<Mapper>::type, Result>;
+        return Next_Type<Result, Stage>(*m_source, Stage{m_stages, std::forward<Mapper>(mapper)});
+    }
+
+    // Map Type: same as map with an explicit element type
+    template <typename NewType, typename Mapper>
+    Next_Type<NewType, stream_detail::map_stage<Stages, typename std::decay<Mapper>::type, NewType>> map_to_type(Mapper&& mapper) const
+    {
+        using Stage = stream_detail::map_stage<Stages, typename std::decay<Mapper>::type, NewType>;
+        return Next_Type<NewType, Stage>(*m_source, Stage{m_stages, std::forward<Mapper>(mapper)});
+    }
+
+    // Transform: transformer(Out&) modifies the element on its way through the pipeline
+    template <typename Transformer>
+    Next_Type<Out, stream_detail::transform_stage<Stages, typename std::decay<Transformer>::type>> transform(Transformer&& transformer) const
+    {
+        using Stage = stream_detail::transform_stage<Stages, typename std::decay<Transformer>::type>;
+        return Next_Type<Out, Stage>(*m_source, Stage{m_stages, std::forward<Transformer>(transformer)});
+    }
+
+    // ForEach: action(const Out&) sees every element reaching this stage, elements pass unchanged
+    template <typename Action>
+    Next_Type<Out, stream_detail::peek_stage<Stages, typename std::decay<Action>::type>> for_each(Action&& action) const
+    {
+        using Stage = stream_detail::peek_stage<Stages, typename std::decay<Action>::type>;
+        return Next_Type<Out, Stage>(*m_source, Stage{m_stages, std::forward<Action>(action)});
+    }
+
+    // +-----------------------------------------------------------------------------------------------------------------+
+    // | Terminal Operations (run the fused pipeline)                                                                    |
+    // +-----------------------------------------------------------------------------------------------------------------+
+
+    Out_Container collect() const
+    {
+        Out_Container result;
+        auto sink = [&result](auto&& value) { result.push_back(std::forward<decltype(value)>(value)); };
+        run_range(0, m_source->m_data.size(), sink, "collect");
+        return result;
+    }
+
+    // Collect into a Stream, it keeps the source stream's executor and grain size
+    Stream<Out, Container, Out_Allocator> to_stream() const
+    {
+        Stream<Out, Container, Out_Allocator> result(collect());
+        result.set_executor(m_source->m_executor).set_grain_size(m_source->m_grain_size);
+        return result;
+    }
+
+    // Each chunk collects locally, the chunks are then appended in order
+    Out_Container parallel_collect() const
+    {
+        size_t count = m_source->m_data.size();
+        size_t chunks = m_source->chunk_count(count);
+        std::vector<Out_Container> locals(chunks);
+
+        m_source->run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+        {
+            Out_Container &local = locals[chunk];
+            auto sink = [&local](auto&& value) { local.push_back(std::forward<decltype(value)>(value)); };
+            run_range(start, end, sink, "parallel_collect");
+        });
+
+        if (chunks == 1)
+            return std::move(locals[0]);
+
+        Out_Container result;
+        for (auto& local : locals)
+        {
+            result.insert(result.end(), std::make_move_iterator(local.begin()), std::make_move_iterator(local.end()));
+        }
+        return result;
+    }
+
+    template <typename Accumulator>
+    Out reduce(Accumulator&& accumulator, const Out& identity) const
+    {
+        Out result = identity;
+        auto sink = [&result, &accumulator](auto&& value) { result = accumulator(result, value); };
+        run_range(0, m_source->m_data.size(), sink, "reduce");
+        return result;
+    }
+
+    // accumulator must be associative, each chunk starts from identity
+    template <typename Accumulator>
+    Out parallel_reduce(Accumulator&& accumulator, const Out& identity) const
+    {
+        size_t count = m_source->m_data.size();
+        size_t chunks = m_source->chunk_count(count);
+        std::vector<Out> partials(chunks, identity);
+
+        m_source->run_chunks(count, chunks, [&](size_t chunk, size_t start, size_t end)
+        {
+            Out result = identity;
+            auto sink = [&result, &accumulator](auto&& value) { result = accumulator(result, value); };
+            run_range(start, end, sink, "parallel_reduce");
+            partials[chunk] = result;
+        });
+
+        Out result = identity;
+        for (auto& partial : partials)
+        {
+            result = accumulator(result, partial);
+        }
+        return result;
+    }
+
+    // Number of elements that reach the end of the pipeline
+    size_t count() const
+    {
+        size_t result = 0;
+        auto sink = [&result](auto&&) { ++result; };
+        run_range(0, m_source->m_data.size(), sink, "count");
+        return result;
+    }
+
+private:
+    template <typename Sink>
+    void run_range(size_t start, size_t end, Sink& sink, const char* operation) const
+    {
+        const auto& data = m_source->m_data;
+        for (size_t j = start; j < end; ++j)
+        {
+            try
+            {
+                m_stages(data[j], sink);
+            }
+            catch (const std::exception& e)
+            {
+                printf("Exception caught in LazyStream.%s: %s\n", operation, e.what());
+            }
+            catch (...)
+            {
+                printf("Unknown exception caught in LazyStream.%s\n", operation);
+            }
+        }
+    }
+
+    const Source_Type* m_source;
+    Stages m_stages;
 };
 
 } // namespace gp_std
@@ -1,9 +1,11 @@
 #ifndef __GP_TASKFLOW_HPP___
-#ifndef __GP_TASKFLOW_HPP___
+#define __GP_TASKFLOW_HPP___
 
 #include <iostream>
 #include <fstream>
+#include <iomanip>
 #include <cstdlib>
+#include <cstdio>
 
 #include <string>
 #include <vector>
@@ -19,10 +21,19 @@
 #include <thread>
 #include <atomic>
 #include <future>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+
+#include "gp_executor.hpp"
 
 // Usage :
 // gp_std::taskflowgraph graph;
 // graph.set_executor(gp_std::async_executor::make());  
+// or keep one persistent pool for the whole process
+// graph.set_executor(gp_std::work_stealing_executor::make());
+// graph.set_scheduling(gp_std::scheduling_mode::dependency_counter);  // no polling, successors are pushed on completion
 
 // graph.add_task("Task1", []
 //                { std::cout << "Executing Task 1\n"; });
@@ -42,114 +53,15 @@
 // graph.execute();
 
 // graph.export_to_graphviz("taskflow2.dot");
+// graph.export_to_chrome_trace("taskflow2");  // writes taskflow2.json with per-task wait/run times and the critical path
+
+// Same shape, many runs : compile once and rerun the frozen plan
+// gp_std::compiled_taskflow plan = graph.compile();
+// plan.run();
+// plan.run();
 
 namespace gp_std
 {
-    class executor_base
-    {
-    public:
-        virtual void enqueue(std::vector<std::function<void()>>& tasks) = 0;
-        virtual ~executor_base() = default;
-        virtual std::shared_ptr<executor_base> clone() const = 0;
-    };
-
-    class executor
-    {
-        public:
-        executor(std::shared_ptr<executor_base> executor) : m_executor(executor) {}
-
-        executor() : m_executor(nullptr) {}
-
-        executor& operator=(std::shared_ptr<executor_base> executor)
-        {
-            m_executor = executor;
-            return *this;
-        }
-
-        executor& operator=(const executor& other)
-        {
-            m_executor = other.m_executor;
-            return *this;
-        }
-       
-        void enqueue(std::vector<std::function<void()>> tasks)
-        {
-            if(m_executor) m_executor->enqueue(tasks);
-        }
-
-        executor clone() const
-        {
-            if(m_executor) return executor(m_executor->clone());
-            else throw std::runtime_error("executor is Not Set\n");
-        }
-
-        operator std::shared_ptr<executor_base> () const
-        {
-            if(m_executor) return m_executor;
-            else throw std::runtime_error("executor is Not Set\n");
-        }
-  
-        private:
-        std::shared_ptr<executor_base> m_executor;
-    };
-
-    class sequential_executor : public executor_base
-    {
-    public:
-        
-        void enqueue(std::vector<std::function<void()>>& tasks) override
-        {
-            for (auto& task : tasks)
-            {
-                task();
-            }
-        }
-
-        static std::shared_ptr<executor_base> make()  
-        {
-            return std::make_shared<sequential_executor>();
-        }
-
-        std::shared_ptr<executor_base> clone() const override
-        {
-            return std::make_shared<sequential_executor>(*this);
-        }
-        
-        ~sequential_executor() override  = default;
-    };
-
-    // Async executor uses Futures
-    class async_executor : public executor_base
-    {
-    public:
-        void enqueue(std::vector<std::function<void()>>& tasks) override
-        {
-            std::vector<std::future<void>> futures;
-        
-            for (auto &task : tasks)
-            {
-                futures.emplace_back(std::async(std::launch::async, task));
-            }
-
-            for (auto &future : futures)
-            {
-                future.get();
-            }
-        }
-
-        static std::shared_ptr<executor_base> make()
-        {
-            return std::make_shared<async_executor>();
-        }
-
-        std::shared_ptr<executor_base> clone() const override
-        {
-            return std::make_shared<async_executor>(*this);
-        }
-
-        ~async_executor() override = default;
-    };
-
 
     class Timer
     {
@@ -246,10 +158,11 @@ namespace gp_std
     class Task
     {
     public:
-        Task(const char *name, std::function<void()> func) : m_name(std::move(name)), m_func(std::move(func)), m_execution_status(false) {}
+        Task(const char *name, task_function func) : m_name(std::move(name)), m_func(std::move(func)), m_execution_status(false), m_error_status(false), m_execution_rank(0), m_pending_dependencies(0) {}
 
-        Task(const Task &other) : m_name(other.m_name), m_func(other.m_func), m_execution_status(other.m_execution_status.load()) {}
-        Task(Task &&other) : m_name(std::move(other.m_name)), m_func(std::move(other.m_func)), m_execution_status(other.m_execution_status.load()) {}
+        // Move only, like the function it owns
+        Task(const Task &other) = delete;
+        Task(Task &&other) noexcept : m_name(std::move(other.m_name)), m_func(std::move(other.m_func)), m_execution_status(other.m_execution_status.load()), m_error_status(other.m_error_status.load()), m_execution_rank(other.m_execution_rank), m_dependencies(std::move(other.m_dependencies)), m_pending_dependencies(0) {}
 
         void add_dependency(Stable_VectorIdxPtr<Task> &task)
         {
@@ -367,11 +280,11 @@ namespace gp_std
             return m_name.compare(other) == 0;
         }
 
-        void set_function(std::function<void()> func) { m_func = std::move(func); }
+        void set_function(task_function func) { m_func = std::move(func); }
 
     private:
         friend class taskflowgraph;
-        bool execute(std::vector<std::string> &exceptions, std::map<std::string, std::pair<double, double>> &execution_times, const Timer &timer, std::atomic<uint32_t> &executed_task_rank)
+        bool execute(const Timer &timer, std::atomic<uint32_t> &executed_task_rank)
         {
             if (m_execution_status.load())
             {
@@ -417,39 +330,49 @@ namespace gp_std
                     }
                     catch (const std::exception &e)
                     {
-                        exceptions.emplace_back(std::string("sleep_for() threw exception: ") + e.what());
+                        m_error = std::string("sleep_for() threw exception: ") + e.what();
                         m_error_status.store(true);
                         return false;
                     }
                     catch (...)
                     {
-                        exceptions.emplace_back("sleep_for() threw exception.");
+                        m_error = "sleep_for() threw exception.";
                         m_error_status.store(true);
                         return false;
                     }
                 }
             }
 
+            return run(timer, executed_task_rank);
+        }
+
+        // Runs the task function and records its outcome, dependencies must already be satisfied
+        // Only this task's own trace slot is written, so concurrent tasks never share timing or error storage
+        bool run(const Timer &timer, std::atomic<uint32_t> &executed_task_rank)
+        {
+            m_trace.thread = std::this_thread::get_id();
+            m_trace.start_time = timer.now();
+
             try
             {
                 m_func();
             }
             catch (const std::exception &e)
             {
-                exceptions.emplace_back((m_name + " threw exception: ") + e.what());
-                execution_times.erase(m_name);
+                m_error = (m_name + " threw exception: ") + e.what();
+                m_trace.end_time = timer.now();
                 m_error_status.store(true);
                 return false;
             }
             catch (...)
             {
-                exceptions.emplace_back(m_name + " threw unknown exception.");
-                execution_times.erase(m_name);
+                m_error = m_name + " threw unknown exception.";
+                m_trace.end_time = timer.now();
                 m_error_status.store(true);
                 return false;
             }
 
-            double end_time = timer.now();
+            m_trace.end_time = timer.now();
 
             m_execution_status.store(true);
            
@@ -457,45 +380,274 @@ namespace gp_std
 
             // Rank the executed task on the basis of completion order
             m_execution_rank = executed_task_rank.fetch_add(1);
-            
-            execution_times[m_name] = {start_time, end_time};
 
             return true;
         }
 
         bool has_error() const { return m_error_status.load(); }
 
+        // Called by whoever submits the task to the executor, the gap up to start_time is queue wait
+        void mark_ready(const Timer &timer) { m_trace.ready_time = timer.now(); }
+
+        void clear_trace()
+        {
+            m_trace = trace_record();
+            m_error.clear();
+        }
+
     private:
         std::string m_name;
-        std::function<void()> m_func;
+        task_function m_func;
         mutable std::atomic<bool> m_execution_status;
         std::atomic<bool> m_error_status;
         uint32_t m_execution_rank;
         std::vector<Stable_VectorIdxPtr<Task>> m_dependencies;
+
+        // Dependency counter scheduling : unfinished predecessors and the tasks to release on completion
+        std::atomic<uint32_t> m_pending_dependencies;
+        std::vector<Task*> m_successors;
+
+    public:
+        // Timing of the last run, times are seconds since the start of the run
+        struct trace_record
+        {
+            trace_record() : ready_time(0.0), start_time(0.0), end_time(0.0), thread() {}
+            double ready_time;
+            double start_time;
+            double end_time;
+            std::thread::id thread;
+        };
+
+        const trace_record &trace() const { return m_trace; }
+        const std::string &error() const { return m_error; }
+
+    private:
+        // Preallocated, single writer per run : the task itself while it runs, the graph once the run joined
+        trace_record m_trace;
+        std::string m_error;
+    };
+
+
+    // How taskflowgraph::execute() decides when a task may run
+    enum class scheduling_mode
+    {
+        // Repeatedly scans the graph and enqueues every task whose dependencies finished (one batch per wave)
+        wavefront,
+        // Every task counts its unfinished predecessors, the last predecessor to finish submits it
+        // Executors with spawn support receive successors directly, the others get one batch per wave
+        dependency_counter
     };
 
+    /// @brief Frozen, contiguous execution plan of a taskflowgraph
+    /// @note  Built once by taskflowgraph::compile(), then run() as often as needed with no name lookups,
+    /// @note  no map inserts and no allocation : counters, timings and the per level batches are preallocated
+    /// @note  Nodes are stored in topological order grouped by level (longest path from a root)
+    /// @warning The graph must outlive the plan, any structural change to the graph makes run() throw
+    class compiled_taskflow
+    {
+    public:
+        compiled_taskflow() = default;
+        compiled_taskflow(compiled_taskflow &&) = default;
+        compiled_taskflow &operator=(compiled_taskflow &&) = default;
+
+        // Resets the plan and executes every node once
+        void run()
+        {
+            check_plan();
+            reset();
+
+            plan_data &plan = *m_plan;
+            plan.timer.reset();
+
+            if (plan.nodes.empty())
+                return;
+
+            if (plan.scheduler.supports_spawn())
+            {
+                plan.latch.reset(plan.nodes.size());
+                for (uint32_t i = plan.level_begin[0]; i < plan.level_begin[1]; ++i)
+                {
+                    spawn_node(&plan, i);
+                }
+                plan.scheduler.wait(plan.latch);
+            }
+            else
+            {
+                for (auto &batch : plan.level_batches)
+                {
+                    plan.scheduler.enqueue(batch);
+                    if (plan.aborted.load())
+                        break;
+                }
+            }
+        }
+
+        // Restores the dependency counters and clears the results of the last run
+        void reset()
+        {
+            check_plan();
+            plan_data &plan = *m_plan;
+
+            for (size_t i = 0; i < plan.nodes.size(); ++i)
+            {
+                plan.pending[i].store(plan.nodes[i].initial_pending, std::memory_order_relaxed);
+                plan.start_times[i] = 0.0;
+                plan.end_times[i] = 0.0;
+                plan.executed[i] = 0;
+            }
+
+            plan.aborted.store(false);
+            plan.exceptions.clear();
+        }
+
+        void set_executor(executor scheduler)
+        {
+            check_plan();
+            m_plan->scheduler = scheduler;
+        }
+
+        bool valid() const { return m_plan != nullptr; }
+
+        size_t node_count() const { return m_plan ? m_plan->nodes.size() : 0; }
+        size_t level_count() const { return m_plan ? m_plan->level_batches.size() : 0; }
+
+        // Node accessors, node indices follow the topological order of the plan
+        const std::string &name(size_t node) const { return m_plan->nodes.at(node).task->name(); }
+        uint32_t level(size_t node) const { return m_plan->nodes.at(node).level; }
+        bool is_executed(size_t node) const { return m_plan->executed.at(node) != 0; }
+        double start_time(size_t node) const { return m_plan->start_times.at(node); }
+        double end_time(size_t node) const { return m_plan->end_times.at(node); }
+
+        bool has_exceptions() const { return m_plan && !m_plan->exceptions.empty(); }
+        const std::vector<std::string> &exceptions() const { return m_plan->exceptions; }
+
+    private:
+        friend class taskflowgraph;
+
+        struct plan_node
+        {
+            task_function* func;
+            const Task* task;
+            uint32_t first_successor;
+            uint32_t successor_count;
+            uint32_t initial_pending;
+            uint32_t level;
+        };
+
+        // Heap allocated so that the prebuilt batches can point at it while the handle moves around
+        struct plan_data
+        {
+            std::vector<plan_node> nodes;
+            std::vector<uint32_t> successors;      // Flattened successor lists, indexed by plan_node::first_successor
+            std::vector<uint32_t> level_begin;     // Nodes of level l are [level_begin[l], level_begin[l + 1])
+            std::vector<std::vector<task_function>> level_batches;
+
+            std::unique_ptr<std::atomic<uint32_t>[]> pending;
+            std::vector<double> start_times;
+            std::vector<double> end_times;
+            std::vector<uint8_t> executed;
+
+            executor scheduler;
+            Timer timer;
+            task_latch latch;
+            std::atomic<bool> aborted;
+            std::mutex exceptions_mutex;
+            std::vector<std::string> exceptions;
+
+            const uint64_t* graph_version;
+            uint64_t compiled_version;
+        };
+
+        explicit compiled_taskflow(std::unique_ptr<plan_data> plan) : m_plan(std::move(plan)) {}
+
+        void check_plan() const
+        {
+            if (!m_plan)
+                throw std::runtime_error("compiled_taskflow is empty\n");
+            if (*m_plan->graph_version != m_plan->compiled_version)
+                throw std::runtime_error("compiled_taskflow is stale, the graph changed after compile()\n");
+        }
+
+        static void run_node(plan_data* plan, uint32_t index)
+        {
+            if (plan->aborted.load(std::memory_order_relaxed))
+                return;
+
+            plan->start_times[index] = plan->timer.now();
+            try
+            {
+                (*plan->nodes[index].func)();
+                plan->executed[index] = 1;
+            }
+            catch (const std::exception &e)
+            {
+                record_exception(plan, index, e.what());
+            }
+            catch (...)
+            {
+                record_exception(plan, index, "unknown exception");
+            }
+            plan->end_times[index] = plan->timer.now();
+        }
+
+        static void record_exception(plan_data* plan, uint32_t index, const char* what)
+        {
+            plan->aborted.store(true);
+            std::lock_guard<std::mutex> lock(plan->exceptions_mutex);
+            plan->exceptions.emplace_back(plan->nodes[index].task->name() + " threw exception: " + what);
+        }
+
+        static void spawn_node(plan_data* plan, uint32_t index)
+        {
+            plan->scheduler.spawn([plan, index]()
+            {
+                run_node(plan, index);
+
+                const plan_node &node = plan->nodes[index];
+                for (uint32_t s = node.first_successor; s < node.first_successor + node.successor_count; ++s)
+                {
+                    uint32_t successor = plan->successors[s];
+                    if (plan->pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        spawn_node(plan, successor);
+                }
+
+                plan->latch.count_down();
+            });
+        }
+
+    private:
+        std::unique_ptr<plan_data> m_plan;
+    };
 
     class taskflowgraph
     {
     public:
-        taskflowgraph() : m_tasks(), m_tasks_map(), m_executor(async_executor::make()), m_timer(), m_execution_times(), m_exceptions() {}
+        taskflowgraph() : m_tasks(), m_tasks_map(), m_executor(async_executor::make()), m_timer(), m_exceptions(), m_version(0), m_scheduling(scheduling_mode::wavefront), m_run_rank(0), m_run_aborted(false) {}
         
         void set_executor(executor executor)
         {
             m_executor = executor;
         }
 
-        void add_task(const char *name, std::function<void()> func)
+        void set_scheduling(scheduling_mode mode)
+        {
+            m_scheduling = mode;
+        }
+
+        scheduling_mode scheduling() const { return m_scheduling; }
+
+        void add_task(const char *name, task_function func)
         {
             auto it = (find_task(name));
             if (it != nullptr)
             {
                 if((*it) != nullptr) {
-                  (*it)->set_function(func);
+                  (*it)->set_function(std::move(func));
                   return;
                 }
             }
-            m_tasks.emplace_back(name, func);
+            m_tasks.emplace_back(name, std::move(func));
+            ++m_version;
             m_tasks_map.emplace(name, Stable_VectorIdxPtr<Task>(m_tasks, m_tasks.size() - 1));
         }
 
@@ -541,6 +693,7 @@ namespace gp_std
             }
 
             (*task)->add_dependency((*dependency));
+            ++m_version;
         }
 
         void remove_dependency(const char *dependent_name, const char *dependency_name)
@@ -554,43 +707,191 @@ namespace gp_std
             }
 
             (*task)->remove_dependency((*dependency));
+            ++m_version;
         }
 
         void execute()
         {
+            if (m_scheduling == scheduling_mode::dependency_counter)
+            {
+                execute_dependency_counter();
+                return;
+            }
+
             std::atomic<uint32_t> executed_tasks_rank(0);
 
-            m_execution_times.clear();
+            begin_run();
             
-            std::vector<std::function<void()>> curr_batch;
+            // The batch storage is kept across passes and calls, only the contents are rebuilt
+            std::vector<task_function>& curr_batch = m_batch;
 
             while (all_tasks_executed() == false)
             {
+                curr_batch.clear();
+
                 for (Task &task : m_tasks)
                 {
                     if(task.has_error())
                     {
+                        end_run();
                         print_exceptions();
                         return;
                     }
 
-                    if (!task.is_executed())
+                    // Only enqueue the wavefront whose dependencies already finished,
+                    // pooled executors would otherwise park workers on tasks that can not run yet
+                    if (!task.is_executed() && task.ready())
                     {
-                        auto& rank  = executed_tasks_rank;
-                        curr_batch.emplace_back([this, &task, &rank]()
+                        Task* task_ptr = &task;
+                        std::atomic<uint32_t>* rank = &executed_tasks_rank;
+                        task.mark_ready(m_timer);
+                        curr_batch.emplace_back([this, task_ptr, rank]()
                         {
-                            task.execute(m_exceptions, m_execution_times, m_timer, rank);
+                            task_ptr->execute(m_timer, *rank);
                         });
                     }
                 }
 
+                if (curr_batch.empty())
+                {
+                    end_run();
+                    printf("No runnable task left, remaining tasks depend on unfinished work\n");
+                    return;
+                }
+
                 m_executor.enqueue(curr_batch);
-                curr_batch.clear();
             }
 
+            curr_batch.clear();
+            end_run();
+
             printf("All Tasks Executed\n");
         }
 
+        /// @brief Freezes the current shape of the graph into a reusable execution plan
+        /// @note  Detects cycles, computes a topological order with levels and resolves every dependency to an index
+        /// @note  The plan starts out with the executor of the graph, see compiled_taskflow::set_executor()
+        compiled_taskflow compile()
+        {
+            const size_t count = m_tasks.size();
+
+            std::vector<uint32_t> in_degree(count, 0);
+            std::vector<std::vector<uint32_t>> successors(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                for (Stable_VectorIdxPtr<Task> &dep : m_tasks[i].get_dependencies())
+                {
+                    successors[dep.index()].push_back(static_cast<uint32_t>(i));
+                    ++in_degree[i];
+                }
+            }
+
+            // Kahn's algorithm, a node's level is the longest path leading to it
+            std::vector<uint32_t> order;
+            std::vector<uint32_t> levels(count, 0);
+            std::vector<uint32_t> remaining(in_degree);
+            order.reserve(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (in_degree[i] == 0)
+                    order.push_back(static_cast<uint32_t>(i));
+            }
+
+            for (size_t head = 0; head < order.size(); ++head)
+            {
+                uint32_t current = order[head];
+                for (uint32_t successor : successors[current])
+                {
+                    levels[successor] = std::max(levels[successor], levels[current] + 1);
+                    if (--remaining[successor] == 0)
+                        order.push_back(successor);
+                }
+            }
+
+            if (order.size() != count)
+            {
+                std::string error("Circular Dependency Detected while compiling taskflowgraph");
+                for (size_t i = 0; i < count; ++i)
+                {
+                    if (remaining[i] != 0 && m_tasks[i].find_cyclic_dependency(&m_tasks[i]) != nullptr)
+                    {
+                        error += " at " + m_tasks[i].name();
+                        break;
+                    }
+                }
+                throw std::runtime_error(error.c_str());
+            }
+
+            // Group the topological order by level, keeps the order valid and makes each level contiguous
+            uint32_t level_count = 0;
+            for (uint32_t level : levels)
+                level_count = std::max(level_count, level + 1);
+
+            std::unique_ptr<compiled_taskflow::plan_data> plan(new compiled_taskflow::plan_data());
+            plan->level_begin.assign(level_count + 1, 0);
+            for (uint32_t level : levels)
+                ++plan->level_begin[level + 1];
+            for (uint32_t l = 0; l < level_count; ++l)
+                plan->level_begin[l + 1] += plan->level_begin[l];
+
+            std::vector<uint32_t> position(count);
+            std::vector<uint32_t> task_of(count);
+            std::vector<uint32_t> cursor(plan->level_begin.begin(), plan->level_begin.end() - 1);
+            for (uint32_t task_index : order)
+            {
+                position[task_index] = cursor[levels[task_index]]++;
+                task_of[position[task_index]] = task_index;
+            }
+
+            plan->nodes.resize(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                compiled_taskflow::plan_node &node = plan->nodes[position[i]];
+                node.func = &m_tasks[i].m_func;
+                node.task = &m_tasks[i];
+                node.initial_pending = in_degree[i];
+                node.level = levels[i];
+            }
+
+            uint32_t offset = 0;
+            for (size_t n = 0; n < count; ++n)
+            {
+                plan->nodes[n].first_successor = offset;
+                plan->nodes[n].successor_count = 0;
+                offset += static_cast<uint32_t>(successors[task_of[n]].size());
+            }
+
+            plan->successors.resize(offset);
+            for (size_t i = 0; i < count; ++i)
+            {
+                compiled_taskflow::plan_node &node = plan->nodes[position[i]];
+                for (uint32_t successor : successors[i])
+                    plan->successors[node.first_successor + node.successor_count++] = position[successor];
+            }
+
+            plan->level_batches.resize(level_count);
+            compiled_taskflow::plan_data* plan_ptr = plan.get();
+            for (uint32_t l = 0; l < level_count; ++l)
+            {
+                plan->level_batches[l].reserve(plan->level_begin[l + 1] - plan->level_begin[l]);
+                for (uint32_t n = plan->level_begin[l]; n < plan->level_begin[l + 1]; ++n)
+                    plan->level_batches[l].emplace_back([plan_ptr, n]() { compiled_taskflow::run_node(plan_ptr, n); });
+            }
+
+            plan->pending.reset(new std::atomic<uint32_t>[count]);
+            plan->start_times.assign(count, 0.0);
+            plan->end_times.assign(count, 0.0);
+            plan->executed.assign(count, 0);
+            plan->aborted.store(false);
+            plan->scheduler = m_executor;
+            plan->graph_version = &m_version;
+            plan->compiled_version = m_version;
+
+            compiled_taskflow compiled(std::move(plan));
+            compiled.reset();
+            return compiled;
+        }
+
         //+-------------------------------------------------------------------------------------------------+
         // Performance tracking, Visualization, Error handling & Debugging
         //+-------------------------------------------------------------------------------------------------+
@@ -599,7 +900,7 @@ namespace gp_std
         void export_to_graphviz(const char* filename)
         {  
             std::string dot_file_name(std::string(filename) + std::string(".dot"));
-            std::ofstream file(.c_str());
+            std::ofstream file(dot_file_name.c_str());
             file << "digraph taskflowgraph {\n";
 
             for (Task &task : m_tasks)
@@ -607,12 +908,10 @@ namespace gp_std
                 file << "  " << task.name() << " [label=\"" << task.name() << "\"];\n";
 
                 // Add execution time
-                std::map<std::string, std::pair<double, double>>::iterator it = m_execution_times.find(task.name());
-
-                if (it != m_execution_times.end())
+                if (task.is_executed())
                 {
                     // Add Execution Time
-                    file << "  " << task.name() << " [label=\"" << task.name() << "\\n Rank-" << task.execution_rank() << "---> Time : " << it->second.first << "s - " << it->second.second << "s\"];\n";
+                    file << "  " << task.name() << " [label=\"" << task.name() << "\\n Rank-" << task.execution_rank() << "---> Time : " << task.trace().start_time << "s - " << task.trace().end_time << "s\"];\n";
                 }
                 else
                 {
@@ -635,6 +934,113 @@ namespace gp_std
             system(cmd.c_str());
         }
 
+        // Writes the last run in the Chrome trace event format, open it in chrome://tracing or ui.perfetto.dev
+        // One complete event per executed task on its worker thread, the critical path is flagged in the args
+        void export_to_chrome_trace(const char* filename) const
+        {
+            std::string json_file_name(std::string(filename) + std::string(".json"));
+            std::ofstream file(json_file_name.c_str());
+
+            if (!file.is_open())
+            {
+                printf("Unable to open %s for writing\n", json_file_name.c_str());
+                return;
+            }
+
+            std::vector<const Task*> critical_path = find_critical_path();
+            std::vector<bool> on_critical_path(m_tasks.size(), false);
+            for (const Task* task : critical_path)
+                on_critical_path[task - m_tasks.data()] = true;
+
+            // Small stable tids in order of first appearance
+            std::map<std::thread::id, uint32_t> thread_ids;
+
+            // Times are microseconds, fixed notation keeps the sub microsecond digits of long runs
+            file << std::fixed << std::setprecision(3);
+            file << "{\"traceEvents\":[\n";
+            bool first = true;
+
+            for (size_t i = 0; i < m_tasks.size(); ++i)
+            {
+                const Task &task = m_tasks[i];
+                if (!task.is_executed())
+                    continue;
+
+                const Task::trace_record &trace = task.trace();
+                uint32_t tid = thread_ids.emplace(trace.thread, static_cast<uint32_t>(thread_ids.size())).first->second;
+
+                double queue_wait_us = (trace.start_time - trace.ready_time) * 1e6;
+                if (queue_wait_us < 0.0)
+                    queue_wait_us = 0.0;
+
+                file << (first ? "" : ",\n")
+                     << "{\"name\":\"" << json_escape(task.name()) << "\","
+                     << "\"cat\":\"" << (on_critical_path[i] ? "task,critical" : "task") << "\","
+                     << "\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ","
+                     << "\"ts\":" << trace.start_time * 1e6 << ","
+                     << "\"dur\":" << (trace.end_time - trace.start_time) * 1e6 << ","
+                     << "\"args\":{\"queue_wait_us\":" << queue_wait_us << ","
+                     << "\"run_us\":" << (trace.end_time - trace.start_time) * 1e6 << ","
+                     << "\"rank\":" << task.execution_rank() << ","
+                     << "\"critical\":" << (on_critical_path[i] ? "true" : "false") << "}}";
+                first = false;
+            }
+
+            for (const std::pair<const std::thread::id, uint32_t> &thread : thread_ids)
+            {
+                file << (first ? "" : ",\n")
+                     << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.second << ","
+                     << "\"args\":{\"name\":\"worker-" << thread.second << "\"}}";
+                first = false;
+            }
+
+            std::string path;
+            for (const Task* task : critical_path)
+            {
+                if (!path.empty())
+                    path += " -> ";
+                path += task->name();
+            }
+
+            double critical_path_us = critical_path.empty() ? 0.0 : (critical_path.back()->trace().end_time - critical_path.front()->trace().start_time) * 1e6;
+
+            file << "\n],\n\"displayTimeUnit\":\"ms\",\n"
+                 << "\"otherData\":{\"critical_path\":\"" << json_escape(path) << "\","
+                 << "\"critical_path_us\":" << critical_path_us << "}}\n";
+            file.close();
+        }
+
+        // Longest dependency chain of the last run, walked back from the task that finished last
+        // through the dependency that finished last at each step, returned in execution order
+        std::vector<const Task*> find_critical_path() const
+        {
+            std::vector<const Task*> path;
+
+            const Task* current = nullptr;
+            for (const Task &task : m_tasks)
+            {
+                if (task.is_executed() && (current == nullptr || task.trace().end_time > current->trace().end_time))
+                    current = &task;
+            }
+
+            while (current != nullptr)
+            {
+                path.push_back(current);
+
+                const Task* latest = nullptr;
+                for (const Stable_VectorIdxPtr<Task> &dep : current->get_dependencies())
+                {
+                    const Task* dep_task = &(*dep);
+                    if (dep_task->is_executed() && (latest == nullptr || dep_task->trace().end_time > latest->trace().end_time))
+                        latest = dep_task;
+                }
+                current = latest;
+            }
+
+            std::reverse(path.begin(), path.end());
+            return path;
+        }
+
         // Error handling & Debugging
         bool has_exceptions() const { return !(m_exceptions.empty()); }
 
@@ -666,18 +1072,208 @@ namespace gp_std
         }
 
     private:
+        // Tasks that still have to run get a fresh trace, traces of already executed tasks are kept
+        void begin_run()
+        {
+            // Trace times count from here
+            m_timer.reset();
+            for (Task &task : m_tasks)
+            {
+                if (!task.is_executed())
+                    task.clear_trace();
+            }
+        }
+
+        // Serial merge once the executor joined, the only place per-task errors reach the shared list
+        void end_run()
+        {
+            for (Task &task : m_tasks)
+            {
+                if (!task.is_executed() && !task.error().empty())
+                    m_exceptions.push_back(task.error());
+            }
+        }
+
+        static std::string json_escape(const std::string &str)
+        {
+            std::string escaped;
+            escaped.reserve(str.size());
+            for (char c : str)
+            {
+                switch (c)
+                {
+                case '"': escaped += "\\\""; break;
+                case '\\': escaped += "\\\\"; break;
+                case '\n': escaped += "\\n"; break;
+                case '\r': escaped += "\\r"; break;
+                case '\t': escaped += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        char buf[8];
+                        snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                        escaped += buf;
+                    }
+                    else
+                    {
+                        escaped += c;
+                    }
+                }
+            }
+            return escaped;
+        }
+
         std::vector<Task> m_tasks;
         std::map<std::string, Stable_VectorIdxPtr<Task>> m_tasks_map;
 
         // executor
         executor m_executor;
 
-        // Performance tracking
+        // Performance tracking, each task keeps its own trace_record
         Timer m_timer;
-        std::map<std::string, std::pair<double, double>> m_execution_times;
 
         // Error handling
         std::vector<std::string> m_exceptions;
+
+        // Reused between passes of execute()
+        std::vector<task_function> m_batch;
+
+        // Bumped on every structural change, lets compiled plans detect that they are stale
+        uint64_t m_version;
+
+        // Dependency counter scheduling
+        scheduling_mode m_scheduling;
+        std::vector<Task*> m_ready;
+        std::mutex m_ready_mutex;
+        std::atomic<uint32_t> m_run_rank;
+        std::atomic<bool> m_run_aborted;
+        task_latch m_run_latch;
+
+        // Fills the successor lists and the pending counters, returns the number of tasks left to run
+        size_t prepare_dependency_counters()
+        {
+            for (Task &task : m_tasks)
+            {
+                task.m_successors.clear();
+            }
+
+            size_t to_run = 0;
+            for (Task &task : m_tasks)
+            {
+                if (task.is_executed())
+                    continue;
+
+                uint32_t pending = 0;
+                for (Stable_VectorIdxPtr<Task> &dep : task.get_dependencies())
+                {
+                    Task* dependency = dep;
+                    if (!dependency->is_executed())
+                    {
+                        dependency->m_successors.push_back(&task);
+                        ++pending;
+                    }
+                }
+
+                task.m_pending_dependencies.store(pending, std::memory_order_relaxed);
+                ++to_run;
+            }
+            return to_run;
+        }
+
+        // Runs one task (unless an earlier task failed) and releases the successors it was the last predecessor of
+        template <typename OnReady>
+        void run_and_release(Task* task, OnReady on_ready)
+        {
+            if (!m_run_aborted.load(std::memory_order_relaxed))
+            {
+                if (!task->run(m_timer, m_run_rank))
+                    m_run_aborted.store(true);
+            }
+
+            // Successors are still released after a failure so that every counter reaches zero and the run drains
+            for (Task* successor : task->m_successors)
+            {
+                if (successor->m_pending_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    successor->mark_ready(m_timer);
+                    on_ready(successor);
+                }
+            }
+        }
+
+        void spawn_task(Task* task)
+        {
+            m_executor.spawn([this, task]()
+            {
+                run_and_release(task, [this](Task* successor) { spawn_task(successor); });
+                m_run_latch.count_down();
+            });
+        }
+
+        void execute_dependency_counter()
+        {
+            begin_run();
+            m_run_rank.store(0);
+            m_run_aborted.store(false);
+
+            size_t to_run = prepare_dependency_counters();
+
+            m_ready.clear();
+            for (Task &task : m_tasks)
+            {
+                if (!task.is_executed() && task.m_pending_dependencies.load(std::memory_order_relaxed) == 0)
+                {
+                    task.mark_ready(m_timer);
+                    m_ready.push_back(&task);
+                }
+            }
+
+            if (m_executor.supports_spawn())
+            {
+                // Successors go straight to the executor the moment their last predecessor finishes
+                m_run_latch.reset(to_run);
+                for (Task* task : m_ready)
+                {
+                    spawn_task(task);
+                }
+                m_executor.wait(m_run_latch);
+            }
+            else
+            {
+                // Batch executors : each wave holds exactly the tasks released by the previous one, no rescans
+                std::vector<Task*> wave;
+                while (!m_ready.empty())
+                {
+                    wave.swap(m_ready);
+                    m_ready.clear();
+
+                    m_batch.clear();
+                    for (Task* task : wave)
+                    {
+                        m_batch.emplace_back([this, task]()
+                        {
+                            run_and_release(task, [this](Task* successor)
+                            {
+                                std::lock_guard<std::mutex> lock(m_ready_mutex);
+                                m_ready.push_back(successor);
+                            });
+                        });
+                    }
+                    m_executor.enqueue(m_batch);
+                }
+                m_batch.clear();
+            }
+
+            end_run();
+
+            if (m_run_aborted.load())
+            {
+                print_exceptions();
+                return;
+            }
+
+            printf("All Tasks Executed\n");
+        }
     };
 } // namespace gp_std
 #endif
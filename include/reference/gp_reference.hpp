@@ -2,10 +2,13 @@
 #define _GP_STD_REFERENCE_TYPES_
 
 
-#include <array>
 #include <stdexcept>
 #include <cassert>
-#include "gp_atomic.hpp"
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include "../parallel/gp_atomic.hpp"
+#include "../memory/gp_ref_count.hpp"
 
 #define GP_ASSERT(x) assert(x) 
 
@@ -26,6 +29,173 @@ namespace gp_std
 
     template <typename T>
     using atomic_sync_ref = sync_ref<T, gp_std::atomic>;
+
+    namespace reference_detail
+    {
+        /// @brief Storage for the shared slots of sync_ref, one pool per slot type
+        /// @note  Each thread takes slots from a free list of its own and refills it a slab at a time,
+        /// @note  a freed slot joins the free list of the thread freeing it. Lists that grow past two slabs
+        /// @note  hand one slab worth of slots to the shared list, so one thread freeing what another creates stays bounded.
+        /// @note  The shared list is the only lock, taken once per slab_slots slots at most. Slabs are never freed,
+        /// @note  the pool holds the most slots ever alive at once.
+        template <typename Slot>
+        class slot_pool
+        {
+        public:
+            static constexpr std::size_t slab_slots = 256;
+
+            // Raw memory for one Slot
+            static void* acquire()
+            {
+                local_list* local = local_slots();
+                if (local == nullptr)
+                    return take_shared();
+
+                if (local->head == nullptr)
+                    refill(*local);
+
+                node* slot = local->head;
+                local->head = slot->next;
+                --local->count;
+                return slot;
+            }
+
+            static void give_back(void* memory) noexcept
+            {
+                node* slot = static_cast<node*>(memory);
+                local_list* local = local_slots();
+                if (local == nullptr)
+                {
+                    push_shared(slot, slot, 1);
+                    return;
+                }
+
+                slot->next = local->head;
+                local->head = slot;
+                if (++local->count >= 2 * slab_slots)
+                    spill(*local, slab_slots);
+            }
+
+        private:
+            union node
+            {
+                node* next;
+                alignas(Slot) unsigned char storage[sizeof(Slot)];
+            };
+
+            struct local_list
+            {
+                node* head = nullptr;
+                std::size_t count = 0;
+
+                // An exiting thread hands its free slots to the others
+                ~local_list()
+                {
+                    torn_down() = true;
+                    spill(*this, count);
+                }
+            };
+
+            struct shared_list
+            {
+                gp_std::spinlock lock{ gp_std::stats::lock_site::sync_ref_pool };
+                node* head = nullptr;
+                std::size_t count = 0;
+            };
+
+            static shared_list& shared_slots()
+            {
+                static shared_list* list = new shared_list(); // outlives every thread_local list spilling into it
+                return *list;
+            }
+
+            static bool& torn_down() noexcept
+            {
+                static thread_local bool flag = false;
+                return flag;
+            }
+
+            static local_list* local_slots() noexcept
+            {
+                if (torn_down())
+                    return nullptr;
+                static thread_local local_list list;
+                return &list;
+            }
+
+            // Up to a slab of slots from the shared list, a new slab when it is empty
+            static void refill(local_list& local)
+            {
+                {
+                    shared_list& shared = shared_slots();
+                    std::lock_guard<gp_std::spinlock> guard(shared.lock);
+                    while (shared.head != nullptr && local.count < slab_slots)
+                    {
+                        node* slot = shared.head;
+                        shared.head = slot->next;
+                        --shared.count;
+                        slot->next = local.head;
+                        local.head = slot;
+                        ++local.count;
+                    }
+                }
+                if (local.head != nullptr)
+                    return;
+
+                node* slab = static_cast<node*>(::operator new(slab_slots * sizeof(node)));
+                for (std::size_t i = 0; i + 1 < slab_slots; ++i)
+                    slab[i].next = &slab[i + 1];
+                slab[slab_slots - 1].next = nullptr;
+                local.head = slab;
+                local.count = slab_slots;
+            }
+
+            // The first count slots of local go to the shared list
+            static void spill(local_list& local, std::size_t count) noexcept
+            {
+                if (count == 0 || local.head == nullptr)
+                    return;
+
+                node* first = local.head;
+                node* last = first;
+                std::size_t moved = 1;
+                while (moved < count && last->next != nullptr)
+                {
+                    last = last->next;
+                    ++moved;
+                }
+                local.head = last->next;
+                local.count -= moved;
+                push_shared(first, last, moved);
+            }
+
+            static void push_shared(node* first, node* last, std::size_t count) noexcept
+            {
+                shared_list& shared = shared_slots();
+                std::lock_guard<gp_std::spinlock> guard(shared.lock);
+                last->next = shared.head;
+                shared.head = first;
+                shared.count += count;
+            }
+
+            // Late frees and allocations of a thread whose list is gone
+            static void* take_shared()
+            {
+                {
+                    shared_list& shared = shared_slots();
+                    std::lock_guard<gp_std::spinlock> guard(shared.lock);
+                    if (shared.head != nullptr)
+                    {
+                        node* slot = shared.head;
+                        shared.head = slot->next;
+                        --shared.count;
+                        return slot;
+                    }
+                }
+                return ::operator new(sizeof(node));
+            }
+        };
+    } // namespace reference_detail
    
 
  /// @brief class ptr
@@ -215,56 +385,58 @@ namespace gp_std
     ///  ***  std::cout << *ref2 << std::endl; // Output: 10.0 as ref1 and ref2 are syncronised.
     ///  ***  ref2 = 20.0f;
     ///  ***  std::cout << *ref1 << std::endl; // Output: 20.0 as ref1 and ref2 are syncronised.
+    /// @note The synchronised references share one slot, counted like a shared pointer : the slot goes back to
+    /// @note its pool when the last sync_ref of the group dies. Slots come from per thread slabs, no global lock.
     template <typename T, template <typename...> class base_ptr_type>
     class sync_ref
     {
         using ptr_type = base_ptr_type<T>;
 
-        static gp_std::spinlock& get_spinlock()
+        // The target shared by every sync_ref of a group, and how many of them are alive
+        struct sync_slot
         {
-            static gp_std::spinlock spinlock;
-            return spinlock;
-        }
+            ptr_type target;
+            atomic_ref_count refs;
+        };
 
-        template <typename U>
-        static ptr_type* get_sync_ptr()
+        using pool = reference_detail::slot_pool<sync_slot>;
+
+        static sync_slot* get_sync_ptr()
         {
-            static std::array<ptr_type , 128 * 128> sync_ptrs;
-            get_spinlock().lock();
+            void* memory = pool::acquire();
+            return ::new (memory) sync_slot();
+        }
 
-            static uint32_t curr_index = 0;
-            
-            if (curr_index >= sync_ptrs.size())
+        void release() noexcept
+        {
+            if (ptr_ != nullptr && ptr_->refs.release())
             {
-                get_spinlock().unlock();
-                throw std::runtime_error("Out of memory for sync_ptrs. Increase the size of the array.\n");
+                ptr_->~sync_slot();
+                pool::give_back(ptr_);
             }
-            
-            ptr_type* ptr = &sync_ptrs[curr_index++];
-            get_spinlock().unlock();
-
-            return ptr;
+            ptr_ = nullptr;
         }
 
     public:
         // Constructor
         sync_ref(T& obj)
         {
-           ptr_ = get_sync_ptr<T>();
-          *ptr_ = &obj;
+           ptr_ = get_sync_ptr();
+           ptr_->target = &obj;
         }
 
         // Default constructor
         sync_ref()
         {
-            ptr_ = get_sync_ptr<T>();
-           *ptr_ = nullptr;
+            ptr_ = get_sync_ptr();
+            ptr_->target = nullptr;
         }
 
         // Copy constructor
         sync_ref(const sync_ref &other)
         {
             ptr_ = other.ptr_;
+            if (ptr_ != nullptr) ptr_->refs.add_ref();
         }
 
         // Move constructor
@@ -274,11 +446,13 @@ namespace gp_std
             other.ptr_ = nullptr;
         }
 
-        // Copy assignment
+        // Copy assignment, joins the group of other
         sync_ref &operator=(const sync_ref &other)
         {
-            if (this != &other)
+            if (ptr_ != other.ptr_)
             {
+                if (other.ptr_ != nullptr) other.ptr_->refs.add_ref();
+                release();
                 ptr_ = other.ptr_;
             }
             return *this;
@@ -289,23 +463,29 @@ namespace gp_std
         {
             if (this != &other)
             {
+                release();
                 ptr_ = other.ptr_;
                 other.ptr_ = nullptr;
             }
             return *this;
         }
 
+        ~sync_ref()
+        {
+            release();
+        }
+
         // Nullptr assignment
         sync_ref &operator=(std::nullptr_t)
         {
-            *ptr_ = nullptr;
+            ptr_->target = nullptr;
             return *this;
         }
 
         // Assignment to another object
         sync_ref &operator=(T& obj)
         {
-            *ptr_ = &obj;
+            ptr_->target = &obj;
             return *this;
         }
 
@@ -321,75 +501,75 @@ namespace gp_std
 
         bool operator==(std::nullptr_t) const
         {
-            return *ptr_ == nullptr;
+            return ptr_->target == nullptr;
         }
 
         bool operator!=(std::nullptr_t) const
         {
-            return *ptr_ != nullptr;
+            return ptr_->target != nullptr;
         }
 
         // Dereference operator
         const T& operator*() const
         {
-            return **ptr_;
+            return *ptr_->target;
         }
 
         // Arrow operator
-        const ptr_type* operator->() const
+        const T* operator->() const
         {
-            return *ptr_;
+            return ptr_->target.get();
         }
 
         // Get the underlying pointer
-        const ptr_type* get() const
+        const T* get() const
         {
-            return *ptr_;
+            return ptr_->target.get();
         }
 
         // Non Const Versions
         // Dereference operator
         T& operator*()
         {
-            return **ptr_;
+            return *ptr_->target;
         }
 
         // Arrow operator
         ptr_type operator->() 
         {
-            return *ptr_;
+            return ptr_->target;
         }
 
         // Get the underlying pointer
         ptr_type get()
         {
-            return *ptr_;
+            return ptr_->target;
         }    
 
         void retarget(T& new_obj)
         {
-            *ptr_ = &new_obj;
+            ptr_->target = &new_obj;
         }
 
         void retarget(T* new_obj)
         {
-            *ptr_ = new_obj;
+            ptr_->target = new_obj;
         }
 
         // Set the underlying pointer to a new value
         void reset(T &new_obj)
         {
-            *ptr_ = &new_obj;
+            ptr_->target = &new_obj;
         }
 
         // Check if the sync_ref is valid
         bool valid() const
         {
-            return *ptr_ != nullptr;
+            return ptr_->target != nullptr;
         }
 
     private:
-        ptr_type* ptr_ = nullptr;
+        sync_slot* ptr_ = nullptr;
     };
 
     /// @brief class ref
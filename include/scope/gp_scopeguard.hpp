@@ -80,20 +80,21 @@ namespace gp_std
         template <typename Tuple, typename Func>
         void for_each_in_tuple(Tuple &t, Func func)
         {
-            for_each_in_tuple_impl(t, func, std::integral_constant<std::size_t, 0>{});
+            for_each_in_tuple_impl(t, func, std::integral_constant<std::size_t, 0>{}, std::integral_constant<bool, (0 < std::tuple_size<Tuple>::value)>{});
         }
 
-        // Recursive tuple iteration for C++11
+        // Recursive tuple iteration for C++11, the bool tag tells whether Index is still inside the tuple
         template <typename Tuple, typename Func, std::size_t Index>
-        void for_each_in_tuple_impl(Tuple &t, Func func, std::integral_constant<std::size_t, Index>)
+        void for_each_in_tuple_impl(Tuple &t, Func func, std::integral_constant<std::size_t, Index>, std::true_type)
         {
             func(std::get<Index>(t));                                                          // Apply function to the current element
-            for_each_in_tuple_impl(t, func, std::integral_constant<std::size_t, Index + 1>{}); // Recurse to the next element
+            for_each_in_tuple_impl(t, func, std::integral_constant<std::size_t, Index + 1>{},  // Recurse to the next element
+                                   std::integral_constant<bool, (Index + 1 < std::tuple_size<Tuple>::value)>{});
         }
 
         // Base case to stop recursion
-        template <typename Tuple, typename Func>
-        void for_each_in_tuple_impl(Tuple &, Func, std::integral_constant<std::size_t, std::tuple_size<Tuple>::value>)
+        template <typename Tuple, typename Func, std::size_t Index>
+        void for_each_in_tuple_impl(Tuple &, Func, std::integral_constant<std::size_t, Index>, std::false_type)
         {
             // End of recursion: do nothing
         }
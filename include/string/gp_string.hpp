@@ -1,15 +1,24 @@
 #ifndef GP_STD_STRING_HPP
 #define GP_STD_STRING_HPP
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <set>
 #include <iostream>
 #include <cstring>
 #include <cassert>
+#include <cstdint>
 #include <string>
 #include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
 
 #include "gp_string_view.hpp"
+#include "../memory/gp_pages.hpp"
+#include "../parallel/gp_atomic.hpp"
 
 namespace gp_std
 {
@@ -236,9 +245,8 @@ namespace gp_std
         uint32_t str_len;
     };
 
-    // Constants for the block size and buffer size
+    // Constants for the block size
     static constexpr std::size_t BLOCK_SIZE = 64;
-    static constexpr std::size_t BUFFER_SIZE = 1024 * 1024 * 64; // 64 MB
 
     // Class representing a contiguous memory block segment
     class block
@@ -321,88 +329,729 @@ namespace gp_std
         std::size_t blk_count_; // Number of contiguous 64-char blocks represented
     };
 
-    // Allocator class that manages blocks within the shared buffer
-    class block_allocator
+    // Blocks are carved out of chunks of CHUNK_BLOCKS contiguous blocks, every chunk belongs to one arena
+    static constexpr std::size_t CHUNK_BLOCKS = 1024;
+    static constexpr std::size_t CHUNK_SIZE = CHUNK_BLOCKS * BLOCK_SIZE; // 64 KB
+
+    // Chunks are mapped from the OS in slabs, a power of two between MIN_SLAB_SIZE and MAX_SLAB_SIZE
+    static constexpr std::size_t DEFAULT_SLAB_SIZE = 1024 * 1024 * 2;   // 2 MB
+    static constexpr std::size_t MIN_SLAB_SIZE = CHUNK_SIZE * 2;        // 128 KB
+    static constexpr std::size_t MAX_SLAB_SIZE = 1024 * 1024 * 128;     // 128 MB
+
+    /// @brief Sizing of the memory behind a block_allocator
+    struct block_allocator_options
     {
-    public:
-        // Singleton buffer for all strings
-        static std::array<char, BUFFER_SIZE> &string_buffer()
+        std::size_t initial_size = 0;               // Mapped up front and kept until the allocator is gone
+        std::size_t slab_size = DEFAULT_SLAB_SIZE;  // Memory is mapped and given back to the OS a slab at a time
+        bool huge_pages = false;                    // Ask for huge pages for the slabs
+    };
+
+    namespace string_detail
+    {
+        // A free block, its first bytes link it in the free list of its block count
+        struct free_node
         {
-            static std::array<char, BUFFER_SIZE> buffer{};
-            return buffer;
-        }
+            free_node* next;
+            free_node* prev;
+            std::size_t blk_count;
+        };
+
+        class block_arena;
+
+        // Bookkeeping of one chunk, written by the thread owning the arena the chunk was given to
+        struct chunk_info
+        {
+            block_arena* owner;
+            std::size_t live; // blocks handed out and not freed yet
+        };
+
+        /// @class slab
+        /// @brief Header at the start of a slab, followed by the chunk_info of each chunk and the stack of free chunks
+        /// @note  Slabs are aligned on their size, so the slab of any block is found by masking its address.
+        /// @note  The header takes the front of chunk 0, which is that much shorter than the others.
+        class slab
+        {
+        public:
+            static std::size_t header_size(std::size_t chunk_count)
+            {
+                const std::size_t size = sizeof(slab) + chunk_count * (sizeof(chunk_info) + sizeof(uint32_t));
+                return (size + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+            }
+
+            slab(std::size_t size, bool pinned)
+                : m_size(size), m_chunk_count(size / CHUNK_SIZE), m_free_count(m_chunk_count), m_pinned(pinned)
+            {
+                for (std::size_t i = 0; i < m_chunk_count; ++i)
+                {
+                    ::new (static_cast<void*>(chunks() + i)) chunk_info{ nullptr, 0 };
+                    free_chunks()[i] = static_cast<uint32_t>(m_chunk_count - 1 - i);
+                }
+            }
+
+            chunk_info& info(const char* data)
+            {
+                return chunks()[static_cast<std::size_t>(data - base()) / CHUNK_SIZE];
+            }
+
+            char* chunk_begin(const char* data)
+            {
+                const std::size_t index = static_cast<std::size_t>(data - base()) / CHUNK_SIZE;
+                return index == 0 ? base() + header_size(m_chunk_count) : base() + index * CHUNK_SIZE;
+            }
+
+            char* chunk_end(const char* data)
+            {
+                return base() + (static_cast<std::size_t>(data - base()) / CHUNK_SIZE + 1) * CHUNK_SIZE;
+            }
+
+            ///@brief Start of a free chunk, the slab must have one
+            char* pop_chunk()
+            {
+                const std::size_t index = free_chunks()[--m_free_count];
+                return index == 0 ? base() + header_size(m_chunk_count) : base() + index * CHUNK_SIZE;
+            }
+
+            void push_chunk(const char* data)
+            {
+                free_chunks()[m_free_count++] = static_cast<uint32_t>(static_cast<std::size_t>(data - base()) / CHUNK_SIZE);
+            }
+
+            std::size_t size() const { return m_size; }
+            bool has_free_chunk() const { return m_free_count != 0; }
+            bool is_empty() const { return m_free_count == m_chunk_count; }
+            bool is_pinned() const { return m_pinned; }
+
+        private:
+            char* base() { return reinterpret_cast<char*>(this); }
+            chunk_info* chunks() { return reinterpret_cast<chunk_info*>(this + 1); }
+            uint32_t* free_chunks() { return reinterpret_cast<uint32_t*>(chunks() + m_chunk_count); }
+
+            const std::size_t m_size;
+            const std::size_t m_chunk_count;
+            std::size_t m_free_count;
+            const bool m_pinned;
+        };
+
+        /// @class block_arena
+        /// @brief Free lists and bump range used by one thread at a time
+        /// @note  There is one free list per block count, a block is only reused for a request of the same count
+        /// @note  Only the owning thread touches the free lists, other threads give blocks back through a lock-free list
+        class block_arena
+        {
+        public:
+            // Class i holds the free blocks made of i + 1 blocks
+            static constexpr std::size_t class_count = CHUNK_BLOCKS;
+
+            block_arena()
+                : m_free(), m_bump(nullptr), m_bump_end(nullptr), m_spare(nullptr),
+                  m_remote(nullptr), m_used(0), m_owned(false) {}
+
+            block_arena(const block_arena&) = delete;
+            block_arena& operator=(const block_arena&) = delete;
+
+            ///@brief A free block of exactly blk_count blocks, nullptr if none
+            char* pop(std::size_t blk_count)
+            {
+                free_node* node = m_free[blk_count - 1];
+                if (node == nullptr)
+                    return nullptr;
+
+                unlink(node);
+                return reinterpret_cast<char*>(node);
+            }
+
+            ///@brief Take blk_count blocks from the current chunk, nullptr once the chunk is used up
+            char* bump(std::size_t blk_count)
+            {
+                const std::size_t bytes = blk_count * BLOCK_SIZE;
+                if (static_cast<std::size_t>(m_bump_end - m_bump) < bytes)
+                    return nullptr;
+
+                char* data = m_bump;
+                m_bump += bytes;
+                return data;
+            }
+
+            ///@brief Bump in [begin, end) from now on, what was left of the previous range goes to the free lists
+            void refill(char* begin, char* end)
+            {
+                if (m_bump != m_bump_end)
+                    link(m_bump, static_cast<std::size_t>(m_bump_end - m_bump) / BLOCK_SIZE);
+                m_bump = begin;
+                m_bump_end = end;
+            }
+
+            char* bump_end() const { return m_bump_end; }
+
+            ///@brief True if data lies in the chunk being bumped, which is never given back
+            bool is_bumping(const char* data) const
+            {
+                return m_bump_end != nullptr && data < m_bump_end && m_bump_end - data <= static_cast<std::ptrdiff_t>(CHUNK_SIZE);
+            }
+
+            void link(char* data, std::size_t blk_count)
+            {
+                free_node*& head = m_free[blk_count - 1];
+                free_node* node = ::new (static_cast<void*>(data)) free_node{ head, nullptr, blk_count };
+                if (head != nullptr)
+                    head->prev = node;
+                head = node;
+            }
+
+            void unlink(free_node* node)
+            {
+                if (node->prev != nullptr)
+                    node->prev->next = node->next;
+                else
+                    m_free[node->blk_count - 1] = node->next;
+
+                if (node->next != nullptr)
+                    node->next->prev = node->prev;
+            }
+
+            ///@brief Give a block back from any other thread, the owner picks it up on its next allocation
+            void push_remote(char* data, std::size_t blk_count)
+            {
+                free_node* node = ::new (static_cast<void*>(data)) free_node{ m_remote.load(std::memory_order_relaxed), nullptr, blk_count };
+                while (!m_remote.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+                {
+                }
+            }
+
+            bool has_remote() const { return m_remote.load(std::memory_order_relaxed) != nullptr; }
+
+            ///@brief All the blocks other threads gave back so far, linked by next
+            free_node* take_remote() { return m_remote.exchange(nullptr, std::memory_order_acquire); }
+
+            // A chunk kept aside once emptied, so a thread freeing and allocating around a chunk boundary
+            // does not give the chunk back and claim it again each time
+            char* take_spare()
+            {
+                char* spare = m_spare;
+                m_spare = nullptr;
+                return spare;
+            }
+
+            char* exchange_spare(char* chunk)
+            {
+                char* spare = m_spare;
+                m_spare = chunk;
+                return spare;
+            }
+
+            // Only the owner writes the counter, the atomic is there for readers on other threads
+            void add_used(std::size_t blk_count) { m_used.store(m_used.load(std::memory_order_relaxed) + blk_count, std::memory_order_relaxed); }
+            void sub_used(std::size_t blk_count) { m_used.store(m_used.load(std::memory_order_relaxed) - blk_count, std::memory_order_relaxed); }
+            std::size_t used_bytes() const { return m_used.load(std::memory_order_relaxed) * BLOCK_SIZE; }
+
+            ///@brief Become the owner of an arena nobody owns, the arena is then ours alone until disown()
+            bool try_own()
+            {
+                bool owned = false;
+                return !m_owned.load(std::memory_order_relaxed) && m_owned.compare_exchange_strong(owned, true, std::memory_order_acquire);
+            }
+
+            void disown() { m_owned.store(false, std::memory_order_release); }
+
+        private:
+            std::array<free_node*, class_count> m_free;
+            char* m_bump;
+            char* m_bump_end;
+            char* m_spare;
+            alignas(64) std::atomic<free_node*> m_remote;
+            std::atomic<std::size_t> m_used;
+            std::atomic<bool> m_owned;
+        };
+
+        /// @class block_pool
+        /// @brief Slabs mapped on demand, cut in chunks, and the arenas the chunks were given to
+        /// @note  Each thread gets an arena of its own the first time it allocates, an arena is handed over
+        /// @note  to the next new thread once its thread exits. Blocks never move once handed out.
+        /// @note  A chunk whose blocks are all free goes back to its slab, and a slab whose chunks are all free
+        /// @note  is unmapped, except for the initial slabs and one empty slab kept to absorb the next growth.
+        /// @note  Blocks longer than chunk 0 (what the slab header leaves of it) get a mapping of their own,
+        /// @note  so whichever chunk an arena claims holds the request.
+        class block_pool : public std::enable_shared_from_this<block_pool>
+        {
+        public:
+            explicit block_pool(const block_allocator_options& options)
+                : m_slab_size(slab_size_for(options.slab_size)),
+                  m_huge_pages(options.huge_pages),
+                  m_chunk_blocks(CHUNK_BLOCKS - slab::header_size(m_slab_size / CHUNK_SIZE) / BLOCK_SIZE),
+                  m_id(next_id()),
+                  m_slabs_lock(),
+                  m_slabs(),
+                  m_partial(),
+                  m_spare_slab(nullptr),
+                  m_mapped(0),
+                  m_large_used(0),
+                  m_arenas_lock(),
+                  m_arenas(),
+                  m_fallback_lock(stats::lock_site::string_fallback),
+                  m_fallback()
+            {
+                // The fallback arena goes by its lock, nobody may adopt it
+                m_fallback.try_own();
+
+                std::lock_guard<std::mutex> lock(m_slabs_lock);
+                for (std::size_t mapped = 0; mapped < options.initial_size; mapped += m_slab_size)
+                {
+                    if (map_slab(true) == nullptr)
+                        break;
+                }
+            }
+
+            block_pool(const block_pool&) = delete;
+            block_pool& operator=(const block_pool&) = delete;
+
+           ~block_pool()
+            {
+                for (slab* s : m_slabs)
+                {
+                    stats::record_unmapping(s->size());
+                    pages::unmap(s, s->size());
+                }
+            }
+
+            ///@brief Address of blk_count contiguous blocks, nullptr when the OS is out of memory
+            char* allocate(std::size_t blk_count)
+            {
+                if (blk_count > m_chunk_blocks)
+                    return allocate_large(blk_count);
+
+                block_arena* arena = local_arena(true);
+                if (arena != nullptr)
+                    return allocate_from(*arena, blk_count);
+
+                // The thread is past the destruction of its thread_local objects
+                std::lock_guard<spinlock> lock(m_fallback_lock);
+                return allocate_from(m_fallback, blk_count);
+            }
+
+            void free(char* data, std::size_t blk_count)
+            {
+                if (blk_count > m_chunk_blocks)
+                    return free_large(data, blk_count);
+
+                block_arena* owner = slab_of(data)->info(data).owner;
+                const bool local = owner == local_arena(false);
+                stats::record_block_free(blk_count * BLOCK_SIZE, !local);
+
+                if (local)
+                {
+                    release(*owner, data, blk_count);
+                }
+                else if (owner->try_own())
+                {
+                    // Its thread is gone, nobody would pick up a remote free before the arena is adopted again
+                    release(*owner, data, blk_count);
+                    trim(*owner);
+                    owner->disown();
+                }
+                else
+                {
+                    owner->push_remote(data, blk_count);
+                }
+            }
+
+            ///@brief Bytes mapped and not held by any block in use, blocks freed from another thread count once their arena took them back
+            std::size_t capacity()
+            {
+                const std::size_t mapped = m_mapped.load(std::memory_order_relaxed);
+                return mapped - std::min(mapped, used_bytes());
+            }
+
+            std::size_t used_bytes()
+            {
+                std::lock_guard<std::mutex> lock(m_arenas_lock);
+                std::size_t used = m_fallback.used_bytes() + m_large_used.load(std::memory_order_relaxed);
+                for (const block_arena& arena : m_arenas)
+                    used += arena.used_bytes();
+                return used;
+            }
+
+            ///@brief Bytes of slabs currently mapped
+            std::size_t mapped_bytes() const { return m_mapped.load(std::memory_order_relaxed); }
+
+            std::size_t slab_size() const { return m_slab_size; }
+
+        private:
+            // The arenas a thread took, one per pool it allocated from
+            struct thread_arenas
+            {
+                struct entry
+                {
+                    uint64_t pool_id;
+                    block_arena* arena;
+                    std::weak_ptr<block_pool> pool;
+                };
+
+                std::vector<entry> entries;
+
+               ~thread_arenas()
+                {
+                    torn_down() = true;
+                    for (entry& e : entries)
+                    {
+                        if (std::shared_ptr<block_pool> pool = e.pool.lock())
+                            pool->release_arena(e.arena);
+                    }
+                }
+            };
+
+            static uint64_t next_id()
+            {
+                static std::atomic<uint64_t> id(0);
+                return id.fetch_add(1, std::memory_order_relaxed);
+            }
 
+            static thread_arenas& thread_cache()
+            {
+                static thread_local thread_arenas cache;
+                return cache;
+            }
+
+            // Trivially destructible, still readable while the thread_local objects are destroyed
+            static bool& torn_down()
+            {
+                static thread_local bool flag = false;
+                return flag;
+            }
+
+            static std::size_t slab_size_for(std::size_t requested)
+            {
+                std::size_t size = MIN_SLAB_SIZE;
+                while (size < requested && size < MAX_SLAB_SIZE)
+                    size *= 2;
+                return size;
+            }
+
+            slab* slab_of(const char* data) const
+            {
+                return reinterpret_cast<slab*>(reinterpret_cast<std::uintptr_t>(data) & ~(m_slab_size - 1));
+            }
+
+            block_arena* local_arena(bool create)
+            {
+                if (torn_down())
+                    return nullptr;
+
+                std::vector<thread_arenas::entry>& entries = thread_cache().entries;
+                for (const thread_arenas::entry& e : entries)
+                {
+                    if (e.pool_id == m_id)
+                        return e.arena;
+                }
+
+                if (!create)
+                    return nullptr;
+
+                entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                             [](const thread_arenas::entry& e) { return e.pool.expired(); }),
+                              entries.end());
+
+                block_arena* arena = acquire_arena();
+                entries.push_back(thread_arenas::entry{ m_id, arena, weak_from_this() });
+                return arena;
+            }
+
+            block_arena* acquire_arena()
+            {
+                std::lock_guard<std::mutex> lock(m_arenas_lock);
+                for (block_arena& arena : m_arenas)
+                {
+                    if (arena.try_own())
+                        return &arena;
+                }
+
+                m_arenas.emplace_back();
+                m_arenas.back().try_own();
+                return &m_arenas.back();
+            }
+
+            // Called by the exiting owner
+            void release_arena(block_arena* arena)
+            {
+                trim(*arena);
+                arena->disown();
+            }
+
+            // Give back what an arena without a thread may never need, called by its current owner
+            void trim(block_arena& arena)
+            {
+                drain_remote(arena);
+
+                char* bump_chunk = bump_chunk_of(arena);
+                if (bump_chunk != nullptr && slab_of(bump_chunk)->info(bump_chunk).live == 0)
+                {
+                    arena.refill(nullptr, nullptr);
+                    retire_chunk(arena, bump_chunk);
+                }
+
+                if (char* spare = arena.take_spare())
+                    return_chunk(spare);
+            }
+
+            char* allocate_from(block_arena& arena, std::size_t blk_count)
+            {
+                if (arena.has_remote())
+                    drain_remote(arena);
+
+                char* data = arena.pop(blk_count);
+                if (data == nullptr)
+                    data = arena.bump(blk_count);
+
+                if (data == nullptr)
+                {
+                    char* chunk = arena.take_spare();
+                    if (chunk == nullptr)
+                        chunk = claim_chunk(arena);
+                    if (chunk == nullptr)
+                        return nullptr;
+
+                    char* previous = bump_chunk_of(arena);
+                    arena.refill(chunk, slab_of(chunk)->chunk_end(chunk));
+                    data = arena.bump(blk_count);
+                    if (data == nullptr)
+                        return nullptr;
+
+                    // The chunk we stopped bumping in may have been emptied in the meantime
+                    if (previous != nullptr && slab_of(previous)->info(previous).live == 0)
+                        retire_chunk(arena, previous);
+                }
+
+                slab_of(data)->info(data).live += 1;
+                arena.add_used(blk_count);
+                stats::record_block_allocation(blk_count * BLOCK_SIZE);
+                return data;
+            }
+
+            // Start of the chunk the arena bumps in, nullptr before its first chunk
+            char* bump_chunk_of(block_arena& arena)
+            {
+                char* end = arena.bump_end();
+                return end != nullptr ? slab_of(end - 1)->chunk_begin(end - 1) : nullptr;
+            }
+
+            // Called by the owner of the arena only
+            void release(block_arena& arena, char* data, std::size_t blk_count)
+            {
+                arena.link(data, blk_count);
+                arena.sub_used(blk_count);
+
+                chunk_info& info = slab_of(data)->info(data);
+                if (--info.live == 0 && !arena.is_bumping(data))
+                    retire_chunk(arena, data);
+            }
+
+            void drain_remote(block_arena& arena)
+            {
+                free_node* node = arena.take_remote();
+                while (node != nullptr)
+                {
+                    free_node* next = node->next;
+                    release(arena, reinterpret_cast<char*>(node), node->blk_count);
+                    node = next;
+                }
+            }
+
+            // Every block of an empty chunk is a free node, take them all off the free lists and keep
+            // the chunk as the spare of the arena, the previous spare goes back to its slab
+            void retire_chunk(block_arena& arena, char* data)
+            {
+                slab* s = slab_of(data);
+                char* begin = s->chunk_begin(data);
+                char* end = s->chunk_end(data);
+                for (char* tile = begin; tile < end;)
+                {
+                    free_node* node = reinterpret_cast<free_node*>(tile);
+                    tile += node->blk_count * BLOCK_SIZE;
+                    arena.unlink(node);
+                }
+
+                char* previous = arena.exchange_spare(begin);
+                if (previous != nullptr)
+                    return_chunk(previous);
+            }
+
+            char* claim_chunk(block_arena& arena)
+            {
+                std::lock_guard<std::mutex> lock(m_slabs_lock);
+                if (m_partial.empty() && map_slab(false) == nullptr)
+                    return nullptr;
+
+                slab* s = m_partial.back();
+                if (s == m_spare_slab)
+                    m_spare_slab = nullptr;
+
+                char* chunk = s->pop_chunk();
+                if (!s->has_free_chunk())
+                    m_partial.pop_back();
+
+                s->info(chunk) = chunk_info{ &arena, 0 };
+                return chunk;
+            }
+
+            void return_chunk(char* chunk)
+            {
+                stats::record_chunk_returned();
+                std::lock_guard<std::mutex> lock(m_slabs_lock);
+                slab* s = slab_of(chunk);
+                if (!s->has_free_chunk())
+                    m_partial.push_back(s);
+
+                s->info(chunk).owner = nullptr;
+                s->push_chunk(chunk);
+                if (!s->is_empty() || s->is_pinned())
+                    return;
+
+                // Keep one empty slab around, unmap the one it replaces
+                slab* unmapped = m_spare_slab;
+                m_spare_slab = s;
+                if (unmapped != nullptr)
+                    unmap_slab(unmapped);
+            }
+
+            // Called with m_slabs_lock held
+            slab* map_slab(bool pinned)
+            {
+                void* memory = pages::map_aligned(m_slab_size, m_slab_size, m_huge_pages);
+                if (memory == nullptr)
+                {
+                    stats::record_mapping_failure();
+                    return nullptr;
+                }
+
+                slab* s = ::new (memory) slab(m_slab_size, pinned);
+                m_slabs.push_back(s);
+                m_partial.push_back(s);
+                m_mapped.store(m_mapped.load(std::memory_order_relaxed) + m_slab_size, std::memory_order_relaxed);
+                stats::record_mapping(m_slab_size);
+                return s;
+            }
+
+            void unmap_slab(slab* s)
+            {
+                m_slabs.erase(std::find(m_slabs.begin(), m_slabs.end(), s));
+                m_partial.erase(std::find(m_partial.begin(), m_partial.end(), s));
+                m_mapped.store(m_mapped.load(std::memory_order_relaxed) - m_slab_size, std::memory_order_relaxed);
+                stats::record_unmapping(m_slab_size);
+                pages::unmap(s, m_slab_size);
+            }
+
+            char* allocate_large(std::size_t blk_count)
+            {
+                const std::size_t bytes = pages::round_up(blk_count * BLOCK_SIZE);
+                char* data = static_cast<char*>(pages::map(bytes));
+                if (data == nullptr)
+                {
+                    stats::record_mapping_failure();
+                    return nullptr;
+                }
+
+                m_large_used.fetch_add(bytes, std::memory_order_relaxed);
+                m_mapped.fetch_add(bytes, std::memory_order_relaxed);
+                stats::record_mapping(bytes);
+                stats::record_block_allocation(bytes);
+                return data;
+            }
+
+            void free_large(char* data, std::size_t blk_count)
+            {
+                const std::size_t bytes = pages::round_up(blk_count * BLOCK_SIZE);
+                m_large_used.fetch_sub(bytes, std::memory_order_relaxed);
+                m_mapped.fetch_sub(bytes, std::memory_order_relaxed);
+                stats::record_block_free(bytes, false);
+                stats::record_unmapping(bytes);
+                pages::unmap(data, bytes);
+            }
+
+            const std::size_t m_slab_size;
+            const bool m_huge_pages;
+            const std::size_t m_chunk_blocks; // blocks of chunk 0, the shortest chunk of a slab
+            const uint64_t m_id;
+
+            std::mutex m_slabs_lock;
+            std::vector<slab*> m_slabs;
+            std::vector<slab*> m_partial;   // slabs with at least one free chunk
+            slab* m_spare_slab;             // empty slab kept mapped
+            std::atomic<std::size_t> m_mapped;
+            std::atomic<std::size_t> m_large_used;
+
+            std::mutex m_arenas_lock;
+            std::deque<block_arena> m_arenas;
+
+            spinlock m_fallback_lock;
+            block_arena m_fallback;
+        };
+    } // namespace string_detail
+
+    /// @class block_allocator
+    /// @brief Hands out runs of 64-char blocks to strings, safe to share between threads
+    /// @note  Every thread allocates from an arena of its own and freed blocks are reused by the next request
+    /// @note  of the same block count. Blocks are never moved, a char* stays valid until its block is freed.
+    /// @note  Memory is mapped in slabs as strings need it and given back once a slab is empty.
+    /// @note  Copies of an allocator share its blocks.
+    class block_allocator
+    {
+    public:
+        // Every default constructed allocator shares the default pool, nothing is mapped before the first string
         block_allocator()
-            : m_buffer(string_buffer().data()), m_curr_offset(0) {}
+            : m_pool(default_pool()) {}
 
-        block_allocator(char *buffer, std::size_t size)
-            : m_buffer(buffer), m_curr_offset(0) {}
+        explicit block_allocator(const block_allocator_options& options)
+            : m_pool(std::make_shared<string_detail::block_pool>(options)) {}
 
         block_allocator(const block_allocator &other)
-            : m_buffer(other.m_buffer), m_curr_offset(other.m_curr_offset) {}
+            : m_pool(other.m_pool) {}
 
         block_allocator(block_allocator &&other)
-            : m_buffer(other.m_buffer), m_curr_offset(other.m_curr_offset)
-        {
-            other.m_buffer = nullptr;
-            other.m_curr_offset = 0;
-        }
+            : m_pool(std::move(other.m_pool)) {}
 
         // Allocate a single contiguous block representing multiple 64-char blocks
-        block* allocate_blocks(std::size_t size)
+        // Throws std::bad_alloc when the OS maps no more memory
+        block allocate_blocks(std::size_t size)
         {
             std::size_t num_blocks = (size + block::size - 1) / block::size;
-            
-            if(m_curr_offset + (num_blocks * block::size) > string_buffer().size() && m_free_blks_capacity < num_blocks)
-            {
-                defragment();
-            }
-            
-            if(m_curr_offset + (num_blocks * block::size) > string_buffer().size())
-            {
-                std::cout << "gp_std::string class :Allocator Out of memory\n";
-                return nullptr;
-            }
-
-            block blk(m_buffer + m_curr_offset, num_blocks);
-            m_curr_offset += num_blocks * block::size;
-            m_active_blks.push_back(blk);
-            return &m_active_blks.back();
+            char* data = m_pool->allocate(num_blocks);
+            if (data == nullptr)
+                throw std::bad_alloc();
+            return block(data, num_blocks);
         }
 
         void free_block(const block &blk)
         {
             if (blk.is_valid())
             {
-                m_free_blks_capacity += blk.block_count();
+                m_pool->free(blk.data(), blk.block_count());
             }
         }
 
+        // Bytes mapped and not held by a live block
         size_t capacity() const
         {
-            return string_buffer().size() - m_curr_offset;
+            return m_pool->capacity();
         }
 
-        void defragment()
+        size_t used_bytes() const
         {
-           uint32_t new_offset = 0;
-           for(auto& blk : m_active_blks)
-           {
-               new_offset += blk.block_count() * block::size;
-               block new_blk(m_buffer + new_offset, blk.block_count());
-               new_blk.copy_contents_from(blk);
-               blk = static_cast<block&&>(new_blk);
-           }
-           
-           m_curr_offset = new_offset;
-           m_free_blks_capacity = 0;
+            return m_pool->used_bytes();
+        }
+
+        size_t mapped_bytes() const
+        {
+            return m_pool->mapped_bytes();
         }
 
     private:
-        char* m_buffer;
-        std::size_t m_curr_offset;
-        uint32_t m_free_blks_capacity;
-        std::deque<block> m_active_blks;
+        static const std::shared_ptr<string_detail::block_pool>& default_pool()
+        {
+            static const std::shared_ptr<string_detail::block_pool> pool =
+                std::make_shared<string_detail::block_pool>(block_allocator_options());
+            return pool;
+        }
+
+        std::shared_ptr<string_detail::block_pool> m_pool;
     };
 
     /// @class string
@@ -419,7 +1068,7 @@ namespace gp_std
         {
             blk_ = allocator()->allocate_blocks(len + 1 + (block::size * 2));
             str_len = len;
-            blk_->data()[len] = '\0'; // Null-terminate the string
+            std::memset(blk_.data(), 0, len + 1); // Reused blocks are not zeroed
         }
 
         string(const char *str) : str_len(0), m_allocator(default_allocator())
@@ -432,10 +1081,11 @@ namespace gp_std
             allocate(other.c_str());
         }
 
-        string(string &&other) : str_len(0), m_allocator(default_allocator())
+        string(string &&other) : str_len(0), m_allocator(other.m_allocator)
         {
             blk_ = other.blk_;
             other.blk_ = other.allocator()->allocate_blocks((block::size * 2));
+            other.blk_.data()[0] = '\0';
             str_len = other.str_len;
             other.str_len = 0;
         }
@@ -452,16 +1102,14 @@ namespace gp_std
         {
             if (this != &other)
             {
-                other.blk_ = blk_;
-                other.str_len = str_len;
-                other.m_allocator = m_allocator;
-                blk_ = allocator()->allocate_blocks((block::size * 2));
-                str_len = 0;
+                // other keeps our old block, emptied
+                swap(other);
+                other.clear();
             }
             return std::move(*this);
         }
 
-        string(const std::string &str)
+        string(const std::string &str) : str_len(0), m_allocator(default_allocator())
         {
             allocate(str.c_str());
         }
@@ -471,14 +1119,14 @@ namespace gp_std
             std::size_t new_len = std::strlen(new_str);
 
             // Reuse current block if it has enough capacity
-            if (new_len + 1 <= blk_->capacity())
+            if (new_len + 1 <= blk_.capacity())
             {
                 copy_data_to_block(new_str, new_len);
                 str_len = new_len;
             }
             else
             {
-                allocator()->free_block(*blk_);
+                allocator()->free_block(blk_);
                 allocate(new_str);
             }
             return *this;
@@ -488,9 +1136,8 @@ namespace gp_std
         {
             if (this != &other)
             {
-                this->blk_ = other.blk_;
-                this->str_len = other.str_len;
-                this->m_allocator = other.m_allocator;
+                // Blocks are reused once freed, so each string needs its own copy
+                *this = other.c_str();
             }
             return *this;
         }
@@ -511,10 +1158,10 @@ namespace gp_std
 
         string operator+(const char* str) const
         {
-            size_t new_len = std::strlen(str) + capacity();
-            string new_str(new_len);
-            std::strncat(new_str.blk_->data(), c_str(), str_len);
-            std::strncat(new_str.blk_->data(), str, new_len);
+            size_t str_size = std::strlen(str);
+            string new_str(static_cast<uint32_t>(str_len + str_size));
+            std::memcpy(new_str.blk_.data(), c_str(), str_len);
+            std::memcpy(new_str.blk_.data() + str_len, str, str_size);
             return new_str;
         }
 
@@ -530,18 +1177,19 @@ namespace gp_std
 
         string operator+(const string_view &view) const
         {
-            size_t new_len = view.size() + capacity();
-            string new_str(new_len);
-            std::strncat(new_str.blk_->data(), c_str(), str_len);
-            std::strncat(new_str.blk_->data(), view.data(), new_len);
+            string new_str(static_cast<uint32_t>(str_len + view.size()));
+            std::memcpy(new_str.blk_.data(), c_str(), str_len);
+            std::memcpy(new_str.blk_.data() + str_len, view.data(), view.size());
             return new_str;
         }
 
         string& operator+=(const char *str)
         {
-            size_t new_len = std::strlen(str) + capacity();
+            size_t str_size = std::strlen(str);
+            size_t new_len = str_len + str_size;
             this->reserve(new_len);
-            std::strncat(blk_->data(), str, new_len);
+            std::memcpy(blk_.data() + str_len, str, str_size);
+            blk_.data()[new_len] = '\0';
             str_len = new_len;
             return *this;
         }
@@ -571,19 +1219,19 @@ namespace gp_std
 
         string_view find(const char *str)
         {
-            char *found = std::strstr(begin(), str);
-
-            if (found)
-            {
-                return string_view(found, std::strlen(str));
-            }
+            return view().find(str);
+        }
 
-            return string_view();
+        string_view rfind(const char *str)
+        {
+            return view().rfind(str);
         }
 
         void clear()
         {
             str_len = 0;
+            if (blk_.is_valid())
+                blk_.data()[0] = '\0';
         }
 
         void swap(string &other)
@@ -599,26 +1247,26 @@ namespace gp_std
         }
 
         // Returns the stored C-string
-        const char *c_str() const { return blk_->is_valid() ? blk_->data() : ""; }
+        const char *c_str() const { return blk_.is_valid() ? blk_.data() : ""; }
 
-        char *begin() { return blk_->data(); }
-        char *end() { return blk_->data() + str_len; }
+        char *begin() { return blk_.data(); }
+        char *end() { return blk_.data() + str_len; }
 
-        const char *begin() const { return blk_->data(); }
-        const char *end() const { return blk_->data() + str_len; }
+        const char *begin() const { return blk_.data(); }
+        const char *end() const { return blk_.data() + str_len; }
 
         std::size_t size() const { return str_len; }
         std::size_t length() const { return str_len; }
-        std::size_t capacity() const { return blk_->capacity(); }
+        std::size_t capacity() const { return blk_.capacity(); }
 
         char operator[](std::size_t i) const
         {
-            return blk_->data()[i];
+            return blk_.data()[i];
         }
 
         char &operator[](std::size_t i)
         {
-            return blk_->data()[i];
+            return blk_.data()[i];
         }
 
         bool operator==(const gp_std::string &other) const
@@ -664,7 +1312,7 @@ namespace gp_std
         // Destructor to free the block upon object destruction
         ~string()
         {
-            allocator()->free_block(*blk_);
+            allocator()->free_block(blk_);
         }
 
         block_allocator *allocator() const
@@ -672,8 +1320,16 @@ namespace gp_std
             return m_allocator;
         }
 
+        // The contents move to a block of the new allocator, a block is always freed where it came from
         void set_allocator(block_allocator *allocator)
         {
+            if (allocator == m_allocator)
+                return;
+
+            block new_blk = allocator->allocate_blocks(str_len + 1 + (block::size * 2));
+            std::memcpy(new_blk.data(), c_str(), str_len + 1);
+            m_allocator->free_block(blk_);
+            blk_ = new_blk;
             m_allocator = allocator;
         }
 
@@ -689,20 +1345,16 @@ namespace gp_std
 
         void m_reserve(const std::size_t &len) const
         {
-            if (len + 1 <= blk_->capacity())
+            if (len + 1 <= blk_.capacity())
             {
                 return;
             }
 
-            string temp = *this;
-
-            auto new_blk = allocator()->allocate_blocks(len + 1 + (block::size * 2));
-
-            std::strncpy(new_blk->data(), c_str(), len);
+            block new_blk = allocator()->allocate_blocks(len + 1 + (block::size * 2));
 
-            new_blk->data()[len] = '\0'; // Null-terminate the string
+            std::memcpy(new_blk.data(), c_str(), str_len + 1);
 
-            allocator()->free_block(*blk_);
+            allocator()->free_block(blk_);
 
             blk_ = new_blk;
         }
@@ -710,8 +1362,8 @@ namespace gp_std
         // Helper function to copy data into the block
         void copy_data_to_block(const char *str, std::size_t len)
         {
-            std::strncpy(blk_->data(), str, len);
-            blk_->data()[len] = '\0'; // Null-terminate the string
+            std::memcpy(blk_.data(), str, len);
+            blk_.data()[len] = '\0'; // Null-terminate the string
         }
 
         static block_allocator* default_allocator()
@@ -721,7 +1373,7 @@ namespace gp_std
         }
 
     private:
-        mutable block* blk_;          // Single contiguous block for this string
+        mutable block blk_;           // Single contiguous block for this string
         mutable uint32_t str_len;     // Size of the string
         block_allocator* m_allocator; // Allocator for the string
     };
@@ -0,0 +1,414 @@
+#ifndef _GP_STD_STRING_SEARCH_HPP_
+#define _GP_STD_STRING_SEARCH_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GP_STRING_SEARCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(GP_STRING_SEARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define GP_STRING_SEARCH_AVX2 __attribute__((target("avx2")))
+#define GP_STRING_SEARCH_SSE2 __attribute__((target("sse2")))
+#else
+#define GP_STRING_SEARCH_AVX2
+#define GP_STRING_SEARCH_SSE2
+#endif
+
+// Scan primitives behind string_view and const_string_view, over (pointer, length) ranges that need not be null terminated
+// Substrings are found with a first plus last character filter: one vector compare per end of the needle
+// keeps only the positions where both ends match, and only those are compared in full.
+// The AVX2 (32 bytes a step) or SSE2 (16 bytes a step) kernels are picked once at run time, single characters go to memchr.
+//
+// Usage :
+// std::size_t at = gp_std::string_search::find(line, line_len, "level=", 6);
+// if (at != gp_std::string_search::npos) ...
+
+namespace gp_std
+{
+    namespace string_search
+    {
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        // Sets of up to this many characters are matched with vector compares, larger sets go through a table
+        static constexpr std::size_t max_vector_set = 16;
+
+        ///@brief Kernels of one instruction set
+        struct kernels
+        {
+            std::size_t (*find)(const char*, std::size_t, const char*, std::size_t);
+            std::size_t (*rfind)(const char*, std::size_t, const char*, std::size_t);
+            std::size_t (*find_first_of)(const char*, std::size_t, const char*, std::size_t);
+        };
+
+        namespace scalar
+        {
+            inline unsigned count_trailing_zeros(uint32_t mask)
+            {
+            #if defined(_MSC_VER) && !defined(__clang__)
+                unsigned long index;
+                _BitScanForward(&index, mask);
+                return static_cast<unsigned>(index);
+            #else
+                return static_cast<unsigned>(__builtin_ctz(mask));
+            #endif
+            }
+
+            inline unsigned highest_bit(uint32_t mask)
+            {
+            #if defined(_MSC_VER) && !defined(__clang__)
+                unsigned long index;
+                _BitScanReverse(&index, mask);
+                return static_cast<unsigned>(index);
+            #else
+                return 31u - static_cast<unsigned>(__builtin_clz(mask));
+            #endif
+            }
+
+            // Candidates from `from` on, memchr jumps to the next first character and the last one is checked before memcmp
+            inline std::size_t find(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size, std::size_t from = 0)
+            {
+                const std::size_t last = needle_size - 1;
+                const char* candidate = haystack + from;
+                const char* stop = haystack + (size - needle_size) + 1;
+                while (candidate < stop)
+                {
+                    candidate = static_cast<const char*>(std::memchr(candidate, needle[0], static_cast<std::size_t>(stop - candidate)));
+                    if (candidate == nullptr)
+                        return npos;
+
+                    if (candidate[last] == needle[last] && std::memcmp(candidate + 1, needle + 1, last) == 0)
+                        return static_cast<std::size_t>(candidate - haystack);
+                    ++candidate;
+                }
+                return npos;
+            }
+
+            // Candidates from `from` down to 0
+            inline std::size_t rfind(const char* haystack, std::size_t, const char* needle, std::size_t needle_size, std::size_t from)
+            {
+                const std::size_t last = needle_size - 1;
+                for (std::size_t i = from + 1; i-- > 0;)
+                {
+                    if (haystack[i] == needle[0] && haystack[i + last] == needle[last] && std::memcmp(haystack + i + 1, needle + 1, last) == 0)
+                        return i;
+                }
+                return npos;
+            }
+
+            inline std::size_t find_first_of(const char* haystack, std::size_t size, const char* set, std::size_t set_size, std::size_t from = 0)
+            {
+                std::array<bool, 256> in_set{};
+                for (std::size_t i = 0; i < set_size; ++i)
+                    in_set[static_cast<unsigned char>(set[i])] = true;
+
+                for (std::size_t i = from; i < size; ++i)
+                {
+                    if (in_set[static_cast<unsigned char>(haystack[i])])
+                        return i;
+                }
+                return npos;
+            }
+
+            inline std::size_t find_entry(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size)
+            {
+                return find(haystack, size, needle, needle_size);
+            }
+
+            inline std::size_t rfind_entry(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size)
+            {
+                return rfind(haystack, size, needle, needle_size, size - needle_size);
+            }
+
+            inline std::size_t find_first_of_entry(const char* haystack, std::size_t size, const char* set, std::size_t set_size)
+            {
+                return find_first_of(haystack, size, set, set_size);
+            }
+
+            inline const kernels& table()
+            {
+                static const kernels k = { &find_entry, &rfind_entry, &find_first_of_entry };
+                return k;
+            }
+        } // namespace scalar
+
+    #if defined(GP_STRING_SEARCH_X86)
+        namespace sse2
+        {
+            static constexpr std::size_t width = 16;
+
+            GP_STRING_SEARCH_SSE2 inline std::size_t find(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size)
+            {
+                const std::size_t last = needle_size - 1;
+                const __m128i first_char = _mm_set1_epi8(needle[0]);
+                const __m128i last_char = _mm_set1_epi8(needle[last]);
+
+                std::size_t i = 0;
+                for (; i + last + width <= size; i += width)
+                {
+                    const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+                    const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + last));
+                    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first_char), _mm_cmpeq_epi8(tail, last_char))));
+                    while (mask != 0)
+                    {
+                        const std::size_t at = i + scalar::count_trailing_zeros(mask);
+                        if (std::memcmp(haystack + at + 1, needle + 1, last) == 0)
+                            return at;
+                        mask &= mask - 1;
+                    }
+                }
+                return i + last < size ? scalar::find(haystack, size, needle, needle_size, i) : npos;
+            }
+
+            GP_STRING_SEARCH_SSE2 inline std::size_t rfind(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size)
+            {
+                const std::size_t last = needle_size - 1;
+                const __m128i first_char = _mm_set1_epi8(needle[0]);
+                const __m128i last_char = _mm_set1_epi8(needle[last]);
+
+                // Candidates [start, start + width) a step, from the last one down
+                std::size_t end = size - last;
+                for (; end >= width; end -= width)
+                {
+                    const std::size_t start = end - width;
+                    const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + start));
+                    const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + start + last));
+                    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first_char), _mm_cmpeq_epi8(tail, last_char))));
+                    while (mask != 0)
+                    {
+                        const unsigned bit = scalar::highest_bit(mask);
+                        if (std::memcmp(haystack + start + bit + 1, needle + 1, last) == 0)
+                            return start + bit;
+                        mask &= ~(1u << bit);
+                    }
+                }
+                return end != 0 ? scalar::rfind(haystack, size, needle, needle_size, end - 1) : npos;
+            }
+
+            GP_STRING_SEARCH_SSE2 inline std::size_t find_first_of(const char* haystack, std::size_t size, const char* set, std::size_t set_size)
+            {
+                if (set_size > max_vector_set)
+                    return scalar::find_first_of(haystack, size, set, set_size);
+
+                __m128i chars[max_vector_set];
+                for (std::size_t c = 0; c < set_size; ++c)
+                    chars[c] = _mm_set1_epi8(set[c]);
+
+                std::size_t i = 0;
+                for (; i + width <= size; i += width)
+                {
+                    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+                    __m128i hits = _mm_setzero_si128();
+                    for (std::size_t c = 0; c < set_size; ++c)
+                        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, chars[c]));
+
+                    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+                    if (mask != 0)
+                        return i + scalar::count_trailing_zeros(mask);
+                }
+                return scalar::find_first_of(haystack, size, set, set_size, i);
+            }
+
+            inline const kernels& table()
+            {
+                static const kernels k = { &find, &rfind, &find_first_of };
+                return k;
+            }
+        } // namespace sse2
+
+        namespace avx2
+        {
+            static constexpr std::size_t width = 32;
+
+            GP_STRING_SEARCH_AVX2 inline std::size_t find(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size)
+            {
+                const std::size_t last = needle_size - 1;
+                const __m256i first_char = _mm256_set1_epi8(needle[0]);
+                const __m256i last_char = _mm256_set1_epi8(needle[last]);
+
+                std::size_t i = 0;
+                for (; i + last + width <= size; i += width)
+                {
+                    const __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i));
+                    const __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i + last));
+                    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(head, first_char), _mm256_cmpeq_epi8(tail, last_char))));
+                    while (mask != 0)
+                    {
+                        const std::size_t at = i + scalar::count_trailing_zeros(mask);
+                        if (std::memcmp(haystack + at + 1, needle + 1, last) == 0)
+                            return at;
+                        mask &= mask - 1;
+                    }
+                }
+                return i + last < size ? scalar::find(haystack, size, needle, needle_size, i) : npos;
+            }
+
+            GP_STRING_SEARCH_AVX2 inline std::size_t rfind(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size)
+            {
+                const std::size_t last = needle_size - 1;
+                const __m256i first_char = _mm256_set1_epi8(needle[0]);
+                const __m256i last_char = _mm256_set1_epi8(needle[last]);
+
+                std::size_t end = size - last;
+                for (; end >= width; end -= width)
+                {
+                    const std::size_t start = end - width;
+                    const __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + start));
+                    const __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + start + last));
+                    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(head, first_char), _mm256_cmpeq_epi8(tail, last_char))));
+                    while (mask != 0)
+                    {
+                        const unsigned bit = scalar::highest_bit(mask);
+                        if (std::memcmp(haystack + start + bit + 1, needle + 1, last) == 0)
+                            return start + bit;
+                        mask &= ~(1u << bit);
+                    }
+                }
+                return end != 0 ? scalar::rfind(haystack, size, needle, needle_size, end - 1) : npos;
+            }
+
+            GP_STRING_SEARCH_AVX2 inline std::size_t find_first_of(const char* haystack, std::size_t size, const char* set, std::size_t set_size)
+            {
+                if (set_size > max_vector_set)
+                    return scalar::find_first_of(haystack, size, set, set_size);
+
+                __m256i chars[max_vector_set];
+                for (std::size_t c = 0; c < set_size; ++c)
+                    chars[c] = _mm256_set1_epi8(set[c]);
+
+                std::size_t i = 0;
+                for (; i + width <= size; i += width)
+                {
+                    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i));
+                    __m256i hits = _mm256_setzero_si256();
+                    for (std::size_t c = 0; c < set_size; ++c)
+                        hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, chars[c]));
+
+                    const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+                    if (mask != 0)
+                        return i + scalar::count_trailing_zeros(mask);
+                }
+                return scalar::find_first_of(haystack, size, set, set_size, i);
+            }
+
+            inline bool is_supported()
+            {
+            #if defined(_MSC_VER) && !defined(__clang__)
+                int info[4];
+                __cpuid(info, 0);
+                if (info[0] < 7)
+                    return false;
+
+                // AVX2 needs the OS to save the ymm registers (OSXSAVE, then XCR0 bits 1 and 2)
+                __cpuid(info, 1);
+                if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+                    return false;
+
+                __cpuidex(info, 7, 0);
+                return (info[1] & (1 << 5)) != 0;
+            #else
+                return __builtin_cpu_supports("avx2");
+            #endif
+            }
+
+            inline const kernels& table()
+            {
+                static const kernels k = { &find, &rfind, &find_first_of };
+                return k;
+            }
+        } // namespace avx2
+    #endif
+
+        ///@brief The kernels this CPU runs best, picked on first use
+        inline const kernels& active()
+        {
+        #if defined(GP_STRING_SEARCH_X86)
+            static const kernels& k = avx2::is_supported() ? avx2::table() : sse2::table();
+        #else
+            static const kernels& k = scalar::table();
+        #endif
+            return k;
+        }
+
+        ///@brief Position of the first occurrence of needle in haystack, npos if there is none
+        inline std::size_t find(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size)
+        {
+            if (needle_size == 0)
+                return 0;
+            if (needle_size > size)
+                return npos;
+            if (needle_size == 1)
+            {
+                const void* found = std::memchr(haystack, needle[0], size);
+                return found != nullptr ? static_cast<std::size_t>(static_cast<const char*>(found) - haystack) : npos;
+            }
+            return active().find(haystack, size, needle, needle_size);
+        }
+
+        ///@brief Position of the last occurrence of needle in haystack, npos if there is none
+        inline std::size_t rfind(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size)
+        {
+            if (needle_size == 0)
+                return size;
+            if (needle_size > size)
+                return npos;
+            if (needle_size == 1)
+            {
+                for (std::size_t i = size; i-- > 0;)
+                {
+                    if (haystack[i] == needle[0])
+                        return i;
+                }
+                return npos;
+            }
+            return active().rfind(haystack, size, needle, needle_size);
+        }
+
+        ///@brief Position of the first character of haystack that is one of set, npos if there is none
+        inline std::size_t find_first_of(const char* haystack, std::size_t size, const char* set, std::size_t set_size)
+        {
+            if (set_size == 0 || size == 0)
+                return npos;
+            if (set_size == 1)
+            {
+                const void* found = std::memchr(haystack, set[0], size);
+                return found != nullptr ? static_cast<std::size_t>(static_cast<const char*>(found) - haystack) : npos;
+            }
+            return active().find_first_of(haystack, size, set, set_size);
+        }
+
+        ///@brief Negative, zero or positive as lhs sorts before, with or after rhs
+        /// @note  memcmp is already vectorized by the C library, nothing to gain from another kernel
+        inline int compare(const char* lhs, std::size_t lhs_size, const char* rhs, std::size_t rhs_size)
+        {
+            const std::size_t common = lhs_size < rhs_size ? lhs_size : rhs_size;
+            const int order = common != 0 ? std::memcmp(lhs, rhs, common) : 0;
+            if (order != 0)
+                return order;
+            return lhs_size < rhs_size ? -1 : (lhs_size > rhs_size ? 1 : 0);
+        }
+
+        inline bool equal(const char* lhs, std::size_t lhs_size, const char* rhs, std::size_t rhs_size)
+        {
+            return lhs_size == rhs_size && (lhs_size == 0 || std::memcmp(lhs, rhs, lhs_size) == 0);
+        }
+
+        inline bool starts_with(const char* str, std::size_t size, const char* prefix, std::size_t prefix_size)
+        {
+            return prefix_size <= size && (prefix_size == 0 || std::memcmp(str, prefix, prefix_size) == 0);
+        }
+    } // namespace string_search
+} // namespace gp_std
+
+#undef GP_STRING_SEARCH_AVX2
+#undef GP_STRING_SEARCH_SSE2
+#undef GP_STRING_SEARCH_X86
+
+#endif
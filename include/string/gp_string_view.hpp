@@ -1,9 +1,13 @@
 #ifndef _GP_STD_STRING_VIEW_HPP_
-#ifndef _GP_STD_STRING_VIEW_HPP_
+#define _GP_STD_STRING_VIEW_HPP_
 
+#include <cassert>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <string>
+
+#include "gp_string_search.hpp"
 
 namespace gp_std
 {    
@@ -28,16 +32,46 @@ namespace gp_std
         const_string_view(const char *str)
             : data_(str), str_len(std::strlen(str)) {}
 
+        static constexpr std::size_t npos = string_search::npos;
+
         const_string_view find(const char *str) const
         {
-            const char *found = std::strstr(data_, str);
+            return find(const_string_view(str));
+        }
 
-            if (found)
-            {
-                return const_string_view(found, std::strlen(str));
-            }
+        // View of the first match of str, an empty view if there is none
+        const_string_view find(const const_string_view &str) const
+        {
+            std::size_t found = string_search::find(data_, str_len, str.data_, str.str_len);
+            return found != npos ? const_string_view(data_ + found, str.str_len) : const_string_view();
+        }
+
+        const_string_view rfind(const char *str) const
+        {
+            return rfind(const_string_view(str));
+        }
+
+        // View of the last match of str, an empty view if there is none
+        const_string_view rfind(const const_string_view &str) const
+        {
+            std::size_t found = string_search::rfind(data_, str_len, str.data_, str.str_len);
+            return found != npos ? const_string_view(data_ + found, str.str_len) : const_string_view();
+        }
+
+        // Position of the first character that is one of chars, npos if there is none
+        std::size_t find_first_of(const const_string_view &chars) const
+        {
+            return string_search::find_first_of(data_, str_len, chars.data_, chars.str_len);
+        }
+
+        int compare(const const_string_view &other) const
+        {
+            return string_search::compare(data_, str_len, other.data_, other.str_len);
+        }
 
-            return const_string_view();
+        bool starts_with(const const_string_view &prefix) const
+        {
+            return string_search::starts_with(data_, str_len, prefix.data_, prefix.str_len);
         }
 
         const char *data() const { return data_; }
@@ -53,19 +87,7 @@ namespace gp_std
 
         bool operator==(const const_string_view &other) const
         {
-            if (str_len != other.str_len)
-            {
-                return false;
-            }
-
-            for (std::size_t i = 0; i < str_len; ++i)
-            {
-                if (data_[i] != other.data_[i])
-                {
-                    return false;
-                }
-            }
-            return true;
+            return string_search::equal(data_, str_len, other.data_, other.str_len);
         }
 
         operator bool() const
@@ -80,19 +102,7 @@ namespace gp_std
 
         bool operator==(const char *str) const
         {
-            if (std::strlen(str) != str_len)
-            {
-                return false;
-            }
-
-            for (std::size_t i = 0; i < str_len; ++i)
-            {
-                if (data_[i] != str[i])
-                {
-                    return false;
-                }
-            }
-            return true;
+            return string_search::equal(data_, str_len, str, std::strlen(str));
         }
 
         bool operator!=(const char *str) const
@@ -136,18 +146,50 @@ namespace gp_std
         string_view(char* str)
             : data_(str), str_len(std::strlen(str)) {}
 
+        static constexpr std::size_t npos = string_search::npos;
+
         string_view find(const char* str) const
         {
-            char* found = std::strstr(data_, str);
+            return find(const_string_view(str));
+        }
 
-            if (found)
-            {
-                return string_view(found, std::strlen(str));
-            }
+        // View of the first match of str, an empty view if there is none
+        string_view find(const const_string_view& str) const
+        {
+            std::size_t found = string_search::find(data_, str_len, str.data(), str.size());
+            return found != npos ? string_view(data_ + found, str.size()) : string_view();
+        }
+
+        string_view rfind(const char* str) const
+        {
+            return rfind(const_string_view(str));
+        }
 
-            return string_view();
+        // View of the last match of str, an empty view if there is none
+        string_view rfind(const const_string_view& str) const
+        {
+            std::size_t found = string_search::rfind(data_, str_len, str.data(), str.size());
+            return found != npos ? string_view(data_ + found, str.size()) : string_view();
+        }
+
+        // Position of the first character that is one of chars, npos if there is none
+        std::size_t find_first_of(const const_string_view& chars) const
+        {
+            return string_search::find_first_of(data_, str_len, chars.data(), chars.size());
         }
 
+        int compare(const const_string_view& other) const
+        {
+            return string_search::compare(data_, str_len, other.data(), other.size());
+        }
+
+        bool starts_with(const const_string_view& prefix) const
+        {
+            return string_search::starts_with(data_, str_len, prefix.data(), prefix.size());
+        }
+
+        operator const_string_view() const { return const_string_view(data_, str_len); }
+
         string_view &operator=(const char* str)
         {
             size_t in_str_len = std::strlen(str);
@@ -188,20 +230,7 @@ namespace gp_std
 
         bool operator==(const string_view& other) const
         {
-            if (str_len != other.str_len)
-            {
-                return false;
-            }
-
-            for (std::size_t i = 0; i < str_len; ++i)
-            {
-                if (data_[i] != other.data_[i])
-                {
-                    return false;
-                }
-            }
-
-            return true;
+            return string_search::equal(data_, str_len, other.data_, other.str_len);
         }
 
         operator bool() const
@@ -216,19 +245,7 @@ namespace gp_std
 
         bool operator==(const char* str) const
         {
-            if (std::strlen(str) != str_len)
-            {
-                return false;
-            }
-
-            for (std::size_t i = 0; i < str_len; ++i)
-            {
-                if (data_[i] != str[i])
-                {
-                    return false;
-                }
-            }
-            return true;
+            return string_search::equal(data_, str_len, str, std::strlen(str));
         }
 
         bool operator!=(const char* str) const
@@ -265,3 +282,5 @@ namespace gp_std
         std::size_t str_len;
     };
 }
+
+#endif